@@ -34,6 +34,14 @@ CONFIG(test) {
     CONFIG   -= app_bundle
     DEFINES  += ENABLE_TEST_MODE
 }
+else:CONFIG(benchmark) {
+    QT       += testlib
+    TARGET    = digitalscratch-benchmark
+    CONFIG   += console release
+    CONFIG   -= app_bundle debug
+    DEFINES  += ENABLE_TEST_MODE
+    DEFINES  -= ENABLE_TEST_DEVICE
+}
 else {
     DEFINES  -= ENABLE_TEST_DEVICE
     TARGET    = digitalscratch
@@ -50,23 +58,31 @@ HEADERS += include/app/application_const.h \
            include/audiodev/sound_card_control_rules.h \
            include/audiodev/jack_client_control_rules.h \
            include/audiodev/audio_io_control_rules.h \
+           include/audiodev/file_audio_io.h \
            include/control/control_process.h \
            include/control/timecode_control_process.h \
            include/control/manual_control_process.h \
            include/gui/config_dialog.h \
            include/gui/gui.h \
            include/gui/waveform.h \
+           include/gui/zoomed_waveform.h \
            include/player/deck_playback_process.h \
+           include/player/callback_profiler.h \
+           include/player/deck_command_queue.h \
            include/player/playback_parameters.h \
            include/player/control_and_playback_process.h \
            include/control/dicer_control_process.h \
            include/tracks/data_persistence.h \
            include/tracks/audio_collection_model.h \
+           include/tracks/audio_collection_scanner.h \
            include/tracks/audio_track_key_process.h \
+           include/tracks/audio_track_bpm_process.h \
            include/tracks/playlist.h \
            include/tracks/playlist_persistence.h \
            include/tracks/audio_file_decoding_process.h \
+           include/tracks/audio_file_analysis_decoding_process.h \
            include/tracks/audio_track.h \
+           include/tracks/audio_track_overview.h \
            include/utils.h \
            include/singleton.h
       
@@ -75,6 +91,7 @@ SOURCES += src/app/application_settings.cpp \
            src/audiodev/sound_card_control_rules.cpp \
            src/audiodev/jack_client_control_rules.cpp \
            src/audiodev/audio_io_control_rules.cpp \
+           src/audiodev/file_audio_io.cpp \
            src/control/control_process.cpp \
            src/control/timecode_control_process.cpp \
            src/control/manual_control_process.cpp \
@@ -82,14 +99,21 @@ SOURCES += src/app/application_settings.cpp \
            src/gui/config_dialog.cpp \
            src/gui/gui.cpp \
            src/gui/waveform.cpp \
+           src/gui/zoomed_waveform.cpp \
            src/player/deck_playback_process.cpp \
+           src/player/callback_profiler.cpp \
+           src/player/deck_command_queue.cpp \
            src/player/playback_parameters.cpp \
            src/player/control_and_playback_process.cpp \
            src/tracks/audio_file_decoding_process.cpp \
+           src/tracks/audio_file_analysis_decoding_process.cpp \
            src/tracks/audio_track.cpp \
+           src/tracks/audio_track_overview.cpp \
            src/tracks/data_persistence.cpp \
            src/tracks/audio_collection_model.cpp \
+           src/tracks/audio_collection_scanner.cpp \
            src/tracks/audio_track_key_process.cpp \
+           src/tracks/audio_track_bpm_process.cpp \
            src/tracks/playlist.cpp \
            src/tracks/playlist_persistence.cpp \
            src/utils.cpp \
@@ -106,7 +130,11 @@ CONFIG(test) {
                test/data_persistence_test.h \
                test/playlist_persistence_test.h \
                test/audio_device_access_rules_test.h \
-               test/control_and_playback_process_test.h
+               test/control_and_playback_process_test.h \
+               test/deck_command_queue_test.h \
+               test/audio_collection_model_test.h \
+               test/file_audio_io_test.h \
+               test/callback_profiler_test.h
 
     SOURCES += test/main_test.cpp \
                test/audio_track_test.cpp \
@@ -115,7 +143,25 @@ CONFIG(test) {
                test/data_persistence_test.cpp \
                test/playlist_persistence_test.cpp \
                test/audio_device_access_rules_test.cpp \
-               test/control_and_playback_process_test.cpp
+               test/control_and_playback_process_test.cpp \
+               test/deck_command_queue_test.cpp \
+               test/audio_collection_model_test.cpp \
+               test/file_audio_io_test.cpp \
+               test/callback_profiler_test.cpp
+}
+else:CONFIG(benchmark) {
+    INCLUDEPATH += test
+
+    SOURCES -= src/main.cpp
+
+    HEADERS += test/deck_playback_process_benchmark.h \
+               test/audio_collection_benchmark.h \
+               test/data_persistence_benchmark.h
+
+    SOURCES += test/main_benchmark.cpp \
+               test/deck_playback_process_benchmark.cpp \
+               test/audio_collection_benchmark.cpp \
+               test/data_persistence_benchmark.cpp
 }
 
 
@@ -180,7 +226,7 @@ unix {
 }
 
 #############################
-# lib Alsa (for MIDI)
+# lib Alsa (for MIDI and internal sound card)
 unix {
     LIBS += -lasound
 }
@@ -228,7 +274,7 @@ win32 {
                 %QTDIR%/bin/icu*.dll \
                 %QTDIR%/bin/Qt5Sqld.dll
         DLLS_PLATFORMS = %QTDIR%/plugins/platforms/qwindowsd.dll
-        CONFIG(test) {
+        CONFIG(test)|CONFIG(benchmark) {
            DLLS += %QTDIR%/bin/Qt5Testd.dll
         }
     } else {
@@ -243,7 +289,7 @@ win32 {
                 %QTDIR%/bin/icu*.dll \
                 %QTDIR%/bin/Qt5Sql.dll
         DLLS_PLATFORMS = %QTDIR%/plugins/platforms/qwindows.dll
-        CONFIG(test) {
+        CONFIG(test)|CONFIG(benchmark) {
            DLLS += %QTDIR%/bin/Qt5Test.dll
         }
     }
@@ -260,7 +306,7 @@ win32 {
     }
 
     # Copy test data into .exe directory
-    CONFIG(test) {
+    CONFIG(test)|CONFIG(benchmark) {
         SRC_TESTDATA_DIR = test/data
         SRC_TESTDATA_DIR ~= s,/,\\,g
         DEST_TESTDATA_DIR = $${DESTDIR_WIN}/data
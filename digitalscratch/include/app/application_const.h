@@ -43,6 +43,11 @@
 
 #define MAX_NB_CUE_POINTS   4                 // Number of cue points per deck.
 
+// Audio track analysis (music key,...)
+#define ANALYSIS_SAMPLE_RATE    11025         // Sample rate of the mono data decoded for analysis.
+#define ANALYSIS_NB_SEGMENTS    4             // Number of parts of a track decoded for analysis (0 = full track).
+#define ANALYSIS_SEGMENT_LENGTH 30            // Length of a decoded part (sec).
+
 // GUI image/icons
 #define SKINS_PATH              ":/skins/"
 #define PIXMAPS_PATH            ":/pixmaps/"
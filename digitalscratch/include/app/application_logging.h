@@ -40,7 +40,9 @@ Q_DECLARE_LOGGING_CATEGORY(DS_APPSETTINGS)
 Q_DECLARE_LOGGING_CATEGORY(DS_FILE)
 Q_DECLARE_LOGGING_CATEGORY(DS_PLAYBACK)
 Q_DECLARE_LOGGING_CATEGORY(DS_MUSICKEY)
+Q_DECLARE_LOGGING_CATEGORY(DS_BPM)
 Q_DECLARE_LOGGING_CATEGORY(DS_SOUNDCARD)
 Q_DECLARE_LOGGING_CATEGORY(DS_DB)
 Q_DECLARE_LOGGING_CATEGORY(DS_DICER)
 Q_DECLARE_LOGGING_CATEGORY(DS_GUI)
+Q_DECLARE_LOGGING_CATEGORY(DS_PROFILER)
@@ -77,12 +77,18 @@ using namespace std;
 #define SOUND_DRIVER_INTERNAL               "internal"
 #define SOUND_DRIVER_DEFAULT                SOUND_DRIVER_JACK
 #define SOUND_CARD_CFG                      "sound_card/sound_card_id"
-#define SOUND_CARD_DEFAULT                  "0"
+#define SOUND_CARD_DEFAULT                  "hw:0"
+#define PERIOD_SIZE_CFG                     "sound_card/period_size"    // Internal sound card only (JACK has its own settings).
+#define PERIOD_SIZE_DEFAULT                 256
+#define NB_PERIODS_CFG                      "sound_card/nb_periods"
+#define NB_PERIODS_DEFAULT                  2
 
 // Decks: motion detection.
 #define DECK_INDEX                          "deck_"
 #define VINYL_TYPE_CFG                      "vinyl_type"
 #define RPM_CFG                             "rpm"
+#define VINYL_DETECT_CFG                    "vinyl_detect"
+#define VINYL_DETECT_DEFAULT                0
 
 // Playback parameters.
 #define MAX_SPEED_DIFF_CFG                  "playback_parameters/max_speed_diff"
@@ -159,6 +165,8 @@ class Application_settings : public QObject
     QMap<dscratch_vinyls_t, QString> available_vinyl_types;
     QList<unsigned short int>        available_rpms;
     QList<unsigned int>              available_sample_rates;
+    QList<unsigned int>              available_period_sizes;
+    QList<unsigned int>              available_nb_periods;
     QList<unsigned short int>        available_nb_decks;
     QList<QString>                   available_sound_cards;
     bool                             audio_collection_full_refresh;
@@ -217,6 +225,14 @@ class Application_settings : public QObject
     QString         get_internal_sound_card();
     QString         get_internal_sound_card_default();
     QList<QString>  get_available_internal_sound_cards();
+    void                 set_period_size(const unsigned int &nb_frames);
+    unsigned int         get_period_size();
+    unsigned int         get_period_size_default();
+    QList<unsigned int>  get_available_period_sizes();
+    void                 set_nb_periods(const unsigned int &nb_periods);
+    unsigned int         get_nb_periods();
+    unsigned int         get_nb_periods_default();
+    QList<unsigned int>  get_available_nb_periods();
 
     void            set_auto_jack_connections(const bool &do_autoconnect);
     bool            get_auto_jack_connections();
@@ -236,6 +252,10 @@ class Application_settings : public QObject
     dscratch_vinyl_rpm_t   get_rpm_default();
     QList<unsigned short>  get_available_rpms();
 
+    void set_vinyl_detect(const unsigned short &deck_index, const bool &do_detect);
+    bool get_vinyl_detect(const unsigned short &deck_index);
+    bool get_vinyl_detect_default();
+
     void    set_keyboard_shortcut(const QString &kb_shortcut_path, const QString &value);
     QString get_keyboard_shortcut(QString in_kb_shortcut_path);
 
@@ -35,6 +35,7 @@
 #include <iostream>
 #include <QObject>
 #include <QString>
+#include <QAtomicInt>
 
 #include "app/application_const.h"
 
@@ -54,6 +55,7 @@ class Audio_IO_control_rules : public QObject
     void                    *callback_param;
     bool                     running;
     bool                     do_capture;
+    QAtomicInt               nb_xruns;
 
  public:
     explicit Audio_IO_control_rules(const unsigned short int &nb_channels);
@@ -62,6 +64,8 @@ class Audio_IO_control_rules : public QObject
  public:
     bool is_running();
     void set_capture(const bool &do_capture);
+    int  get_nb_xruns() const;
+    virtual float get_dsp_load();    // Load of the audio server in percent (-1 if unknown).
     virtual bool start(void *callback_param) = 0;
     virtual bool restart() = 0;
     virtual bool stop() = 0;
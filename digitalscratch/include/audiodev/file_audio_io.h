@@ -0,0 +1,106 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*--------------------------------------------------------( file_audio_io.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*        Behavior class: read/write audio from/to WAV files (offline)        */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <iostream>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+#include <QFile>
+#include <QSharedPointer>
+
+#include "audiodev/audio_io_control_rules.h"
+#include "app/application_const.h"
+
+#define WAV_HEADER_SIZE 44  // Size of the header of written WAV files.
+
+using namespace std;
+
+// Stereo WAV file opened for reading (16 bits PCM or 32 bits float) or for writing (32 bits float).
+struct Wav_file
+{
+    QSharedPointer<QFile> file;
+    unsigned short int    bits_per_sample;
+    bool                  is_float;
+    quint64               nb_frames;       // Frames in the file (to read or already written).
+    quint64               nb_read_frames;
+};
+
+class File_audio_io : public Audio_IO_control_rules
+{
+ private:
+    QStringList             input_paths;          // One stereo WAV file per deck (timecode signal).
+    QStringList             output_paths;         // One stereo WAV file per deck (playback).
+    unsigned short int      nb_buffer_frames;     // Number of frames given to the process at once.
+    QList<Wav_file>         input_files;
+    QList<Wav_file>         output_files;
+    QVector<QVector<float>> input_buffers;        // Non interleaved float buffers (one per channel).
+    QVector<QVector<float>> output_buffers;
+    QByteArray              io_data;              // Interleaved data read from or written to a file.
+    quint64                 nb_processed_frames;
+    qint64                  processing_time_ns;   // Time spent in the process (without file reading/writing).
+
+ public:
+    explicit File_audio_io(const unsigned short int &nb_channels,
+                           const QStringList        &in_input_paths,
+                           const QStringList        &in_output_paths,
+                           const unsigned short int &nb_buffer_frames);
+    virtual ~File_audio_io();
+
+ public:
+    bool start(void *callback_param);    // Process all input files as fast as possible, return at the end of the longest one.
+    bool restart();
+    bool stop();
+    bool get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers);
+    bool get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers);
+
+    quint64 get_nb_processed_frames() const;
+    qint64  get_processing_time_ns() const;
+
+    static bool write_wav_file(const QString          &path,   // Write interleaved stereo 16 bits samples to a WAV file.
+                               const short signed int *samples,
+                               const quint64          &nb_frames,
+                               const unsigned int     &sample_rate);
+
+ private:
+    bool open_input_file(const QString &path, Wav_file &out_wav);
+    bool open_output_file(const QString &path, Wav_file &out_wav);
+    unsigned short int read_period();     // Read a period of all input files to input buffers, return number of frames (0 = end).
+    bool write_period(const unsigned short int &nb_frames);
+    static bool write_wav_header(QFile &file, const quint64 &nb_frames, const unsigned short int &bits_per_sample,
+                                 const bool &is_float, const unsigned int &sample_rate);
+    void close_files();
+};
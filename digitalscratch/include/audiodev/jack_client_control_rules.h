@@ -62,6 +62,7 @@ class Jack_client_control_rules : public Audio_IO_control_rules
  private:
     static int capture_and_playback_callback(AUDIO_CALLBACK_NB_FRAMES_TYPE nb_buffer_frames, void *data);
     static void error_callback(const char *msg);
+    static int  xrun_callback(void *data);
 
  public:
     bool start(void *callback_param);
@@ -69,4 +70,5 @@ class Jack_client_control_rules : public Audio_IO_control_rules
     bool stop();
     bool get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers);
     bool get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers);
+    float get_dsp_load();
 };
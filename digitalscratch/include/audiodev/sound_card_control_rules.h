@@ -33,16 +33,35 @@
 #pragma once
 
 #include <iostream>
+#include <pthread.h>
+#include <alsa/asoundlib.h>
 #include <QObject>
 #include <QString>
-#include <QAudioDeviceInfo>
+#include <QVector>
+#include <QAtomicInt>
 #include "audiodev/audio_io_control_rules.h"
 #include "app/application_const.h"
 
+#define ALSA_THREAD_PRIORITY 70    // SCHED_FIFO priority of the capture/playback thread (JACK uses 70 too by default).
+#define ALSA_WAIT_TIMEOUT_MS 1000  // Max time to wait for the sound card, then consider it as lost.
+
 using namespace std;
 
 class Sound_card_control_rules : public Audio_IO_control_rules
 {
+ private:
+    snd_pcm_t              *capture_handle;
+    snd_pcm_t              *playback_handle;
+    snd_pcm_format_t        format;               // Sample format used by the device (converted from/to float).
+    unsigned int            period_size;          // Number of frames given to the callback at once.
+    unsigned int            nb_periods;           // Number of periods of the device buffer.
+    QVector<QVector<float>> input_buffers;        // Non interleaved float buffers (one per channel).
+    QVector<QVector<float>> output_buffers;
+    bool                    linked;               // Capture and playback streams start/stop together.
+    pthread_t               thread;
+    bool                    thread_started;
+    QAtomicInt              stop_requested;
+
  public:
     explicit Sound_card_control_rules(const unsigned short int &nb_channels);
     virtual ~Sound_card_control_rules();
@@ -52,6 +71,16 @@ class Sound_card_control_rules : public Audio_IO_control_rules
     bool start(void *in_callback_param);
     bool restart();
     bool stop();
-    bool get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers) const;
-    bool get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers) const;
+    bool get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers);
+    bool get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float*> &out_buffers);
+
+ private:
+    static void *capture_and_playback_thread(void *data);
+    bool open_device(snd_pcm_t *&out_handle, const QString &device, const snd_pcm_stream_t &stream);
+    bool start_streams();                                     // Fill playback buffer with silence and start both streams.
+    int  read_period();                                       // Read a period of captured frames (mmap) to input buffers.
+    int  write_period();                                      // Write a period of output buffers to playback device (mmap).
+    int  wait_frames(snd_pcm_t *handle, const int &nb_frames); // Wait until frames can be read or written.
+    bool recover(const int &error);                           // Restart both streams after an xrun or a suspend.
+    void close_device();
 };
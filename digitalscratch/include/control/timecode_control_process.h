@@ -34,6 +34,7 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
 #include <QSharedPointer>
 #include <QObject>
 
@@ -51,6 +52,7 @@ class Timecode_control_process : public Control_process
  private:
     dscratch_handle_t dscratch_handle;
     unsigned short int waitfor_emit_speed_changed; // Do not update speed (in gui) every time.
+    std::atomic<bool>  detecting_vinyl;            // Vinyl type and RPM detection is running (set by GUI, cleared by run()).
 
  public:
     Timecode_control_process(const QSharedPointer<Playback_parameters> &param,
@@ -64,4 +66,11 @@ class Timecode_control_process : public Control_process
 
     void set_vinyl_type(dscratch_vinyls_t vinyl_type);
     void set_vinyl_rpm(dscratch_vinyl_rpm_t vinyl_rpm);
+    dscratch_vinyls_t    get_vinyl_type();
+    dscratch_vinyl_rpm_t get_vinyl_rpm();
+
+    void start_vinyl_detection();
+
+ signals:
+    void vinyl_detected(int vinyl_type, int rpm);  // Emitted by the real-time thread, values are read there.
 };
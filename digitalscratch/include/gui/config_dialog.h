@@ -94,9 +94,12 @@ class Config_dialog : public QDialog
     QCheckBox            *auto_jack_connections_check;
     QCheckBox            *device_internal_check;
     QComboBox            *device_internal_select;
+    QComboBox            *period_size_select;
+    QComboBox            *nb_periods_select;
 
     QList<QComboBox*>     vinyl_type_select;
     QList<QComboBox*>     rpm_select;
+    QList<QCheckBox*>     vinyl_detect_check;
     ShortcutQLabel       *kb_switch_playback;
     ShortcutQLabel       *kb_load_track_on_deck;
     ShortcutQLabel       *kb_play_begin_track_on_deck;
@@ -51,6 +51,7 @@
 
 #include "gui/config_dialog.h"
 #include "gui/waveform.h"
+#include "gui/zoomed_waveform.h"
 #include "app/application_settings.h"
 #include "app/application_const.h"
 #include "player/deck_playback_process.h"
@@ -146,6 +147,7 @@ class Deck : public PlaybackQGroupBox
        QLabel                       *track_name;
        QPushButton                  *thru_button;
        QLabel                       *key;
+       Zoomed_waveform              *zoomed_waveform;
        Waveform                     *waveform;
        QHBoxLayout                  *remaining_time_layout;
        QLabel                       *rem_time_minus;
@@ -333,7 +335,7 @@ class Gui : public QObject
     // Track search bar.
     QLineEdit                          *file_search;
     bool                                search_from_begin;
-    unsigned short int                  file_browser_selected_index;
+    int                                 file_browser_selected_index;
     QString                             last_search_string;
 
     // Tag management.
@@ -494,6 +496,7 @@ class Gui : public QObject
     void press_enter_in_search_bar();
     void press_esc_in_search_bar();
     void file_search_string(const QString &text);
+    void select_search_result(const int &number);
     bool show_about_window();
     bool show_scan_audio_keys_dialog();
     void reject_refresh_audio_collection_dialog();
@@ -33,11 +33,11 @@
 #pragma once
 
 #include <QLabel>
+#include <QVector>
+#include <QLine>
 #include "tracks/audio_track.h"
 #include "app/application_const.h"
 
-#define POINTS_MAX_SIZE (this->at->get_max_nb_samples() / 100) // Number of samples for a track of 15 min (divided by 100).
-
 using namespace std;
 
 class Waveform : public QLabel
@@ -55,15 +55,16 @@ class Waveform : public QLabel
     QList<QLabel*>               cue_sliders_number;
     QList<int>                   cue_sliders_position_x;
     QList<float>                 cue_sliders_absolute_position;
-    unsigned int                 end_of_waveform;
-    bool                         force_regenerate_polyline;
-    QPointF                     *points; // Table of points to display.
+    unsigned int                 end_of_waveform;   // Last pixel showing audio data.
+    bool                         force_regenerate_lines;
+    QVector<QLine>               peak_lines;        // One vertical line (min to max) per pixel.
+    QVector<QLine>               rms_lines;         // One vertical line (-rms to +rms) per pixel.
 
  public:
     Waveform(const QSharedPointer<Audio_track> &at, QWidget *parent = 0);
     ~Waveform();
 
-    void reset();                                                             // Clean list of points and force repaint.
+    void reset();                                                             // Clean list of lines and force repaint.
     bool move_slider(const float &position);                                  // Position is between 0.0 and 1.0.
     bool move_cue_slider(const unsigned short &cue_point_num,                 // Position is between 0.0 and 1.0.
                          const float          &position);
@@ -71,7 +72,8 @@ class Waveform : public QLabel
  private:
     void get_area_size();
     bool jump_slider(const int &x_pos);
-    bool generate_polyline();
+    bool generate_lines();                   // Summarize the track overview for each pixel of the area.
+    int  get_y(const int &sample_value);     // Get vertical position of a sample value.
     void draw_cue_slider(const unsigned short &cue_point_num);
 
  protected:
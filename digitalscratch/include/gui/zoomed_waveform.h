@@ -0,0 +1,95 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*------------------------------------------------------( zoomed_waveform.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*   Display a zoomed waveform of the audio track, centered on the playhead   */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <QLabel>
+#include <QTimer>
+#include <QImage>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThreadPool>
+#include "tracks/audio_track.h"
+#include "player/deck_playback_process.h"
+#include "app/application_const.h"
+
+#define ZOOMED_WAVEFORM_FRAMES_PER_PIXEL 256  // Zoom level: number of frames shown by a pixel.
+#define ZOOMED_WAVEFORM_TILE_WIDTH       256  // Width (pixels) of a pre-rendered part of the waveform.
+#define ZOOMED_WAVEFORM_MAX_TILES        32   // Max number of tiles kept in cache.
+#define ZOOMED_WAVEFORM_REFRESH_MS       16   // Refresh period (msec), about the display refresh rate.
+
+using namespace std;
+
+class Zoomed_waveform : public QLabel
+{
+    Q_OBJECT
+
+ private:
+    QSharedPointer<Audio_track>           at;
+    QSharedPointer<Deck_playback_process> playback;          // Playhead position is read from it at each refresh.
+    float                                 position;          // Playhead position, between 0.0 and 1.0 of max track length.
+    bool                                  position_changed;
+    QTimer                                refresh_timer;
+    QThreadPool                           tile_pool;         // Tiles are rendered in this pool (not in the GUI thread).
+    QMutex                                tiles_mutex;       // Protect tiles and pending_tiles.
+    QHash<int, QImage>                    tiles;             // Rendered tiles (key is the tile index in the track).
+    QSet<int>                             pending_tiles;     // Tiles currently rendered.
+    int                                   tiles_height;      // Height of rendered tiles.
+    QAtomicInt                            generation;        // Incremented each time tiles become obsolete.
+    QAtomicInt                            tiles_changed;     // A new tile is available, need repaint.
+
+ public:
+    Zoomed_waveform(const QSharedPointer<Audio_track> &at, QWidget *parent = 0);
+    ~Zoomed_waveform();
+
+    void reset();                                // Drop all tiles (track changed).
+    bool move_slider(const float &position);     // Position is between 0.0 and 1.0.
+    void set_playback(const QSharedPointer<Deck_playback_process> &playback); // Follow playhead of this playback.
+
+ private:
+    void request_tile(const int &tile_index);    // Render a tile in the background if not available.
+    void render_tile(const int &tile_index,      // Render a tile (called in tile pool).
+                     const int &height,
+                     const int &tile_generation);
+    void drop_far_tiles(const int &tile_index);  // Keep cache size bounded (called with tiles_mutex locked).
+    int  get_y(const int &sample_value,          // Get vertical position of a sample value.
+               const int &height);
+
+ private slots:
+    void refresh();                              // Repaint only if something changed.
+
+ protected:
+    virtual void paintEvent(QPaintEvent *);
+};
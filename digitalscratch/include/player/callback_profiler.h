@@ -0,0 +1,107 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------( callback_profiler.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*          Timing histograms of the sound card callback (lock-free)          */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <QString>
+#include <QAtomicInteger>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+using namespace std;
+
+#define PROFILER_NB_BUCKETS      128    // 4 buckets per power of 2 of nanoseconds (up to 4 sec, ~19% precision).
+#define PROFILER_MAX_DECKS       3
+#define PROFILER_REPORT_PERIOD_MS 10000 // Period of the profiling report in the log (if "ds.profiler.info" is enabled).
+
+enum class Profiler_stage
+{
+    CONTROL,   // Timecode analysis or manual control.
+    PLAYBACK,  // Playback of the main track (resampling).
+    SAMPLERS,  // Mixing of the samplers.
+    NB_STAGES
+};
+
+struct Timing_stats
+{
+    quint64 count;
+    quint64 p50_ns;   // Upper bound of the bucket of the percentile.
+    quint64 p99_ns;
+    quint64 max_ns;
+};
+
+// Written by one thread (the real-time one), read by any other one.
+class Timing_histogram
+{
+ private:
+    QAtomicInteger<quint32> buckets[PROFILER_NB_BUCKETS];
+    QAtomicInteger<quint64> max_ns;
+
+ public:
+    Timing_histogram();
+
+    void         add(const quint64 &ns);
+    void         reset();
+    Timing_stats get_stats() const;
+
+    static int     get_bucket(const quint64 &ns);
+    static quint64 get_bucket_upper_bound(const int &bucket);
+};
+
+class Callback_profiler
+{
+ private:
+    Timing_histogram periods;                                                         // Whole callback.
+    Timing_histogram stages[PROFILER_MAX_DECKS][static_cast<int>(Profiler_stage::NB_STAGES)];
+    QAtomicInt       nb_frames;                                                       // Size of the last period.
+    QAtomicInt       reset_requested;
+    QElapsedTimer    timer;                                                           // Used only by the real-time thread.
+
+ public:
+    Callback_profiler();
+
+    // Real-time thread.
+    void    start_period();                                    // Also applies a reset requested by another thread.
+    quint64 get_time_ns() const;                               // Time since the start of the period.
+    void    add_timing(const unsigned short int &deck_index, const Profiler_stage &stage, const quint64 &ns);
+    void    end_period(const unsigned short int &nb_frames);
+
+    // Other threads.
+    void         reset();
+    Timing_stats get_period_stats() const;
+    Timing_stats get_stage_stats(const unsigned short int &deck_index, const Profiler_stage &stage) const;
+    QString      get_report(const unsigned short int &nb_decks,
+                            const unsigned int       &sample_rate,
+                            const int                &nb_xruns,
+                            const float              &dsp_load) const;   // dsp_load < 0: unknown.
+};
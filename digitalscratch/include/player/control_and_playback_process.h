@@ -34,11 +34,13 @@
 #pragma once
 
 #include <QObject>
+#include <QTimer>
 #include "control/timecode_control_process.h"
 #include "control/manual_control_process.h"
 #include "audiodev/audio_io_control_rules.h"
 #include "app/application_const.h"
 #include "player/deck_playback_process.h"
+#include "player/callback_profiler.h"
 
 using namespace std;
 
@@ -60,6 +62,8 @@ class Control_and_playback_process : public QObject
     QSharedPointer<Audio_IO_control_rules>          sound_card;
     unsigned short int                              nb_decks;
     QList<ProcessMode>                              modes;
+    Callback_profiler                               profiler;      // Timings of run() (written by the sound card thread).
+    QTimer                                         *report_timer;
 
  public:
     Control_and_playback_process(const QList<QSharedPointer<Timecode_control_process>> &tcode_controls,
@@ -73,6 +77,16 @@ class Control_and_playback_process : public QObject
     void set_process_mode(const ProcessMode &mode, const unsigned short &deck_index);
     ProcessMode get_process_mode(const unsigned short &deck_index) const;
     bool is_running();
+    Callback_profiler *get_profiler();
+    QString get_profiling_report();
+
+ private:
+    bool play(const unsigned short int &deck_index, QList<float*> &output_buffers, const unsigned short int &nb_buffer_frames);
+    void apply_deck_commands(); // Deck commands are applied by run(), do it when the sound card is stopped.
+    void set_decks_realtime_running(const bool &running);
+
+ private slots:
+    void log_profiling_report();
 
  public slots:
     void init();
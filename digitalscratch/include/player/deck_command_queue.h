@@ -0,0 +1,83 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*---------------------------------------------------( deck_command_queue.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*      Lock-free queue of deck commands (GUI/MIDI -> sound card thread)      */
+/*                                                                            */
+/*============================================================================*/
+
+
+
+#pragma once
+
+#include <QAtomicInteger>
+
+using namespace std;
+
+#define DECK_COMMAND_QUEUE_SIZE 64 // Must be a power of 2.
+
+enum class Deck_command_type
+{
+    STOP,
+    PLAY,
+    PAUSE,
+    RESET,
+    JUMP,           // value = sample index.
+    SAMPLER_STATE,  // value = sampler index, state = play/stop.
+    SAMPLER_RESET,  // value = sampler index.
+    SYNC            // value = ticket of the thread waiting for previous commands.
+};
+
+struct Deck_command
+{
+    Deck_command_type type;
+    unsigned int      value;
+    bool              state;
+};
+
+// Bounded queue, written by any thread, read by one thread (the real-time one).
+class Deck_command_queue
+{
+ private:
+    struct Cell
+    {
+        QAtomicInteger<quint32> sequence;  // Position for which this cell is ready to be written or read.
+        Deck_command            command;
+    };
+    Cell                    cells[DECK_COMMAND_QUEUE_SIZE];
+    QAtomicInteger<quint32> push_position;
+    quint32                 pop_position;  // Used only by the reader.
+
+ public:
+    Deck_command_queue();
+
+    // Other threads.
+    bool push(const Deck_command &command); // False if the queue is full.
+
+    // Real-time thread.
+    bool pop(Deck_command &out_command);    // False if the queue is empty.
+};
@@ -35,10 +35,13 @@
 
 #include <QObject>
 #include <QSharedPointer>
+#include <QAtomicInt>
+#include <QMutex>
 #include <samplerate.h>
 
 #include "tracks/audio_track.h"
 #include "player/playback_parameters.h"
+#include "player/deck_command_queue.h"
 #include "app/application_const.h"
 
 using namespace std;
@@ -47,6 +50,7 @@ using namespace std;
 #define SOUND_STRETCH_POND_MIN                 256
 #define NB_CYCLE_WITHOUT_UPDATE_REMAINING_TIME 20
 #define SOUND_STRETCH_MAX_BUFFER               SHRT_MAX
+#define DECK_COMMAND_SYNC_TIMEOUT_MS           1000
 
 class Deck_playback_process : public QObject
 {
@@ -73,6 +77,11 @@ class Deck_playback_process : public QObject
     float                                 src_float_input_data[SOUND_STRETCH_MAX_BUFFER];
     float                                 src_float_output_data[SOUND_STRETCH_MAX_BUFFER];
     short signed int                      src_int_output_data[SOUND_STRETCH_MAX_BUFFER];
+    Deck_command_queue                    commands;                       // Changes requested by GUI/MIDI threads.
+    QAtomicInt                            next_sync_ticket;               // Last ticket given to a thread waiting for its commands.
+    QAtomicInt                            applied_sync_ticket;            // Last ticket reached by the real-time thread.
+    QAtomicInt                            realtime_running;               // 1 if a real-time thread applies the commands.
+    QMutex                                inline_commands_lock;           // Other threads applying commands while the real-time one is stopped.
 
  public:
     Deck_playback_process(const QSharedPointer<Audio_track>         &at,
@@ -82,10 +91,14 @@ class Deck_playback_process : public QObject
     virtual ~Deck_playback_process();
 
     bool run(float io_playback_buf_1[], float io_playback_buf_2[], const unsigned short int &buf_size);
-
-    void stop();
-    void pause();
-    void play();
+    bool run_track(float io_playback_buf_1[], float io_playback_buf_2[], const unsigned short int &buf_size);    // First part of run(), applies pending commands.
+    bool run_samplers(float io_playback_buf_1[], float io_playback_buf_2[], const unsigned short int &buf_size); // Second part of run().
+
+    // Changes of the deck (stop, jump, sampler state,...) requested by GUI/MIDI threads are queued,
+    // the real-time thread applies them at the beginning of the next run(). They return false if the queue is full.
+    bool stop();
+    bool pause();
+    bool play();
     bool reset();
     bool jump_to_position(const float &position);
     float get_position(); // 0.0 < position < 1.0
@@ -100,12 +113,19 @@ class Deck_playback_process : public QObject
     QString get_cue_point_str(const unsigned short int &cue_point_number) const;
 
     bool reset_sampler(const unsigned short int &sampler_index);
-    void del_sampler(const unsigned short int &sampler_index);
+    bool del_sampler(const unsigned short int &sampler_index);            // Wait for the sampler to be stopped.
     bool get_sampler_state(const unsigned short int &sampler_index);
     bool set_sampler_state(const unsigned short int &sampler_index, const bool &state);
     bool is_sampler_loaded(const unsigned short int &sampler_index);
 
+    void apply_commands(); // Real-time thread, or the owner of the sound card when it is stopped.
+    bool wait_for_commands(); // Wait until commands pushed by this thread are applied (applied here if there is no real-time thread).
+    void set_realtime_running(const bool &running); // Owner of the sound card, when it starts/stops.
+
  private:
+    bool push_command(const Deck_command_type &type, const unsigned int &value = 0, const bool &state = false);
+    void change_sampler_state(const unsigned short int &sampler_index, const bool &state);
+
     bool play_silence(QVector<float*> &io_playback_bufs, const unsigned short int &buf_size);
     bool play_main_track(QVector<float*> &io_playback_bufs, const unsigned short int &buf_size);
     bool play_samplers(QVector<float*> &io_playback_bufs, const unsigned short int &buf_size);
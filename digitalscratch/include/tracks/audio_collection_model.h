@@ -42,35 +42,64 @@
 #include <QPixmap>
 #include <QList>
 #include <QSharedPointer>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QSet>
+#include <QHash>
+#include <QAtomicInt>
 
 #include "tracks/playlist.h"
+#include "tracks/data_persistence.h"
+#include "utils.h"
 
 using namespace std;
 
 #define COLUMN_FILE_NAME 0
 #define COLUMN_KEY       1
-#define COLUMN_TAGS      2
-#define COLUMN_PATH      3
+#define COLUMN_BPM       2
+#define COLUMN_TAGS      3
+#define COLUMN_PATH      4
+
+#define BPM_NOT_DETECTED -1.0 // Track already analysed, but no tempo found (0.0 means not analysed yet).
+
+#define DIRECTORY_CHANGES_DELAY_MS 1000 // Wait for changes on disk to settle (e.g. file being copied) before scanning them.
+#define SEARCH_PAGE_SIZE           200  // Number of search results sent to the view at once.
+#define FETCH_ROWS_BATCH_SIZE      500  // Number of rows shown to the view at once (more are fetched while scrolling).
+#define READ_DB_CHUNK_SIZE         500  // Number of items read from DB between two checks of a stop request.
+
+// Result of the scan of collection directories which changed on disk.
+struct Directory_changes
+{
+    QStringList                 scanned_directories;  // Directories which changed (existing or not).
+    QHash<QString, QStringList> sub_directories;      // Sub directories of each scanned directory which still exists.
+    QList<File_index_entry>     files;                // Audio files of scanned directories (and of their new sub directories).
+    QStringList                 new_directories;      // New directories to watch.
+};
 
 class Audio_collection_item
 {
  public:
     QList<Audio_collection_item*>  childItems;
  private:
-    QList<QVariant>                itemData;
     Audio_collection_item         *parentItem;
-    QString                        fullPath;
-    bool                           directoryFlag;
+    QString                        fullPath;                // File name and path columns are parts of it.
     QString                        fileHash;
+    QStringList                    tags;
+    float                          bpm;
+    unsigned int                   first_beat;
+    qint8                          key_code;                // Music key as a compact code (see Utils::get_music_key_code()).
+    bool                           directoryFlag;
     bool                           next_key;
     bool                           next_major_key;
 
  public:
-    Audio_collection_item(const QList<QVariant>       &in_data,
-                                QString                in_file_hash    = "",
-                                QString                in_full_path    = "",
-                                bool                   in_is_directory = false,
-                                Audio_collection_item *in_parent       = 0);
+    static QAtomicInt              key_changes;             // Incremented each time the key of an item changes.
+
+ public:
+    Audio_collection_item(QString                in_file_hash    = "",
+                          QString                in_full_path    = "",
+                          bool                   in_is_directory = false,
+                          Audio_collection_item *in_parent       = 0);
     ~Audio_collection_item();
 
     void                   append_child(Audio_collection_item *in_item);
@@ -79,15 +108,20 @@ class Audio_collection_item
     Audio_collection_item *get_parent();
 
     int                    get_row() const;
-    int                    get_column_count() const;
-    QVariant               get_data(int in_column) const;
+    QVariant               get_data(int in_column) const;   // Column value, built from item fields.
     void                   set_data(int in_column, QVariant in_data);
     QString                get_full_path();
     QString                get_file_hash() const;
+    unsigned int           get_first_beat() const;
+    int                    get_key_code() const;
 
     bool                   read_from_db();
+    void                   set_metadata(const Track_metadata &metadata);
     void                   store_to_db();
+    void                   queue_to_db();                  // Store to DB later, with other items (see write_collection_to_db()).
+    Track_metadata         get_metadata() const;
     void                   compute_audio_characteristics();
+    bool                   needs_analysis() const;         // Key or tempo were never computed (failed tempo detection is not done again).
 
     bool                   is_directory();
 
@@ -99,7 +133,7 @@ class Audio_collection_item
     void                   set_tag_list(const QStringList &tags);
 
  private:
-    void calculate_music_key();
+    void analyse_audio_file();
 };
 
 class Audio_collection_model : public QAbstractItemModel
@@ -107,16 +141,34 @@ class Audio_collection_model : public QAbstractItemModel
     Q_OBJECT
     
  public:
-    QSharedPointer<QFutureWatcher<void>>  concurrent_watcher_read;
-    QSharedPointer<QFutureWatcher<void>>  concurrent_watcher_analyze;
+    QSharedPointer<QFutureWatcher<void>>               concurrent_watcher_read;
+    QSharedPointer<QFutureWatcher<void>>               concurrent_watcher_analyze;
+    QSharedPointer<QFutureWatcher<Directory_changes>>  concurrent_watcher_changes;  // Scan of directories which changed on disk.
 
  private:
     Audio_collection_item         *rootItem;
+    QStringList                    header_titles;
+    int                            nb_fetched_rows;          // Rows of root item already shown to the view.
     QSharedPointer<QFuture<void>>  concurrent_future;
     QPixmap                        audio_file_icon;
     QPixmap                        directory_icon;
     QList<Audio_collection_item*>  audio_item_list;
     QString                        root_path;
+    QFileSystemWatcher             directory_watcher;        // Watch directories of the collection.
+    QTimer                         directory_changes_timer;  // Delay scan of changed directories.
+    QSet<QString>                  changed_directories;      // Directories waiting to be scanned.
+    unsigned int                   watch_generation;         // Incremented when collection is cleared (drop running scan).
+    unsigned int                   changes_generation;       // Value of watch_generation when the running scan started.
+    QList<Audio_collection_item*>  new_item_list;            // Items added by directory changes (to analyse).
+    QHash<QString, Audio_collection_item*> item_by_path;     // Items of audio files by full path.
+    QList<Audio_collection_item*>  search_result_list;       // Items found by the last search (so far).
+    QAtomicInt                     search_generation;        // Incremented by each search (stop the previous one).
+    QAtomicInt                     read_generation;          // Incremented to stop reading the collection from DB.
+    QFuture<void>                  search_future;
+    QList<Audio_collection_item*>  items_by_key[NB_MUSIC_KEYS];  // Items by music key code (inverted index).
+    bool                           key_index_valid;             // Index of keys is up to date with the list of items,
+    int                            key_index_changes;           // and with item keys (value of Audio_collection_item::key_changes).
+    QList<Audio_collection_item*>  next_key_items;              // Items highlighted by set_next_keys().
 
  public:
     explicit Audio_collection_model(QObject *in_parent = 0);
@@ -135,10 +187,13 @@ class Audio_collection_model : public QAbstractItemModel
     QModelIndex   parent_from_item(Audio_collection_item &in_item) const;
     int           rowCount(const QModelIndex &in_parent = QModelIndex()) const;
     int           columnCount(const QModelIndex &in_parent = QModelIndex()) const;
+    bool          canFetchMore(const QModelIndex &in_parent) const;
+    void          fetchMore(const QModelIndex &in_parent);
+    void          fetch_all_rows();                             // Show all rows to the view (e.g. before sorting or filtering them).
     QStringList   mimeTypes() const;
     QMimeData    *mimeData(const QModelIndexList &in_indexes) const;
 
-    void concurrent_read_collection_from_db();                  // Call Audio_collection_item::read_from_db() on all collection in separate threads.
+    void concurrent_read_collection_from_db();                  // Read data of the whole collection from DB in a separate thread.
     void stop_concurrent_read_collection_from_db();             // Stop concurrent_read_collection_from_db().
     void concurrent_analyse_audio_collection();                 // Get audio characteristics on all collection in separate threads.
     void concurrent_analyse_audio_selection(QList<Audio_collection_item *> &items);
@@ -146,17 +201,34 @@ class Audio_collection_model : public QAbstractItemModel
     void write_collection_to_db();
     int  get_nb_items();                                        // Get number of files.
     int  get_nb_new_items();                                    // Get number of new files (i.e. files with missing data such as music key).
-    void set_next_keys(QString in_next_key,                     // Set flags for previous/next keys (for all items).
-                       QString in_previous_key,
-                       QString in_next_major_key);
+    void set_next_keys(const int &in_key_code);                 // Set flags for items of previous/next/opposite keys of a key code
+                                                                // (-1: reset flags only).
 
     void set_icons(QPixmap in_audio_file_icon,
                    QPixmap in_directory_icon);
-    QModelIndexList search(QString in_text);
+    static Search_query get_search_query(const QString &in_text);  // Parse a search text, e.g. "artist title key:8A bpm:120-128 tag:house".
+    void        search(const QString &in_text);                    // Start a search, results are added while they are found.
+    int         get_nb_search_results();
+    QModelIndex get_search_result(const int &in_number);
     void clear();
 
  private:
-    void setup_model_data(QString in_path, Audio_collection_item *in_item);
-    void setup_model_data_from_tracklist(QStringList in_tracklist, Audio_collection_item *in_item);
+    void setup_model_data(const QList<File_index_entry> &in_files, Audio_collection_item *in_item);
+    void read_items_from_db(const QList<Audio_collection_item*> &in_items,   // Get data of items from DB (by chunks), store unknown ones.
+                            const int                           &in_generation);
     void create_header(QString in_path, bool in_show_path);
+    void fetch_rows(const int &in_last_row);                     // Show rows to the view up to in_last_row.
+    void update_key_index();                                     // Build again index of keys if items or their keys changed.
+    void run_search(const Search_query &in_query, const int &in_generation);  // Get search results page by page (in a separate thread).
+
+ signals:
+    void search_results_available(int in_first_result, int in_nb_results); // New results of the last search.
+
+ private slots:
+    void watch_directories(const QStringList &in_directories);  // Start watching directories (called in the model thread).
+    void on_directory_changed(const QString &in_path);           // Queue a directory which changed on disk.
+    void scan_changed_directories();                             // Scan queued directories in a separate thread.
+    void apply_directory_changes();                              // Insert/remove items according to the scan of changed directories.
+    void add_search_results(const QStringList &in_paths,         // Add a page of search results (called in the model thread).
+                            const int         &in_generation);
 };
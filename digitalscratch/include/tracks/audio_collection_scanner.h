@@ -0,0 +1,65 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*---------------------------------------------( audio_collection_scanner.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*  Scan audio files of a collection, using an index to not hash them again   */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include "tracks/data_persistence.h"
+
+using namespace std;
+
+class Audio_collection_scanner
+{
+ private:
+    int         nb_hashed_files;  // Number of files hashed during the last scan (others were found in the file index).
+    QStringList sub_directories;  // Directories found under the root path during the last scan.
+
+ public:
+    Audio_collection_scanner();
+    virtual ~Audio_collection_scanner();
+
+    bool scan_directory(const QString           &root_path,  // Recursively get audio files (directories first, sorted by name)
+                        QList<File_index_entry> &out_files,  // and their hash. Directories are listed in parallel.
+                        const bool              &recursive = true);
+    bool scan_files(const QStringList       &paths,          // Get hash of a list of audio files (non audio files are skipped).
+                    QList<File_index_entry> &out_files);
+    int                get_nb_hashed_files();
+    const QStringList &get_sub_directories();                // Directories found by the last scan_directory() (root excluded).
+
+ private:
+    void update_hashes(QList<File_index_entry>                &files,  // Use hash from the file index if size and modification time
+                       const QHash<QString, File_index_entry> &index); // did not change, otherwise compute it (in parallel).
+};
@@ -0,0 +1,96 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*---------------------------------( audio_file_analysis_decoding_process.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*      Behavior class: decode an audio file for analysis (key, bpm,...)      */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <iostream>
+#include <QString>
+#include <QVector>
+
+#include "app/application_const.h"
+
+extern "C"
+{
+    #include "libavcodec/avcodec.h"
+    #include "libavformat/avformat.h"
+    #include "libswresample/swresample.h"
+}
+
+using namespace std;
+
+// Decode an audio file as mono float samples at a low sample rate, which is
+// all the analysis algorithms need. Buffers are kept between 2 runs, so the
+// same object should be reused to analyse many files (one object per thread).
+class Audio_file_analysis_decoding_process
+{
+ private:
+    unsigned int              sample_rate;        // Sample rate of decoded samples.
+    unsigned short int        nb_segments;        // Number of parts of the track to decode (0 = full track).
+    unsigned int              segment_length;     // Length of a decoded part (sec).
+    QVector<float>            samples;            // Decoded mono samples (buffer is only growing).
+    unsigned int              nb_samples;         // Number of used samples in the buffer.
+    unsigned int              max_nb_samples;     // Max number of decoded samples.
+    QVector<short signed int> short_samples;      // Decoded samples converted to integer.
+    QVector<unsigned int>     segment_positions;  // Position (msec) in the track of each decoded part.
+    QVector<unsigned int>     segment_starts;     // Index of the first sample of each decoded part.
+
+ public:
+    Audio_file_analysis_decoding_process(const unsigned int       &sample_rate    = ANALYSIS_SAMPLE_RATE,
+                                         const unsigned short int &nb_segments    = ANALYSIS_NB_SEGMENTS,
+                                         const unsigned int       &segment_length = ANALYSIS_SEGMENT_LENGTH);
+    virtual ~Audio_file_analysis_decoding_process();
+
+    bool                    run(const QString &path); // Decode the audio file.
+    void                    clear();                  // Forget decoded samples (buffers are kept).
+    const float            *get_samples() const;      // Get a pointer on the table of decoded mono samples.
+    const short signed int *get_short_samples();      // Same as get_samples() but samples are converted to integer.
+    unsigned int            get_nb_samples() const;   // Get number of decoded samples.
+    unsigned int            get_sample_rate() const;  // Get sample rate of decoded samples.
+
+    const QVector<unsigned int> &get_segment_positions() const; // Get position (msec) in the track of decoded parts.
+    const QVector<unsigned int> &get_segment_starts() const;    // Get index of the first sample of decoded parts.
+
+ private:
+    bool decode(const QString &path);                       // Internal audio decoding.
+    bool decode_segment(AVFormatContext    *format_context, // Decode from current position until segment is full.
+                        AVCodecContext     *codec_context,
+                        AVStream           *audio_stream,
+                        AVFrame            *frame,
+                        SwrContext         *swr,
+                        const unsigned int &max_segment_nb_samples);
+    bool append_frame(AVFrame            *frame,            // Convert a decoded frame and add it to the samples.
+                      AVStream           *audio_stream,
+                      SwrContext         *swr,
+                      const unsigned int &max_segment_nb_samples,
+                      unsigned int       &segment_nb_samples);
+};
@@ -72,6 +72,7 @@ class Audio_file_decoding_process : public QObject
 
  private:
     void resample_track();                    // Change sample rate of the audio track.
+    void compute_overview();                  // Summarize samples (or get summary from DB).
     bool decode();                            // Internal audio decoding.
     int  decode_packet_to_frame(AVCodecContext *codec_context,
                                 AVFrame *frame,
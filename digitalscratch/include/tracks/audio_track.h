@@ -38,6 +38,7 @@
 #include <QStringList>
 
 #include <app/application_const.h>
+#include "tracks/audio_track_overview.h"
 
 using namespace std;
 
@@ -55,7 +56,10 @@ class Audio_track : public QObject
     QString            hash;                      // Hash of the first kbytes of the file.
     QString            music_key;                 // The main musical key of the track.
     QString            music_key_tag;             // The main musical key of the track (get from metadata tag).
+    float              bpm;                       // Tempo of the track.
+    unsigned int       first_beat;                // Position of the first beat (msec), start of the beat grid.
     QStringList        tags;                      // A list of tags associated to the track.
+    Audio_track_overview *overview;               // Summary of the samples at several resolutions (used for display).
 
  public:
     explicit Audio_track(const unsigned int &sample_rate);   // Does not contains any samples.
@@ -85,6 +89,11 @@ class Audio_track : public QObject
     bool              set_music_key(const QString &key);                      // Set music key of the track.
     QString           get_music_key_tag() const;                              // Get music key of the track (from tag).
     bool              set_music_key_tag(const QString &key_tag);              // Set music key of the track (from tag).
+    float             get_bpm() const;                                        // Get tempo of the track.
+    bool              set_bpm(const float &bpm);                              // Set tempo of the track.
+    unsigned int      get_first_beat() const;                                 // Get position of the first beat (msec).
+    bool              set_first_beat(const unsigned int &first_beat);         // Set position of the first beat (msec).
     QStringList       get_tags() const;                                       // Get a list of tags associated to the track.
     bool              set_tags(const QStringList &tags);                      // Set a list of tags associated to the track.
+    Audio_track_overview *get_overview() const;                               // Get multi-resolution summary of samples (null if no samples).
 };
@@ -0,0 +1,77 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------( audio_track_bpm_process.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*    Behavior class: compute tempo (bpm) and beat grid of an audio track     */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <iostream>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "tracks/audio_file_analysis_decoding_process.h"
+#include "app/application_const.h"
+
+using namespace std;
+
+#define BPM_ENVELOPE_HOP   128     // Number of samples summarized by one value of the onset envelope.
+#define BPM_MIN            60.0    // Slowest detected tempo.
+#define BPM_MAX            200.0   // Fastest detected tempo.
+#define BPM_PRIOR_CENTER   120.0   // Most probable tempo (used to choose between tempo octaves).
+#define BPM_PRIOR_WIDTH    1.0     // Width of the tempo preference (in octaves).
+#define BPM_NB_HARMONICS   4       // Number of multiples of the beat period used by the comb filter.
+
+class Audio_track_bpm_process
+{
+ private:
+    QSharedPointer<Audio_file_analysis_decoding_process> analysis;
+    float                                                bpm;            // Computed tempo.
+    unsigned int                                         first_beat;     // Position of the first beat (msec).
+    float                                                envelope_rate;  // Nb of onset envelope values per second.
+    QVector<float>                                       onsets;         // Onset envelope of all decoded parts.
+    QVector<int>                                         segment_starts; // Index of first envelope value of each part.
+
+ public:
+    explicit Audio_track_bpm_process(const QSharedPointer<Audio_file_analysis_decoding_process> &analysis);
+    virtual ~Audio_track_bpm_process();
+
+    bool         run();                 // Compute tempo and position of the first beat.
+    float        get_bpm();             // Get computed tempo.
+    unsigned int get_first_beat();      // Get position of the first beat (msec).
+
+ private:
+    void  compute_onset_envelope();                                        // Positive energy variations of the signal.
+    void  compute_autocorrelation(QVector<float> &acf, const int &max_lag); // Periodicities of the onset envelope.
+    float find_beat_period(const QVector<float> &acf,                      // Best beat period (in envelope values).
+                           const int            &min_lag,
+                           const int            &max_lag);
+    float find_beat_phase(const float &period);                            // Position of the first beat in first part.
+};
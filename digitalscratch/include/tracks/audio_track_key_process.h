@@ -37,6 +37,7 @@
 #include <keyfinder_api.h>
 
 #include "tracks/audio_track.h"
+#include "tracks/audio_file_analysis_decoding_process.h"
 #include "app/application_const.h"
 
 using namespace std;
@@ -44,11 +45,15 @@ using namespace std;
 class Audio_track_key_process
 {
  private:
-    QSharedPointer<Audio_track> at;
+    QSharedPointer<Audio_track>                          at;
+    QSharedPointer<Audio_file_analysis_decoding_process> analysis;
+    QString                                              music_key;
 
  public:
     explicit Audio_track_key_process(const QSharedPointer<Audio_track> &at);
+    explicit Audio_track_key_process(const QSharedPointer<Audio_file_analysis_decoding_process> &analysis);
     virtual ~Audio_track_key_process();
 
-    bool run();         // Compute music key of the track and set it to the Audio_track object.
+    bool    run();            // Compute music key of the track (set it to the Audio_track object if any).
+    QString get_music_key();  // Get computed music key (as clock number).
 };
@@ -0,0 +1,83 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*-------------------------------------------------( audio_track_overview.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*    Data class: multi-resolution summary (min/max/rms) of an audio track    */
+/*                                                                            */
+/*============================================================================*/
+
+
+#pragma once
+
+#include <QVector>
+#include <QByteArray>
+
+#include "app/application_const.h"
+
+using namespace std;
+
+#define OVERVIEW_NB_LEVELS     4    // Number of resolutions of the overview.
+#define OVERVIEW_BASE_BIN_SIZE 64   // Number of frames summarized by a bin of the most detailed level.
+#define OVERVIEW_LEVEL_FACTOR  4    // Number of bins of a level merged in one bin of the next level.
+#define OVERVIEW_DATA_VERSION  2    // Version of the binary format of the overview.
+#define OVERVIEW_STORED_BIN_MS 5    // Duration of a serialized bin (msec), close to a pixel of the zoomed waveform.
+
+struct Overview_bin
+{
+    short signed int min;   // Lowest sample (of both channels).
+    short signed int max;   // Highest sample (of both channels).
+    short signed int rms;   // Root mean square (of both channels).
+};
+
+class Audio_track_overview
+{
+ private:
+    QVector<Overview_bin> levels[OVERVIEW_NB_LEVELS];  // Bins of each level (allocated once).
+    unsigned int          nb_bins[OVERVIEW_NB_LEVELS]; // Number of used bins in each level.
+    unsigned int          nb_frames;                   // Number of summarized frames.
+
+ public:
+    explicit Audio_track_overview(const unsigned int &max_nb_frames);
+    virtual ~Audio_track_overview();
+
+    void                reset();                                                  // Forget computed bins.
+    void                compute(const short signed int   *samples,                // Summarize interleaved samples (stereo by default).
+                                const unsigned int       &nb_frames,
+                                const unsigned short int &nb_channels = 2);
+    unsigned int        get_bin_size(const unsigned short int &level) const;      // Get number of frames per bin.
+    unsigned int        get_nb_bins(const unsigned short int &level) const;       // Get number of used bins.
+    const Overview_bin *get_bins(const unsigned short int &level) const;          // Get table of bins.
+    unsigned short int  get_level(const unsigned int &nb_frames_per_pixel) const; // Get coarsest level with bins not bigger than a pixel.
+
+    bool                to_byte_array(const unsigned int &sample_rate,            // Serialize (compressed, lower resolution) computed bins.
+                                      QByteArray         &out_data) const;
+    bool                from_byte_array(const QByteArray   &data,                 // Restore serialized bins (for any sample rate).
+                                        const unsigned int &sample_rate);
+
+ private:
+    void                compute_levels();                                         // Compute next levels from the most detailed one.
+};
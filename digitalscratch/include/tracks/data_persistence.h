@@ -35,13 +35,94 @@
 #include <iostream>
 #include <QObject>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QByteArray>
+#include <QHash>
+#include <QCache>
+#include <QThreadStorage>
+#include <QAtomicInt>
 
 #include "tracks/audio_track.h"
 
 using namespace std;
 
+// Types of analysis data stored in DB.
+#define ANALYSIS_WAVEFORM_OVERVIEW "waveform_overview"
+
+// Max number of values bound to one query (SQLite limit is 999).
+#define DB_MAX_BOUND_VALUES 500
+
+// Number of queued tracks written in one transaction.
+#define DB_WRITE_BATCH_SIZE 256
+
+// Time to wait for another connection to release the DB before failing.
+#define DB_BUSY_TIMEOUT_MS 5000
+
+// Max number of tracks kept in the in-memory cache (least recently used ones are dropped).
+#define DB_CACHE_MAX_TRACKS 20000
+
+// Main data of a track, read from DB without creating an Audio_track.
+struct Track_metadata
+{
+    QString      hash;
+    QString      music_key;
+    QString      music_key_tag;
+    float        bpm;
+    unsigned int first_beat;
+    QString      fullpath;
+    QStringList  tags;
+};
+
+// Search of files: text terms (in file name, directory, tags and key) and facets.
+struct Search_query
+{
+    QStringList terms;    // All terms must match (in any order).
+    QString     key;      // Music key (clock number, e.g. "08A"), empty: any key.
+    float       bpm_min;
+    float       bpm_max;  // 0: any tempo.
+    QString     tag;      // Tag name, empty: any tag.
+
+    Search_query() : bpm_min(0.0), bpm_max(0.0) {}
+};
+
+// Cached data of a track (each part is valid only if it was read or written once).
+struct Track_cache_entry
+{
+    bool                     has_track;      // track and track_exists are valid.
+    bool                     track_exists;   // The track is in DB.
+    bool                     has_tags;       // track.tags is valid.
+    Track_metadata           track;
+    QHash<unsigned int, int> cue_points;     // Position (msec) of cue points by number, -1 if there is no cue point.
+    QHash<QString, int>      tag_positions;  // Position in the tracklist of tags by tag name, -1 if not tagged.
+
+    Track_cache_entry() : has_track(false), track_exists(false), has_tags(false)
+    {
+        this->track.bpm        = 0.0;
+        this->track.first_beat = 0;
+    }
+};
+
+// DB connection of one thread, with its own prepared statements.
+struct Db_connection
+{
+    QSqlDatabase                              db;
+    QHash<QString, QSharedPointer<QSqlQuery>> queries;  // Prepared statements, by SQL text.
+    int                                       generation; // Connection is opened again if the DB file was replaced.
+    QString                                   search_filter; // Text filter of the files in temp.SEARCH_RESULT (see search_files()).
+    ~Db_connection();
+};
+
+// Entry of the index of audio files (used to not hash again files which did not change).
+struct File_index_entry
+{
+    QString path;   // Absolute path of the file.
+    qint64  size;   // Size of the file (bytes).
+    qint64  mtime;  // Last modification time (msec since epoch).
+    QString hash;   // Hash of the file (see Utils::get_file_hash()).
+};
+
 class Data_persistence
 {
  public:
@@ -50,16 +131,29 @@ class Data_persistence
 
  public:
     bool is_initialized;
+    bool has_search_index;  // Full-text search index is available (needs SQLite FTS5).
 
  private:
-    QSqlDatabase db;
-    QMutex       mutex;
+    bool                           has_upsert;      // INSERT ... ON CONFLICT DO UPDATE is available (needs SQLite 3.24).
+    QString                        db_path;
+    QThreadStorage<Db_connection*> connections;     // One connection per thread, so readers do not wait for each other.
+    QAtomicInt                     db_generation;   // Changed each time the DB file is replaced.
+    QSqlDatabase                   closed_db;       // Returned to threads which can not open a connection (not kept, opened again next time).
+    QMutex                         mutex;           // Only one writer at a time.
+    QMutex                         pending_mutex;   // Protect pending_tracks.
+    QList<Track_metadata>          pending_tracks;  // Tracks waiting to be written (write-behind).
+    QMutex                         cache_mutex;       // Protect cache and cache_generation.
+    QCache<QString, Track_cache_entry> cache;         // Track data by hash, updated by each write (write-through).
+    quint64                        cache_generation;  // Changed by each write, data read before a write is not cached.
 
  public:
-    bool rollback_transaction();
-
     bool store_audio_track(const QSharedPointer<Audio_track> &at);        // Insert (or update if exists) an audio track in DB.
+    bool queue_audio_track(const Track_metadata &track);                   // Insert (or update) an audio track later, queued tracks are
+                                                                           // written in one transaction when the queue is full.
+    bool flush_audio_tracks();                                             // Write all queued tracks now.
     bool get_audio_track(QSharedPointer<Audio_track> &io_at);             // Get and fill the audio track specified by io_at->get_hash().
+    bool get_audio_tracks(const QStringList               &hashes,        // Get main data and tags of a list of tracks in a few queries.
+                          QHash<QString, Track_metadata>  &out_tracks);   // Tracks not found in DB are not in the result.
 
     bool store_cue_point(const QSharedPointer<Audio_track>   &at,         // Insert (or update) a cue point in DB.
                          const unsigned int                  &number,
@@ -70,6 +164,18 @@ class Data_persistence
     bool delete_cue_point(const QSharedPointer<Audio_track>  &at,         // Delete the in_number cue point of an audio track.
                           const unsigned int                 &number);
 
+    bool store_analysis(const QString    &hash,                            // Insert (or replace) binary analysis data of a track.
+                        const QString    &type,
+                        const QByteArray &data);
+    bool get_analysis(const QString &hash,                                 // Get binary analysis data of a track.
+                      const QString &type,
+                      QByteArray    &out_data);
+
+    bool store_file_index(const QList<File_index_entry> &entries);        // Insert (or replace) entries of the file index (in one transaction).
+    bool get_file_index(const QString                     &root_path,     // Get entries of the file index for all files under root_path.
+                        QHash<QString, File_index_entry>  &out_index);
+    bool delete_file_index(const QStringList &paths);                      // Remove entries of the file index (in one transaction).
+
     bool store_tag(const QString &name);                                   // Insert a new tag.
     bool rename_tag(const QString &old_name,                               // Rename a tag.
                     const QString &new_name);
@@ -84,6 +190,14 @@ class Data_persistence
                              QStringList                       &out_tags);
     bool get_tracks_from_tag(const QString                     &tag_name,  // Get the list of tracks for the specified tag.
                              QStringList                       &out_tracklist);
+
+    bool search_files(const Search_query &search,                          // Get paths of files matching the search (sorted),
+                      const QString      &after_path,                      // starting after after_path (previous page),
+                      const int          &limit,                           // at most limit paths.
+                      QStringList        &out_paths);
+
+    void invalidate_cache(const QString &hash);                            // Drop cached data of a track (read it again from DB next time).
+    void clear_cache();                                                    // Drop all cached data.
     bool switch_track_positions_in_tag_list(const QString &tag_name,                // In the tracklist of a specified tag,
                                             const QSharedPointer<Audio_track> &at1, // Switch position of 2 tracks.
                                             const QSharedPointer<Audio_track> &at2);
@@ -91,6 +205,20 @@ class Data_persistence
  private:
     bool init_db();
     bool create_db_structure();
+    bool create_search_index();                                            // Create (and fill) full-text index of files, kept up to date by triggers.
+    bool fill_search_result(const QStringList &match_terms,                // Put files matching text terms in temp.SEARCH_RESULT
+                            const QString     &like_term);                 // (of the connection of the current thread).
+    QSqlDatabase &get_db();                                                // Get the connection of the current thread, open it the first time.
+    QSqlQuery &get_query(const QString &sql);                              // Get a prepared statement of the current thread, prepare it only the first time.
+    bool upsert_audio_tracks(const QList<Track_metadata> &tracks);         // Insert or update tracks in one transaction (mutex must be locked).
+    Track_cache_entry *get_cache_entry(const QString &hash);               // Get (or create) cached data of a track (cache_mutex must be locked).
+    void set_cached_track(const QString        &hash,                      // Cache main data and tags of a track read from DB
+                          const Track_metadata *track,                     // (nullptr if not in DB), if nothing was written since
+                          const quint64        &generation);               // generation (cache_mutex must be locked).
+    void invalidate_cached_tags();                                         // Drop cached tags and tracklist positions of all tracks.
+    bool add_column_if_missing(const QString &table,                       // Upgrade structure of a DB created by a previous version.
+                               const QString &column,
+                               const QString &type);
     bool store_track_tag(const QString &id_track,
                          const QString &id_tag);
     bool reorganize_track_pos_in_tag_list();                               // If track/tag association has no position in the track list
@@ -103,5 +231,9 @@ class Data_persistence
                                         const int &position);
 #ifndef ENABLE_TEST_MODE
     void backup_db();
+#else
+ public:
+    bool reset_db();                                                       // Remove all data (create the DB file again).
+    bool set_has_upsert(const bool &has_upsert);                           // Write as with (or without) SQLite upsert, return previous value.
 #endif
 };
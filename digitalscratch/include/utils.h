@@ -34,23 +34,20 @@
 
 #include <QString>
 #include <QLocale>
+#include <QByteArray>
 
 #include "app/application_const.h"
 
 using namespace std;
 
+// Music keys as compact codes: 0-11 are minor keys 01A-12A, 12-23 are major keys 01B-12B.
+#define NB_MUSIC_KEYS 24
+
 class Utils
 {
  public:
     static QStringList audio_file_extensions;
 
- private:
-    static QList<QString> minor_keys;
-    static QList<QString> major_keys;
-
- private:
-    static void setup_keys();
-
  public:
     // Get a MD5 hash from in_kbytes bytes of the specified file.
     static QString get_file_hash(const QString &path, const unsigned int &kbytes = 1);
@@ -61,6 +58,16 @@ class Utils
     // Compute music key of an audio file.
     static QString get_file_music_key(const QString &path);
 
+    // Compute music key, tempo and first beat position (msec) of an audio file (decoded only once).
+    static bool analyse_audio_file(const QString &path,
+                                   QString       &music_key,
+                                   float         &bpm,
+                                   unsigned int  &first_beat);
+
+    // Compute serialized waveform overview of a full audio file (see Audio_track_overview).
+    static bool get_file_overview(const QString &path,
+                                  QByteArray    &out_data);
+
     // Convert music key as clock number.
     static QString convert_music_key_to_clock_number(const QString &key);
 
@@ -70,6 +77,18 @@ class Utils
                                     QString &prev_key,
                                     QString &next_major_key);
 
+    // Convert music key (clock number) to a compact code (see NB_MUSIC_KEYS), -1 if unknown.
+    static int get_music_key_code(const QString &key);
+
+    // Convert compact music key code to clock number, empty if unknown.
+    static QString get_music_key_from_code(const int &code);
+
+    // Get compatible keys of a key code as masks (bit n is set for key code n):
+    // next and previous keys, and opposite (minor/major) key.
+    static void get_next_music_key_masks(const int &code,
+                                         quint32   &next_keys,
+                                         quint32   &next_major_keys);
+
     static QString get_str_time_from_sample_index(const unsigned int &sample_index,
                                                   const unsigned int &sample_rate,
                                                   const bool         &with_msec);
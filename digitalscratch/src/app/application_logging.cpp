@@ -38,7 +38,9 @@ Q_LOGGING_CATEGORY(DS_APPSETTINGS, "ds.appstgs",  QtInfoMsg)
 Q_LOGGING_CATEGORY(DS_FILE,        "ds.file",     QtInfoMsg)
 Q_LOGGING_CATEGORY(DS_PLAYBACK,    "ds.playback", QtWarningMsg)
 Q_LOGGING_CATEGORY(DS_MUSICKEY,    "ds.musickey", QtWarningMsg)
+Q_LOGGING_CATEGORY(DS_BPM,         "ds.bpm",      QtWarningMsg)
 Q_LOGGING_CATEGORY(DS_SOUNDCARD,   "ds.sndcard",  QtWarningMsg)
 Q_LOGGING_CATEGORY(DS_DB,          "ds.db",       QtWarningMsg)
 Q_LOGGING_CATEGORY(DS_DICER,       "ds.dicer",    QtWarningMsg)
 Q_LOGGING_CATEGORY(DS_GUI,         "ds.gui",      QtInfoMsg)
+Q_LOGGING_CATEGORY(DS_PROFILER,    "ds.profiler", QtWarningMsg)
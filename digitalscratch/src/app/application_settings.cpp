@@ -51,9 +51,10 @@ Application_settings::Application_settings() : settings(APPLICATION_NAME)
     this->available_rpms << RPM_33 << RPM_45;
     this->available_nb_decks << 1 << 2 << 3;
     this->available_sample_rates << 44100 << 48000 << 96000;
+    this->available_period_sizes << 64 << 128 << 256 << 512 << 1024;
+    this->available_nb_periods << 2 << 3 << 4;
 
-    // TODO: add hardware sound card support.
-//    this->available_sound_cards = Sound_card_control_rules::get_device_list();
+    this->available_sound_cards = Sound_card_control_rules::get_device_list();
 
     this->audio_collection_full_refresh = true;
 
@@ -113,6 +114,15 @@ Application_settings::init_settings()
     if (this->settings.contains(SOUND_DRIVER_CFG) == false) {
         this->settings.setValue(SOUND_DRIVER_CFG, this->get_sound_driver_default());
     }
+    if (this->settings.contains(SOUND_CARD_CFG) == false) {
+        this->settings.setValue(SOUND_CARD_CFG, this->get_internal_sound_card_default());
+    }
+    if (this->settings.contains(PERIOD_SIZE_CFG) == false) {
+        this->settings.setValue(PERIOD_SIZE_CFG, this->get_period_size_default());
+    }
+    if (this->settings.contains(NB_PERIODS_CFG) == false) {
+        this->settings.setValue(NB_PERIODS_CFG, this->get_nb_periods_default());
+    }
 
     //
     // Timecode signal detection parameters.
@@ -129,6 +139,11 @@ Application_settings::init_settings()
             this->settings.setValue(QString(DECK_INDEX) + QString::number(i) + "/" + QString(RPM_CFG),
                                     (new QString)->setNum(this->get_rpm_default()));
         }
+        if (this->settings.contains(QString(DECK_INDEX) + QString::number(i) + "/" + QString(VINYL_DETECT_CFG)) == false)
+        {
+            this->settings.setValue(QString(DECK_INDEX) + QString::number(i) + "/" + QString(VINYL_DETECT_CFG),
+                                    this->get_vinyl_detect_default());
+        }
     }
 
     //
@@ -482,6 +497,26 @@ Application_settings::get_available_rpms()
     return this->available_rpms;
 }
 
+void
+Application_settings::set_vinyl_detect(const unsigned short int &deck_index, const bool &do_detect)
+{
+    this->settings.setValue(QString(DECK_INDEX) + QString::number(deck_index)
+                            + "/" + QString(VINYL_DETECT_CFG), do_detect);
+}
+
+bool
+Application_settings::get_vinyl_detect(const unsigned short int &deck_index)
+{
+    return this->settings.value(QString(DECK_INDEX) + QString::number(deck_index)
+                                + "/" + QString(VINYL_DETECT_CFG)).toBool();
+}
+
+bool
+Application_settings::get_vinyl_detect_default()
+{
+    return VINYL_DETECT_DEFAULT;
+}
+
 void
 Application_settings::set_samplers_visible(const bool &is_visible)
 {
@@ -596,6 +631,54 @@ Application_settings::get_available_internal_sound_cards()
     return this->available_sound_cards;
 }
 
+void
+Application_settings::set_period_size(const unsigned int &nb_frames)
+{
+    this->settings.setValue(PERIOD_SIZE_CFG, nb_frames);
+}
+
+unsigned int
+Application_settings::get_period_size()
+{
+    return this->settings.value(PERIOD_SIZE_CFG).toUInt();
+}
+
+unsigned int
+Application_settings::get_period_size_default()
+{
+    return PERIOD_SIZE_DEFAULT;
+}
+
+QList<unsigned int>
+Application_settings::get_available_period_sizes()
+{
+    return this->available_period_sizes;
+}
+
+void
+Application_settings::set_nb_periods(const unsigned int &nb_periods)
+{
+    this->settings.setValue(NB_PERIODS_CFG, nb_periods);
+}
+
+unsigned int
+Application_settings::get_nb_periods()
+{
+    return this->settings.value(NB_PERIODS_CFG).toUInt();
+}
+
+unsigned int
+Application_settings::get_nb_periods_default()
+{
+    return NB_PERIODS_DEFAULT;
+}
+
+QList<unsigned int>
+Application_settings::get_available_nb_periods()
+{
+    return this->available_nb_periods;
+}
+
 QList<unsigned int>
 Application_settings::get_available_sample_rates()
 {
@@ -53,6 +53,7 @@ Audio_IO_control_rules::Audio_IO_control_rules(const unsigned short int &nb_chan
     this->callback_param = nullptr;
     this->do_capture     = true;
     this->running        = false;
+    this->nb_xruns       = 0;
 
 #ifdef ENABLE_TEST_MODE
     this->using_fake_timecode = false;
@@ -79,6 +80,18 @@ Audio_IO_control_rules::set_capture(const bool &do_capture)
     this->do_capture = do_capture;
 }
 
+int
+Audio_IO_control_rules::get_nb_xruns() const
+{
+    return this->nb_xruns.load();
+}
+
+float
+Audio_IO_control_rules::get_dsp_load()
+{
+    return -1.0f;
+}
+
 #ifdef ENABLE_TEST_MODE
 bool
 Audio_IO_control_rules::use_timecode_from_file(const QString &path)
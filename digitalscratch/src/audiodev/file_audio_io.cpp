@@ -0,0 +1,477 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*------------------------------------------------------( file_audio_io.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*        Behavior class: read/write audio from/to WAV files (offline)        */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <QtDebug>
+#include <QtEndian>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <cstring>
+#include <cstdint>
+
+#include "player/control_and_playback_process.h"
+#include "audiodev/audio_io_control_rules.h"
+#include "audiodev/file_audio_io.h"
+#include "app/application_settings.h"
+#include "app/application_logging.h"
+#include "singleton.h"
+
+File_audio_io::File_audio_io(const unsigned short int &nb_channels,
+                             const QStringList        &in_input_paths,
+                             const QStringList        &in_output_paths,
+                             const unsigned short int &nb_buffer_frames) : Audio_IO_control_rules(nb_channels)
+{
+    this->input_paths         = in_input_paths;
+    this->output_paths        = in_output_paths;
+    this->nb_buffer_frames    = nb_buffer_frames;
+    this->nb_processed_frames = 0;
+    this->processing_time_ns  = 0;
+
+    return;
+}
+
+File_audio_io::~File_audio_io()
+{
+    // Close files.
+    this->stop();
+
+    return;
+}
+
+bool
+File_audio_io::start(void *callback_param)
+{
+    if (this->running == true)
+    {
+        return false;
+    }
+
+    // One stereo file per deck.
+    if ((this->nb_buffer_frames == 0) ||
+        (this->input_paths.size() * 2  != this->nb_channels) ||
+        (this->output_paths.size() * 2 != this->nb_channels))
+    {
+        qCWarning(DS_SOUNDCARD) << "one stereo input and output file per deck is needed";
+        return false;
+    }
+
+    // Open all files.
+    this->input_files.clear();
+    this->output_files.clear();
+    for (int i = 0; i < this->input_paths.size(); i++)
+    {
+        Wav_file input;
+        Wav_file output;
+        if ((this->open_input_file(this->input_paths[i], input) == false) ||
+            (this->open_output_file(this->output_paths[i], output) == false))
+        {
+            this->close_files();
+            emit error_msg(QString("Can not open audio files of deck " + QString::number(i + 1) + "."));
+            return false;
+        }
+        this->input_files << input;
+        this->output_files << output;
+    }
+    this->input_buffers.fill(QVector<float>(this->nb_buffer_frames), this->nb_channels);
+    this->output_buffers.fill(QVector<float>(this->nb_buffer_frames), this->nb_channels);
+    this->callback_param      = callback_param;
+    this->running             = true;
+    this->nb_processed_frames = 0;
+    this->processing_time_ns  = 0;
+
+    // Process input files period by period, as fast as possible.
+    Control_and_playback_process *control_and_playback = static_cast<Control_and_playback_process*>(callback_param);
+    QElapsedTimer timer;
+    bool result = true;
+    unsigned short int nb_frames;
+    while ((nb_frames = this->read_period()) > 0)
+    {
+        timer.start();
+        if (control_and_playback->run(nb_frames) == false)
+        {
+            qCWarning(DS_SOUNDCARD) << "can not run control and playback process";
+        }
+        this->processing_time_ns += timer.nsecsElapsed();
+
+        if (this->write_period(nb_frames) == false)
+        {
+            result = false;
+            break;
+        }
+        this->nb_processed_frames += nb_frames;
+    }
+
+    // Complete output files.
+    if (this->stop() == false)
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+bool
+File_audio_io::restart()
+{
+    if (this->start(this->callback_param) == false)
+    {
+        this->running = false;
+        qCWarning(DS_SOUNDCARD) << "can not restart file audio processing";
+    }
+
+    return true;
+}
+
+bool
+File_audio_io::stop()
+{
+    // Write final sizes in headers of output files.
+    bool result = true;
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    for (int i = 0; i < this->output_files.size(); i++)
+    {
+        QFile *file = this->output_files[i].file.data();
+        if ((file->seek(0) == false) ||
+            (write_wav_header(*file, this->output_files[i].nb_frames, 32, true, settings->get_sample_rate()) == false))
+        {
+            qCWarning(DS_SOUNDCARD) << "can not complete output file" << file->fileName();
+            result = false;
+        }
+    }
+    this->close_files();
+    this->running = false;
+
+    return result;
+}
+
+bool
+File_audio_io::get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers)
+{
+    bool result;
+
+    if ((this->do_capture == true) && (nb_buffer_frames <= this->nb_buffer_frames))
+    {
+        // Buffers filled by read_period().
+        for (int i = 0; i < this->input_buffers.size(); i++)
+        {
+            out_buffers << this->input_buffers[i].data();
+        }
+
+#ifdef ENABLE_TEST_MODE
+        // Fill buffer with pre-recorded timecode buffer (circular buffer).
+        result = this->fill_input_buf(nb_buffer_frames, out_buffers);
+#else
+        result = true;
+#endif
+    }
+    else
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+bool
+File_audio_io::get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers)
+{
+    if (nb_buffer_frames > this->nb_buffer_frames)
+    {
+        return false;
+    }
+
+    // Buffers written by write_period().
+    for (int i = 0; i < this->output_buffers.size(); i++)
+    {
+        out_buffers << this->output_buffers[i].data();
+    }
+
+    return true;
+}
+
+quint64
+File_audio_io::get_nb_processed_frames() const
+{
+    return this->nb_processed_frames;
+}
+
+qint64
+File_audio_io::get_processing_time_ns() const
+{
+    return this->processing_time_ns;
+}
+
+bool
+File_audio_io::open_input_file(const QString &path, Wav_file &out_wav)
+{
+    out_wav.file = QSharedPointer<QFile>(new QFile(path));
+    out_wav.nb_frames      = 0;
+    out_wav.nb_read_frames = 0;
+    if (out_wav.file->open(QIODevice::ReadOnly) == false)
+    {
+        qCWarning(DS_SOUNDCARD) << "can not open input file" << path;
+        return false;
+    }
+
+    // RIFF header, then chunks until the data one.
+    QByteArray header = out_wav.file->read(12);
+    if ((header.size() != 12) || (header.startsWith("RIFF") == false) || (header.mid(8, 4) != "WAVE"))
+    {
+        qCWarning(DS_SOUNDCARD) << path << "is not a WAV file";
+        return false;
+    }
+    unsigned short int format      = 0;
+    unsigned short int nb_channels = 0;
+    unsigned int       sample_rate = 0;
+    unsigned short int block_align = 0;
+    out_wav.bits_per_sample = 0;
+    while (out_wav.file->atEnd() == false)
+    {
+        QByteArray chunk = out_wav.file->read(8);
+        if (chunk.size() != 8)
+        {
+            break;
+        }
+        quint32 chunk_size = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(chunk.constData() + 4));
+        if (chunk.startsWith("fmt ") == true)
+        {
+            QByteArray fmt = out_wav.file->read(chunk_size + (chunk_size % 2));
+            if (fmt.size() < 16)
+            {
+                break;
+            }
+            const uchar *data       = reinterpret_cast<const uchar*>(fmt.constData());
+            format                  = qFromLittleEndian<quint16>(data);
+            nb_channels             = qFromLittleEndian<quint16>(data + 2);
+            sample_rate             = qFromLittleEndian<quint32>(data + 4);
+            block_align             = qFromLittleEndian<quint16>(data + 12);
+            out_wav.bits_per_sample = qFromLittleEndian<quint16>(data + 14);
+            if ((format == 0xFFFE) && (fmt.size() >= 26))
+            {
+                // Extensible format: real format is the beginning of the sub format.
+                format = qFromLittleEndian<quint16>(data + 24);
+            }
+        }
+        else if (chunk.startsWith("data") == true)
+        {
+            if (block_align > 0)
+            {
+                quint64 available = static_cast<quint64>(out_wav.file->size() - out_wav.file->pos());
+                out_wav.nb_frames = qMin(static_cast<quint64>(chunk_size), available) / block_align;
+            }
+            break;
+        }
+        else if (out_wav.file->seek(out_wav.file->pos() + chunk_size + (chunk_size % 2)) == false)
+        {
+            break;
+        }
+    }
+
+    // Only stereo 16 bits PCM or 32 bits float.
+    out_wav.is_float = (format == 3);
+    if ((nb_channels != 2) ||
+        ((format != 1) && (format != 3)) ||
+        ((format == 1) && (out_wav.bits_per_sample != 16)) ||
+        ((format == 3) && (out_wav.bits_per_sample != 32)) ||
+        (block_align != nb_channels * out_wav.bits_per_sample / 8))
+    {
+        qCWarning(DS_SOUNDCARD) << path << "is not a stereo 16 bits PCM or 32 bits float WAV file";
+        return false;
+    }
+    if (sample_rate != Singleton<Application_settings>::get_instance().get_sample_rate())
+    {
+        qCWarning(DS_SOUNDCARD) << path << "sample rate is" << sample_rate << "(not resampled)";
+    }
+
+    return true;
+}
+
+bool
+File_audio_io::open_output_file(const QString &path, Wav_file &out_wav)
+{
+    out_wav.file = QSharedPointer<QFile>(new QFile(path));
+    out_wav.bits_per_sample = 32;
+    out_wav.is_float        = true;
+    out_wav.nb_frames       = 0;
+    out_wav.nb_read_frames  = 0;
+    if (out_wav.file->open(QIODevice::WriteOnly | QIODevice::Truncate) == false)
+    {
+        qCWarning(DS_SOUNDCARD) << "can not open output file" << path;
+        return false;
+    }
+
+    // Header is written again with the final size when processing is done.
+    return write_wav_header(*out_wav.file, 0, out_wav.bits_per_sample, out_wav.is_float,
+                            Singleton<Application_settings>::get_instance().get_sample_rate());
+}
+
+unsigned short int
+File_audio_io::read_period()
+{
+    // Stop at the end of the longest input file.
+    quint64 nb_frames = 0;
+    foreach (const Wav_file &input, this->input_files)
+    {
+        nb_frames = qMax(nb_frames, input.nb_frames - input.nb_read_frames);
+    }
+    nb_frames = qMin(nb_frames, static_cast<quint64>(this->nb_buffer_frames));
+
+    for (int i = 0; i < this->input_files.size(); i++)
+    {
+        // Read frames which are still available, shorter files are followed by silence.
+        Wav_file &input         = this->input_files[i];
+        float    *left          = this->input_buffers[i * 2].data();
+        float    *right         = this->input_buffers[i * 2 + 1].data();
+        int       bytes_per_spl = input.bits_per_sample / 8;
+        quint64   nb_read       = qMin(nb_frames, input.nb_frames - input.nb_read_frames);
+        this->io_data.resize(static_cast<int>(nb_read * 2 * bytes_per_spl));
+        if (input.file->read(this->io_data.data(), this->io_data.size()) != this->io_data.size())
+        {
+            qCWarning(DS_SOUNDCARD) << "can not read input file" << input.file->fileName();
+            nb_read = 0;
+        }
+        const uchar *data = reinterpret_cast<const uchar*>(this->io_data.constData());
+        for (quint64 j = 0; j < nb_read; j++)
+        {
+            if (input.is_float == true)
+            {
+                quint32 l = qFromLittleEndian<quint32>(data + j * 8);
+                quint32 r = qFromLittleEndian<quint32>(data + j * 8 + 4);
+                std::memcpy(&left[j],  &l, sizeof(float));
+                std::memcpy(&right[j], &r, sizeof(float));
+            }
+            else
+            {
+                left[j]  = qFromLittleEndian<qint16>(data + j * 4)     / 32768.0f;
+                right[j] = qFromLittleEndian<qint16>(data + j * 4 + 2) / 32768.0f;
+            }
+        }
+        std::fill(left  + nb_read, left  + nb_frames, 0.0f);
+        std::fill(right + nb_read, right + nb_frames, 0.0f);
+        input.nb_read_frames += nb_read;
+    }
+
+    return static_cast<unsigned short int>(nb_frames);
+}
+
+bool
+File_audio_io::write_period(const unsigned short int &nb_frames)
+{
+    this->io_data.resize(nb_frames * 2 * static_cast<int>(sizeof(float)));
+    uchar *data = reinterpret_cast<uchar*>(this->io_data.data());
+    for (int i = 0; i < this->output_files.size(); i++)
+    {
+        // Interleave stereo float samples.
+        const float *left  = this->output_buffers[i * 2].constData();
+        const float *right = this->output_buffers[i * 2 + 1].constData();
+        for (unsigned short int j = 0; j < nb_frames; j++)
+        {
+            quint32 l;
+            quint32 r;
+            std::memcpy(&l, &left[j],  sizeof(float));
+            std::memcpy(&r, &right[j], sizeof(float));
+            qToLittleEndian<quint32>(l, data + j * 8);
+            qToLittleEndian<quint32>(r, data + j * 8 + 4);
+        }
+
+        Wav_file &output = this->output_files[i];
+        if (output.file->write(this->io_data) != this->io_data.size())
+        {
+            qCWarning(DS_SOUNDCARD) << "can not write output file" << output.file->fileName();
+            return false;
+        }
+        output.nb_frames += nb_frames;
+    }
+
+    return true;
+}
+
+bool
+File_audio_io::write_wav_header(QFile                    &file,
+                                const quint64            &nb_frames,
+                                const unsigned short int &bits_per_sample,
+                                const bool               &is_float,
+                                const unsigned int       &sample_rate)
+{
+    // Canonical 44 bytes header of a stereo file.
+    quint32 block_align = 2 * bits_per_sample / 8;
+    quint32 data_size   = static_cast<quint32>(qMin(nb_frames * block_align, static_cast<quint64>(UINT32_MAX - WAV_HEADER_SIZE)));
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.writeRawData("RIFF", 4);
+    stream << static_cast<quint32>(WAV_HEADER_SIZE - 8 + data_size);
+    stream.writeRawData("WAVEfmt ", 8);
+    stream << static_cast<quint32>(16);
+    stream << static_cast<quint16>(is_float == true ? 3 : 1);
+    stream << static_cast<quint16>(2);
+    stream << static_cast<quint32>(sample_rate);
+    stream << static_cast<quint32>(sample_rate * block_align);
+    stream << static_cast<quint16>(block_align);
+    stream << static_cast<quint16>(bits_per_sample);
+    stream.writeRawData("data", 4);
+    stream << data_size;
+
+    return file.write(header) == WAV_HEADER_SIZE;
+}
+
+bool
+File_audio_io::write_wav_file(const QString          &path,
+                              const short signed int *samples,
+                              const quint64          &nb_frames,
+                              const unsigned int     &sample_rate)
+{
+    QFile file(path);
+    if ((file.open(QIODevice::WriteOnly | QIODevice::Truncate) == false) ||
+        (write_wav_header(file, nb_frames, 16, false, sample_rate) == false))
+    {
+        qCWarning(DS_SOUNDCARD) << "can not write WAV file" << path;
+        return false;
+    }
+
+    // Samples are little endian in the file.
+    QByteArray data(static_cast<int>(nb_frames * 2 * sizeof(qint16)), 0);
+    uchar *ptr = reinterpret_cast<uchar*>(data.data());
+    for (quint64 i = 0; i < nb_frames * 2; i++)
+    {
+        qToLittleEndian<qint16>(samples[i], ptr + i * 2);
+    }
+
+    return file.write(data) == data.size();
+}
+
+void
+File_audio_io::close_files()
+{
+    this->input_files.clear();
+    this->output_files.clear();
+}
@@ -75,6 +75,15 @@ Jack_client_control_rules::error_callback(const char *msg)
     qCWarning(DS_SOUNDCARD) << "jack error: " << msg;
 }
 
+int
+Jack_client_control_rules::xrun_callback(void *data)
+{
+    Jack_client_control_rules *jack_client = static_cast<Jack_client_control_rules*>(data);
+    jack_client->nb_xruns.fetchAndAddRelaxed(1);
+
+    return 0;
+}
+
 bool
 Jack_client_control_rules::start(void *callback_param)
 {
@@ -101,6 +110,7 @@ Jack_client_control_rules::start(void *callback_param)
         // Tell the JACK server to call "in_callback" whenever there is work to be done.
         jack_set_process_callback(this->stream, &capture_and_playback_callback, callback_param);
         jack_set_error_function(&error_callback);
+        jack_set_xrun_callback(this->stream, &xrun_callback, this);
 
         // Display the current sample rate.
         Application_settings *settings = &Singleton<Application_settings>::get_instance();
@@ -291,6 +301,17 @@ Jack_client_control_rules::get_input_buffers(const unsigned short int &nb_buffer
     return result;
 }
 
+float
+Jack_client_control_rules::get_dsp_load()
+{
+    if (this->running == false)
+    {
+        return -1.0f;
+    }
+
+    return jack_cpu_load(this->stream);
+}
+
 bool
 Jack_client_control_rules::get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers)
 {
@@ -31,6 +31,8 @@
 /*============================================================================*/
 
 #include <QtDebug>
+#include <QtEndian>
+#include <cerrno>
 
 #include "player/control_and_playback_process.h"
 #include "audiodev/audio_io_control_rules.h"
@@ -39,52 +41,118 @@
 #include "app/application_logging.h"
 #include "singleton.h"
 
-QList<QString> Sound_card_control_rules::get_device_list()
+// Get address of the first sample of a channel in a mmap area, and the distance between samples (in bytes).
+static inline char *get_area_address(const snd_pcm_channel_area_t &area, const snd_pcm_uframes_t &offset, int &out_step)
 {
-    // Get list of available devices.
-    QList<QString> device_names;
-    QList<QAudioDeviceInfo> input_devices = QAudioDeviceInfo::availableDevices(QAudio::AudioInput);
-    foreach(const QAudioDeviceInfo &device, input_devices)
+    out_step = static_cast<int>(area.step / 8);
+    return static_cast<char*>(area.addr) + (area.first + offset * area.step) / 8;
+}
+
+static void convert_from_device(const snd_pcm_channel_area_t &area,
+                                const snd_pcm_uframes_t      &offset,
+                                const snd_pcm_uframes_t      &nb_frames,
+                                const snd_pcm_format_t       &format,
+                                float                        *out_samples)
+{
+    int   step;
+    char *sample = get_area_address(area, offset, step);
+    for (snd_pcm_uframes_t i = 0; i < nb_frames; i++, sample += step)
     {
-       #if 1
-        cout << "Input Device name: " << qPrintable(device.deviceName()) << endl;;
-        cout << "  SupportedChannelCount: "; foreach (auto item, device.supportedChannelCounts()) cout << qPrintable(QString::number(item)) << "/"; cout << endl;
-        cout << "  SupportedSampleRates: "; foreach (auto item, device.supportedSampleRates()) cout << qPrintable(QString::number(item)) << "/"; cout << endl;
-        cout << "  SupportedSampleSizes: "; foreach (auto item, device.supportedSampleSizes()) cout << qPrintable(QString::number(item)) << "/"; cout << endl;
-        cout << "  SupportedCodecs: "; foreach (auto item, device.supportedCodecs()) cout << qPrintable(item) << "/"; cout << endl;
-       #endif
+        switch (format)
+        {
+            case SND_PCM_FORMAT_FLOAT_LE:
+                out_samples[i] = *reinterpret_cast<float*>(sample);
+                break;
+            case SND_PCM_FORMAT_S32_LE:
+                out_samples[i] = static_cast<float>(qFromLittleEndian<qint32>(sample) / 2147483648.0);
+                break;
+            case SND_PCM_FORMAT_S24_LE:
+                // 24 bits in the lowest bytes of 32 bits (upper byte is not always the sign extension).
+                out_samples[i] = static_cast<qint32>(qFromLittleEndian<quint32>(sample) << 8) / 2147483648.0f;
+                break;
+            case SND_PCM_FORMAT_S24_3LE:
+            {
+                // 24 bits in 3 bytes.
+                const uchar *bytes = reinterpret_cast<const uchar*>(sample);
+                qint32       value = static_cast<qint32>((quint32)bytes[0] << 8 | (quint32)bytes[1] << 16 | (quint32)bytes[2] << 24);
+                out_samples[i] = value / 2147483648.0f;
+                break;
+            }
+            default: // SND_PCM_FORMAT_S16_LE
+                out_samples[i] = qFromLittleEndian<qint16>(sample) / 32768.0f;
+                break;
+        }
     }
+}
 
-    QList<QAudioDeviceInfo> output_devices = QAudioDeviceInfo::availableDevices(QAudio::AudioOutput);
-    foreach(const QAudioDeviceInfo &device, output_devices)
+static void convert_to_device(const float                  *in_samples,
+                              const snd_pcm_channel_area_t &area,
+                              const snd_pcm_uframes_t      &offset,
+                              const snd_pcm_uframes_t      &nb_frames,
+                              const snd_pcm_format_t       &format)
+{
+    int   step;
+    char *sample = get_area_address(area, offset, step);
+    for (snd_pcm_uframes_t i = 0; i < nb_frames; i++, sample += step)
     {
-       #if 1
-        cout << "Output Device name: " << qPrintable(device.deviceName()) << endl;;
-        cout << "  SupportedChannelCount: "; foreach (auto item, device.supportedChannelCounts()) cout << qPrintable(QString::number(item)) << "/"; cout << endl;
-        cout << "  SupportedSampleRates: "; foreach (auto item, device.supportedSampleRates()) cout << qPrintable(QString::number(item)) << "/"; cout << endl;
-        cout << "  SupportedSampleSizes: "; foreach (auto item, device.supportedSampleSizes()) cout << qPrintable(QString::number(item)) << "/"; cout << endl;
-        cout << "  SupportedCodecs: "; foreach (auto item, device.supportedCodecs()) cout << qPrintable(item) << "/"; cout << endl;
-       #endif
+        float value = qBound(-1.0f, in_samples[i], 1.0f);
+        switch (format)
+        {
+            case SND_PCM_FORMAT_FLOAT_LE:
+                *reinterpret_cast<float*>(sample) = value;
+                break;
+            case SND_PCM_FORMAT_S32_LE:
+                qToLittleEndian<qint32>(static_cast<qint32>(value * 2147483647.0), sample);
+                break;
+            case SND_PCM_FORMAT_S24_LE:
+                qToLittleEndian<qint32>(static_cast<qint32>(value * 8388607.0f), sample);
+                break;
+            case SND_PCM_FORMAT_S24_3LE:
+            {
+                qint32 value_24 = static_cast<qint32>(value * 8388607.0f);
+                uchar *bytes    = reinterpret_cast<uchar*>(sample);
+                bytes[0] = value_24 & 0xFF;
+                bytes[1] = (value_24 >> 8) & 0xFF;
+                bytes[2] = (value_24 >> 16) & 0xFF;
+                break;
+            }
+            default: // SND_PCM_FORMAT_S16_LE
+                qToLittleEndian<qint16>(static_cast<qint16>(value * 32767.0f), sample);
+                break;
+        }
     }
+}
 
-//    foreach(const QAudioDeviceInfo &in_dev, input_devices)
-//    {
-//        // Look if this input device is also an output device with at least the same numbers of output channels.
-//        if (output_devices.contains(in_dev) == true)
-//        {
-//            // Get the corresponding output device.
-
-
-//            // Sound device supported.
-//            device_names.append(device.deviceName());
-//        }
-//    }
+QList<QString> Sound_card_control_rules::get_device_list()
+{
+    // Get list of available devices (hw:<card number>).
+    QList<QString> device_names;
+    int card = -1;
+    while ((snd_card_next(&card) == 0) && (card >= 0))
+    {
+        char *name = nullptr;
+        if (snd_card_get_name(card, &name) == 0)
+        {
+            qCDebug(DS_SOUNDCARD) << "sound card" << card << ":" << name;
+            free(name);
+        }
+        device_names << QString("hw:") + QString::number(card);
+    }
 
     return device_names;
 }
 
 Sound_card_control_rules::Sound_card_control_rules(const unsigned short int &nb_channels) : Audio_IO_control_rules(nb_channels)
 {
+    this->capture_handle  = nullptr;
+    this->playback_handle = nullptr;
+    this->format          = SND_PCM_FORMAT_UNKNOWN;
+    this->period_size     = 0;
+    this->nb_periods      = 0;
+    this->linked          = false;
+    this->thread_started  = false;
+    this->stop_requested  = 0;
+
     return;
 }
 
@@ -96,18 +164,388 @@ Sound_card_control_rules::~Sound_card_control_rules()
     return;
 }
 
+void *
+Sound_card_control_rules::capture_and_playback_thread(void *data)
+{
+    Sound_card_control_rules *sound_card = static_cast<Sound_card_control_rules*>(data);
+
+    while (sound_card->stop_requested.loadAcquire() == 0)
+    {
+        // Wait for a period of captured data, process it (same as the JACK callback) and play the result.
+        int error = sound_card->read_period();
+        if (error == 0)
+        {
+            Control_and_playback_process *control_and_playback = static_cast<Control_and_playback_process*>(sound_card->callback_param);
+            if (control_and_playback->run(static_cast<unsigned short int>(sound_card->period_size)) == false)
+            {
+                qCWarning(DS_SOUNDCARD) << "can not run control and playback process";
+            }
+            error = sound_card->write_period();
+        }
+
+        // Restart streams after an xrun, stop if the sound card is lost.
+        if ((error < 0) && (sound_card->recover(error) == false))
+        {
+            emit sound_card->error_msg(QString("Sound card stopped working, please check it and restart DigitalScratch."));
+            break;
+        }
+    }
+
+    return nullptr;
+}
+
+bool
+Sound_card_control_rules::open_device(snd_pcm_t *&out_handle, const QString &device, const snd_pcm_stream_t &stream)
+{
+    int err;
+    const char *stream_name = (stream == SND_PCM_STREAM_CAPTURE) ? "capture" : "playback";
+
+    if ((err = snd_pcm_open(&out_handle, device.toStdString().c_str(), stream, 0)) < 0)
+    {
+        qCWarning(DS_SOUNDCARD) << "can not open" << stream_name << "on" << device << ":" << snd_strerror(err);
+        out_handle = nullptr;
+        return false;
+    }
+
+    // Hardware parameters: mmap interleaved access, same format and period for capture and playback.
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    snd_pcm_hw_params_t *hw_params;
+    snd_pcm_hw_params_alloca(&hw_params);
+    snd_pcm_hw_params_any(out_handle, hw_params);
+    if ((err = snd_pcm_hw_params_set_access(out_handle, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED)) < 0)
+    {
+        qCWarning(DS_SOUNDCARD) << "mmap access not supported for" << stream_name << ":" << snd_strerror(err);
+        return false;
+    }
+    if (this->format == SND_PCM_FORMAT_UNKNOWN)
+    {
+        const snd_pcm_format_t formats[] = { SND_PCM_FORMAT_FLOAT_LE, SND_PCM_FORMAT_S32_LE, SND_PCM_FORMAT_S24_3LE,
+                                             SND_PCM_FORMAT_S24_LE,   SND_PCM_FORMAT_S16_LE };
+        for (const snd_pcm_format_t &candidate : formats)
+        {
+            if (snd_pcm_hw_params_test_format(out_handle, hw_params, candidate) == 0)
+            {
+                this->format = candidate;
+                break;
+            }
+        }
+    }
+    if ((err = snd_pcm_hw_params_set_format(out_handle, hw_params, this->format)) < 0)
+    {
+        qCWarning(DS_SOUNDCARD) << "no supported sample format for" << stream_name << ":" << snd_strerror(err);
+        return false;
+    }
+    if ((err = snd_pcm_hw_params_set_channels(out_handle, hw_params, this->nb_channels)) < 0)
+    {
+        qCWarning(DS_SOUNDCARD) << this->nb_channels << "channels not supported for" << stream_name << ":" << snd_strerror(err);
+        return false;
+    }
+    if ((err = snd_pcm_hw_params_set_rate(out_handle, hw_params, settings->get_sample_rate(), 0)) < 0)
+    {
+        qCWarning(DS_SOUNDCARD) << "sample rate of" << settings->get_sample_rate() << "not supported for" << stream_name << ":" << snd_strerror(err);
+        return false;
+    }
+    snd_pcm_uframes_t period_size = this->period_size;
+    unsigned int      nb_periods  = this->nb_periods;
+    if (((err = snd_pcm_hw_params_set_period_size_near(out_handle, hw_params, &period_size, nullptr)) < 0) ||
+        ((err = snd_pcm_hw_params_set_periods_near(out_handle, hw_params, &nb_periods, nullptr)) < 0) ||
+        ((err = snd_pcm_hw_params(out_handle, hw_params)) < 0))
+    {
+        qCWarning(DS_SOUNDCARD) << "can not set buffer parameters for" << stream_name << ":" << snd_strerror(err);
+        return false;
+    }
+    if (period_size != this->period_size)
+    {
+        if ((stream == SND_PCM_STREAM_PLAYBACK) && (this->capture_handle != nullptr))
+        {
+            qCWarning(DS_SOUNDCARD) << "capture and playback periods are different";
+            return false;
+        }
+        qCDebug(DS_SOUNDCARD) << "period size changed by sound card to" << period_size;
+        this->period_size = static_cast<unsigned int>(period_size);
+    }
+    this->nb_periods = nb_periods;
+
+    // Software parameters: wake up every period, streams are started manually (see start_streams()).
+    snd_pcm_sw_params_t *sw_params;
+    snd_pcm_uframes_t    boundary;
+    snd_pcm_sw_params_alloca(&sw_params);
+    snd_pcm_sw_params_current(out_handle, sw_params);
+    snd_pcm_sw_params_get_boundary(sw_params, &boundary);
+    if (((err = snd_pcm_sw_params_set_avail_min(out_handle, sw_params, this->period_size)) < 0) ||
+        ((err = snd_pcm_sw_params_set_start_threshold(out_handle, sw_params, boundary)) < 0) ||
+        ((err = snd_pcm_sw_params(out_handle, sw_params)) < 0))
+    {
+        qCWarning(DS_SOUNDCARD) << "can not set software parameters for" << stream_name << ":" << snd_strerror(err);
+        return false;
+    }
+
+    return true;
+}
+
 bool
 Sound_card_control_rules::start(void *in_callback_param)
 {
-    // TODO
+    if (this->running == true)
+    {
+        return false;
+    }
+
+    // Device is a card number or an ALSA device name.
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    QString device = settings->get_internal_sound_card();
+    bool is_number = false;
+    device.toInt(&is_number);
+    if (is_number == true)
+    {
+        device = "hw:" + device;
+    }
+    this->format      = SND_PCM_FORMAT_UNKNOWN;
+    this->period_size = settings->get_period_size();
+    this->nb_periods  = settings->get_nb_periods();
 
-    // Everything is OK, keep callback parameters.
+    // Open capture and playback streams.
+    if (((this->do_capture == true) &&
+         (this->open_device(this->capture_handle, device, SND_PCM_STREAM_CAPTURE) == false)) ||
+        (this->open_device(this->playback_handle, device, SND_PCM_STREAM_PLAYBACK) == false))
+    {
+        this->close_device();
+        emit error_msg(QString("Can not use sound card " + device + ", please check it, its sample rate and its number of channels in the settings dialog."));
+        return false;
+    }
+    this->linked = (this->capture_handle != nullptr) && (snd_pcm_link(this->capture_handle, this->playback_handle) == 0);
+    qCDebug(DS_SOUNDCARD) << "sound card" << device << "opened with periods of" << this->period_size << "frames x" << this->nb_periods;
+
+    // Buffers given to the control and playback process.
+    this->input_buffers.fill(QVector<float>(static_cast<int>(this->period_size)), this->nb_channels);
+    this->output_buffers.fill(QVector<float>(static_cast<int>(this->period_size)), this->nb_channels);
+
+    // Keep callback parameters and start streams.
     this->callback_param = in_callback_param;
+    if (this->start_streams() == false)
+    {
+        this->close_device();
+        emit error_msg(QString("Can not start sound card " + device + "."));
+        return false;
+    }
+
+    // Capture and playback thread, with real-time priority if allowed.
+    this->stop_requested.storeRelease(0);
+    pthread_attr_t attr;
+    sched_param    param;
+    param.sched_priority = ALSA_THREAD_PRIORITY;
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+    int err = pthread_create(&this->thread, &attr, &capture_and_playback_thread, this);
+    pthread_attr_destroy(&attr);
+    if (err != 0)
+    {
+        qCWarning(DS_SOUNDCARD) << "can not get real-time priority for sound card thread (check rtprio limits), using normal priority";
+        err = pthread_create(&this->thread, nullptr, &capture_and_playback_thread, this);
+    }
+    if (err != 0)
+    {
+        qCWarning(DS_SOUNDCARD) << "can not create sound card thread";
+        this->close_device();
+        return false;
+    }
+    this->thread_started = true;
     this->running        = true;
 
     return true;
 }
 
+bool
+Sound_card_control_rules::start_streams()
+{
+    int err;
+
+    // Play silence until the first period is processed.
+    for (unsigned int i = 0; i < this->nb_periods; i++)
+    {
+        for (int j = 0; j < this->output_buffers.size(); j++)
+        {
+            this->output_buffers[j].fill(0.0f);
+        }
+        if ((err = this->write_period()) < 0)
+        {
+            qCWarning(DS_SOUNDCARD) << "can not prefill playback buffer:" << snd_strerror(err);
+            return false;
+        }
+    }
+
+    // Start capture and playback at the same time (if possible).
+    if (this->capture_handle != nullptr)
+    {
+        if ((err = snd_pcm_start(this->capture_handle)) < 0)
+        {
+            qCWarning(DS_SOUNDCARD) << "can not start capture:" << snd_strerror(err);
+            return false;
+        }
+    }
+    if ((this->linked == false) && ((err = snd_pcm_start(this->playback_handle)) < 0))
+    {
+        qCWarning(DS_SOUNDCARD) << "can not start playback:" << snd_strerror(err);
+        return false;
+    }
+
+    return true;
+}
+
+int
+Sound_card_control_rules::wait_frames(snd_pcm_t *handle, const int &nb_frames)
+{
+    snd_pcm_sframes_t avail;
+    while ((avail = snd_pcm_avail_update(handle)) < nb_frames)
+    {
+        if (avail < 0)
+        {
+            return static_cast<int>(avail);
+        }
+        int err = snd_pcm_wait(handle, ALSA_WAIT_TIMEOUT_MS);
+        if (err == 0)
+        {
+            // Timeout: the sound card does not run anymore.
+            return -EIO;
+        }
+        else if (err < 0)
+        {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+int
+Sound_card_control_rules::read_period()
+{
+    if (this->capture_handle == nullptr)
+    {
+        return 0;
+    }
+
+    snd_pcm_uframes_t nb_read = 0;
+    while (nb_read < this->period_size)
+    {
+        // Map captured frames and convert them to float buffers.
+        int err = this->wait_frames(this->capture_handle, 1);
+        if (err < 0)
+        {
+            return err;
+        }
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t nb_frames = this->period_size - nb_read;
+        if ((err = snd_pcm_mmap_begin(this->capture_handle, &areas, &offset, &nb_frames)) < 0)
+        {
+            return err;
+        }
+        for (int i = 0; i < this->input_buffers.size(); i++)
+        {
+            convert_from_device(areas[i], offset, nb_frames, this->format, this->input_buffers[i].data() + nb_read);
+        }
+        snd_pcm_sframes_t nb_committed = snd_pcm_mmap_commit(this->capture_handle, offset, nb_frames);
+        if (nb_committed < 0)
+        {
+            return static_cast<int>(nb_committed);
+        }
+        else if (static_cast<snd_pcm_uframes_t>(nb_committed) != nb_frames)
+        {
+            return -EPIPE;
+        }
+        nb_read += nb_frames;
+    }
+
+    return 0;
+}
+
+int
+Sound_card_control_rules::write_period()
+{
+    snd_pcm_uframes_t nb_written = 0;
+    while (nb_written < this->period_size)
+    {
+        // Map free frames of the playback buffer and convert float buffers to them.
+        int err = this->wait_frames(this->playback_handle, 1);
+        if (err < 0)
+        {
+            return err;
+        }
+        const snd_pcm_channel_area_t *areas;
+        snd_pcm_uframes_t offset;
+        snd_pcm_uframes_t nb_frames = this->period_size - nb_written;
+        if ((err = snd_pcm_mmap_begin(this->playback_handle, &areas, &offset, &nb_frames)) < 0)
+        {
+            return err;
+        }
+        for (int i = 0; i < this->output_buffers.size(); i++)
+        {
+            convert_to_device(this->output_buffers[i].constData() + nb_written, areas[i], offset, nb_frames, this->format);
+        }
+        snd_pcm_sframes_t nb_committed = snd_pcm_mmap_commit(this->playback_handle, offset, nb_frames);
+        if (nb_committed < 0)
+        {
+            return static_cast<int>(nb_committed);
+        }
+        else if (static_cast<snd_pcm_uframes_t>(nb_committed) != nb_frames)
+        {
+            return -EPIPE;
+        }
+        nb_written += nb_frames;
+    }
+
+    return 0;
+}
+
+bool
+Sound_card_control_rules::recover(const int &error)
+{
+    // Only xruns (-EPIPE) and suspends (-ESTRPIPE) can be recovered.
+    if ((error != -EPIPE) && (error != -ESTRPIPE))
+    {
+        qCWarning(DS_SOUNDCARD) << "sound card error:" << snd_strerror(error);
+        return false;
+    }
+    this->nb_xruns.fetchAndAddRelaxed(1);
+    qCWarning(DS_SOUNDCARD) << "sound card xrun, restarting capture and playback";
+
+    // Restart both streams from a clean state.
+    if (this->capture_handle != nullptr)
+    {
+        snd_pcm_drop(this->capture_handle);
+        snd_pcm_prepare(this->capture_handle);
+    }
+    snd_pcm_drop(this->playback_handle);
+    snd_pcm_prepare(this->playback_handle);
+
+    return this->start_streams();
+}
+
+void
+Sound_card_control_rules::close_device()
+{
+    if (this->capture_handle != nullptr)
+    {
+        if (this->linked == true)
+        {
+            snd_pcm_unlink(this->capture_handle);
+        }
+        snd_pcm_drop(this->capture_handle);
+        snd_pcm_close(this->capture_handle);
+        this->capture_handle = nullptr;
+    }
+    if (this->playback_handle != nullptr)
+    {
+        snd_pcm_drop(this->playback_handle);
+        snd_pcm_close(this->playback_handle);
+        this->playback_handle = nullptr;
+    }
+    this->linked = false;
+}
+
 bool
 Sound_card_control_rules::restart()
 {
@@ -127,33 +565,38 @@ Sound_card_control_rules::restart()
 bool
 Sound_card_control_rules::stop()
 {
-    // Stop the stream.
-    // TODO
-//    if ((this->running == true) && (jack_client_close(this->stream) != 0))
-//    {
-//        qCWarning(DS_SOUNDCARD) << "can not close audio capture/playback.";
-//        return false;
-//    }
-//    else
-//    {
-//        this->running = false;
-//    }
+    // Stop the capture and playback thread, then the streams.
+    if (this->thread_started == true)
+    {
+        this->stop_requested.storeRelease(1);
+        pthread_join(this->thread, nullptr);
+        this->thread_started = false;
+    }
+    this->close_device();
+    this->running = false;
 
     return true;
 }
 
 bool
-Sound_card_control_rules::get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers) const
+Sound_card_control_rules::get_input_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers)
 {
     bool result;
 
-    // TODO
-    Q_UNUSED(nb_buffer_frames);
-    Q_UNUSED(out_buffers);
-
-    if (this->do_capture == true)
+    if ((this->do_capture == true) && (nb_buffer_frames <= this->period_size))
     {
+        // Buffers filled by read_period().
+        for (int i = 0; i < this->input_buffers.size(); i++)
+        {
+            out_buffers << this->input_buffers[i].data();
+        }
+
+#ifdef ENABLE_TEST_MODE
+        // Fill buffer with pre-recorded timecode buffer (circular buffer).
+        result = this->fill_input_buf(nb_buffer_frames, out_buffers);
+#else
         result = true;
+#endif
     }
     else
     {
@@ -164,11 +607,18 @@ Sound_card_control_rules::get_input_buffers(const unsigned short int &nb_buffer_
 }
 
 bool
-Sound_card_control_rules::get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers) const
+Sound_card_control_rules::get_output_buffers(const unsigned short int &nb_buffer_frames, QList<float *> &out_buffers)
 {
-    // TODO
-    Q_UNUSED(nb_buffer_frames);
-    Q_UNUSED(out_buffers);
+    if (nb_buffer_frames > this->period_size)
+    {
+        return false;
+    }
+
+    // Buffers written by write_period().
+    for (int i = 0; i < this->output_buffers.size(); i++)
+    {
+        out_buffers << this->output_buffers[i].data();
+    }
 
     return true;
 }
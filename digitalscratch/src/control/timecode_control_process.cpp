@@ -52,6 +52,7 @@ Timecode_control_process::Timecode_control_process(const QSharedPointer<Playback
     }
 
     this->waitfor_emit_speed_changed = 0;
+    this->detecting_vinyl            = false;
 
     return;
 }
@@ -80,6 +81,18 @@ bool Timecode_control_process::run(const unsigned short int &nb_samples,
         qCWarning(DS_PLAYBACK) << "cannot analyze captured data";
     }
 
+    // Notify when the vinyl type and RPM detection is over.
+    if (this->detecting_vinyl == true)
+    {
+        bool still_detecting = true;
+        if ((dscratch_is_detecting_vinyl(this->dscratch_handle, &still_detecting) == DSCRATCH_SUCCESS) &&
+            (still_detecting == false))
+        {
+            this->detecting_vinyl = false;
+            emit vinyl_detected(this->get_vinyl_type(), this->get_vinyl_rpm());
+        }
+    }
+
     // Calculate speed.
     if (dscratch_get_speed(this->dscratch_handle, &speed) != DSCRATCH_SUCCESS)
     {
@@ -132,3 +145,37 @@ void Timecode_control_process::set_vinyl_rpm(dscratch_vinyl_rpm_t vinyl_rpm)
     }
 }
 
+dscratch_vinyls_t Timecode_control_process::get_vinyl_type()
+{
+    dscratch_vinyls_t vinyl_type = dscratch_get_default_vinyl_type();
+    if (dscratch_get_turntable_vinyl_type(this->dscratch_handle, &vinyl_type) != DSCRATCH_SUCCESS)
+    {
+        qCWarning(DS_PLAYBACK) << "cannot get vinyl type";
+    }
+
+    return vinyl_type;
+}
+
+dscratch_vinyl_rpm_t Timecode_control_process::get_vinyl_rpm()
+{
+    dscratch_vinyl_rpm_t vinyl_rpm = dscratch_get_default_rpm();
+    if (dscratch_get_rpm(this->dscratch_handle, &vinyl_rpm) != DSCRATCH_SUCCESS)
+    {
+        qCWarning(DS_PLAYBACK) << "cannot get turntable RPM";
+    }
+
+    return vinyl_rpm;
+}
+
+void Timecode_control_process::start_vinyl_detection()
+{
+    if (dscratch_start_vinyl_detection(this->dscratch_handle) != DSCRATCH_SUCCESS)
+    {
+        qCWarning(DS_PLAYBACK) << "cannot start vinyl detection";
+    }
+    else
+    {
+        this->detecting_vinyl = true;
+    }
+}
+
@@ -89,15 +89,26 @@ Config_dialog::Config_dialog(QWidget *parent) : QDialog(parent)
     this->device_jack_check->setTristate(false);
     this->auto_jack_connections_check = new QCheckBox(this);
     this->auto_jack_connections_check->setTristate(false);
-// TODO: make it visible when internal sound card is supported.
-//    this->device_internal_check = new QCheckBox(this);
-//    this->device_internal_check->setTristate(false);
-//    this->device_internal_select = new QComboBox(this);
-//    QList<QString> available_sound_cards = this->settings->get_available_internal_sound_cards();
-//    for (int i = 0; i < available_sound_cards.size(); i++)
-//    {
-//        this->device_internal_select->addItem(available_sound_cards.at(i));
-//    }
+    this->device_internal_check = new QCheckBox(this);
+    this->device_internal_check->setTristate(false);
+    this->device_internal_select = new QComboBox(this);
+    QList<QString> available_sound_cards = this->settings->get_available_internal_sound_cards();
+    for (int i = 0; i < available_sound_cards.size(); i++)
+    {
+        this->device_internal_select->addItem(available_sound_cards.at(i));
+    }
+    this->period_size_select = new QComboBox(this);
+    QList<unsigned int> available_period_sizes = this->settings->get_available_period_sizes();
+    for (int i = 0; i < available_period_sizes.size(); i++)
+    {
+        this->period_size_select->addItem(QString::number(available_period_sizes.at(i)));
+    }
+    this->nb_periods_select = new QComboBox(this);
+    QList<unsigned int> available_nb_periods = this->settings->get_available_nb_periods();
+    for (int i = 0; i < available_nb_periods.size(); i++)
+    {
+        this->nb_periods_select->addItem(QString::number(available_nb_periods.at(i)));
+    }
 
     // Init motion detection parameters widgets.
     for (unsigned short int i = 0; i < this->settings->get_nb_decks(); i++)
@@ -119,6 +130,10 @@ Config_dialog::Config_dialog(QWidget *parent) : QDialog(parent)
             rpms->addItem(QString::number(available_rpms.at(k)));
         }
         this->rpm_select << rpms;
+
+        QCheckBox *vinyl_detect = new QCheckBox(this);
+        vinyl_detect->setTristate(false);
+        this->vinyl_detect_check << vinyl_detect;
     }
 
     // Init keyboard shortcuts widgets.
@@ -308,19 +323,29 @@ QWidget *Config_dialog::init_tab_sound_card()
     this->auto_jack_connections_check->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     device_layout->addWidget(this->auto_jack_connections_check, 1, 3, Qt::AlignLeft);
 
-    // Select sound device : choice 2 (internal). // TODO add internal sound card capture support
-//    this->device_internal_check->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-//    device_layout->addWidget(device_internal_check, 2, 1, Qt::AlignLeft);
-//    QLabel *internal_label = new QLabel(tr("Internal"), this);
-//    internal_label->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-//    device_layout->addWidget(internal_label, 2, 2, Qt::AlignLeft);
-//    device_internal_select->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
-//    device_layout->addWidget(device_internal_select, 3, 2, Qt::AlignLeft);
+    // Select sound device : choice 2 (internal, restart required).
+    this->device_internal_check->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(device_internal_check, 2, 1, Qt::AlignLeft);
+    QLabel *internal_label = new QLabel(tr("Internal (ALSA)"), this);
+    internal_label->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(internal_label, 2, 2, Qt::AlignLeft);
+    device_internal_select->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(device_internal_select, 3, 2, Qt::AlignLeft);
+    QLabel *period_size_label = new QLabel(tr("Period size (frames): "), this);
+    period_size_label->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(period_size_label, 4, 2, Qt::AlignLeft);
+    this->period_size_select->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(this->period_size_select, 4, 3, Qt::AlignLeft);
+    QLabel *nb_periods_label = new QLabel(tr("Number of periods: "), this);
+    nb_periods_label->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(nb_periods_label, 5, 2, Qt::AlignLeft);
+    this->nb_periods_select->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    device_layout->addWidget(this->nb_periods_select, 5, 3, Qt::AlignLeft);
 
     // Make device choices exclusive.
     QButtonGroup *device_choices = new QButtonGroup(this);
     device_choices->addButton(this->device_jack_check);
-//    device_choices->addButton(this->device_internal_check);
+    device_choices->addButton(this->device_internal_check);
     device_choices->setExclusive(true);
 
     // Create tab.
@@ -336,13 +361,15 @@ void Config_dialog::fill_tab_sound_card()
     this->auto_jack_connections_check->setChecked(this->settings->get_auto_jack_connections());
     if (this->settings->get_sound_driver() == SOUND_DRIVER_INTERNAL)
     {
-//        this->device_internal_check->setChecked(true);
+        this->device_internal_check->setChecked(true);
     }
     else
     {
         this->device_jack_check->setChecked(true);
     }
-//    this->device_internal_select->setCurrentIndex(this->device_internal_select->findText(this->settings->get_internal_sound_card()));
+    this->device_internal_select->setCurrentIndex(this->device_internal_select->findText(this->settings->get_internal_sound_card()));
+    this->period_size_select->setCurrentIndex(this->period_size_select->findText(QString::number(this->settings->get_period_size())));
+    this->nb_periods_select->setCurrentIndex(this->nb_periods_select->findText(QString::number(this->settings->get_nb_periods())));
 }
 
 QWidget *Config_dialog::init_tab_motion_detect(const unsigned short &deck_index)
@@ -357,9 +384,13 @@ QWidget *Config_dialog::init_tab_motion_detect(const unsigned short &deck_index)
     motion_detect_layout->addWidget(rpm_label,                    1, 0);
     motion_detect_layout->addWidget(this->rpm_select[deck_index], 1, 1);
 
+    QLabel *vinyl_detect_label = new QLabel(tr("Auto-detect vinyl type and RPM: "), this);
+    motion_detect_layout->addWidget(vinyl_detect_label,                    2, 0);
+    motion_detect_layout->addWidget(this->vinyl_detect_check[deck_index], 2, 1, Qt::AlignLeft);
+
     QPushButton *motion_params_reset_to_default = new QPushButton(this);
     motion_params_reset_to_default->setText(tr("Reset to default"));
-    motion_detect_layout->addWidget(motion_params_reset_to_default, 2, 0, Qt::AlignLeft);
+    motion_detect_layout->addWidget(motion_params_reset_to_default, 3, 0, Qt::AlignLeft);
     QObject::connect(motion_params_reset_to_default, &QPushButton::clicked, [this, deck_index](){this->reset_motion_detection_params(deck_index);});
 
     motion_detect_layout->setColumnStretch(0, 0);
@@ -380,6 +411,8 @@ void Config_dialog::fill_tab_motion_detect(const unsigned short int &deck_index)
 
     this->rpm_select[deck_index]->setCurrentIndex(
                 this->rpm_select[deck_index]->findText(QString::number(this->settings->get_rpm(deck_index))));
+
+    this->vinyl_detect_check[deck_index]->setChecked(this->settings->get_vinyl_detect(deck_index));
 }
 
 QWidget *Config_dialog::init_tab_shortcuts()
@@ -678,6 +711,7 @@ void Config_dialog::reset_motion_detection_params(const unsigned short &deck_ind
     // Reset all motion detection parameters to their default values.
     this->rpm_select[deck_index]->setCurrentIndex(
                 this->rpm_select[deck_index]->findText(QString::number(this->settings->get_rpm_default())));
+    this->vinyl_detect_check[deck_index]->setChecked(this->settings->get_vinyl_detect_default());
 }
 
 void Config_dialog::reset_shortcuts()
@@ -731,16 +765,20 @@ Config_dialog::accept()
 
     // Set sound card settings.
     this->settings->set_sample_rate(this->sample_rate_select->currentText().toUInt());
-//    if (this->device_internal_check->isChecked() == true)
-//    {
-//        this->settings->set_sound_driver(SOUND_DRIVER_INTERNAL);
-//    }
-//    else
-//    {
-//        this->settings->set_sound_driver(SOUND_DRIVER_JACK);
-//    }
-    this->settings->set_sound_driver(SOUND_DRIVER_JACK);
-//    this->settings->set_internal_sound_card(this->device_internal_select->currentText());
+    if (this->device_internal_check->isChecked() == true)
+    {
+        this->settings->set_sound_driver(SOUND_DRIVER_INTERNAL);
+    }
+    else
+    {
+        this->settings->set_sound_driver(SOUND_DRIVER_JACK);
+    }
+    if (this->device_internal_select->currentText().isEmpty() == false)
+    {
+        this->settings->set_internal_sound_card(this->device_internal_select->currentText());
+    }
+    this->settings->set_period_size(this->period_size_select->currentText().toUInt());
+    this->settings->set_nb_periods(this->nb_periods_select->currentText().toUInt());
     this->settings->set_auto_jack_connections(this->auto_jack_connections_check->isChecked());
 
     // Set motion detection settings.
@@ -748,6 +786,7 @@ Config_dialog::accept()
     {
         this->settings->set_vinyl_type(i, static_cast<dscratch_vinyls_t>(this->vinyl_type_select[i]->currentData().toInt()));
         this->settings->set_rpm(i, static_cast<dscratch_vinyl_rpm_t>(this->rpm_select[i]->currentText().toInt()));
+        this->settings->set_vinyl_detect(i, this->vinyl_detect_check[i]->isChecked());
     }
 
 
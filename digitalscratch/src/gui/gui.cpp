@@ -225,6 +225,10 @@ Gui::apply_application_settings()
     {
         this->tcode_controls[i]->set_vinyl_type(this->settings->get_vinyl_type(i));
         this->tcode_controls[i]->set_vinyl_rpm(this->settings->get_rpm(i));
+        if (this->settings->get_vinyl_detect(i) == true)
+        {
+            this->tcode_controls[i]->start_vinyl_detection();
+        }
     }
 
     // Change shortcuts.
@@ -410,28 +414,23 @@ Gui::file_search_string(const QString &text)
 {
     if (text != "")
     {
-        // Store search text.
-        this->last_search_string = text;
-
-        // Search text in file browser (get a list of results).
-        QModelIndexList items = this->file_system_model->search(text);
-
-        if (this->search_from_begin == true)
+        if ((this->search_from_begin == true) ||
+            (text != this->last_search_string))
         {
-            // If we found file/dir name that match, return the first one.
-            if (items.size() > 0)
-            {
-                // Select item in file browser.
-                this->file_browser->setCurrentIndex(items[0]);
-                this->file_browser_selected_index = 0;
-            }
+            // Store search text.
+            this->last_search_string = text;
+
+            // Search text in file browser, the first result is selected as soon as it is found.
+            this->file_browser_selected_index = 0;
+            this->file_system_model->search(text);
         }
         else
         {
             // If we found file/dir name that match, return the next one.
-            if (items.size() > 0)
+            int nb_results = this->file_system_model->get_nb_search_results();
+            if (nb_results > 0)
             {
-                if (static_cast<int>(this->file_browser_selected_index + 1 < items.size()))
+                if (this->file_browser_selected_index + 1 < nb_results)
                 {
                     // Select next item in file browser.
                     this->file_browser_selected_index++;
@@ -441,7 +440,7 @@ Gui::file_search_string(const QString &text)
                     // Wrap search, so select first item again.
                     this->file_browser_selected_index = 0;
                 }
-                this->file_browser->setCurrentIndex(items[this->file_browser_selected_index]);
+                this->select_search_result(this->file_browser_selected_index);
             }
 
             this->search_from_begin = true;
@@ -449,6 +448,17 @@ Gui::file_search_string(const QString &text)
     }
 }
 
+void
+Gui::select_search_result(const int &number)
+{
+    // Select item in file browser (search results are items of the source model).
+    QModelIndex index = this->proxy_model->mapFromSource(this->file_system_model->get_search_result(number));
+    if (index.isValid() == true)
+    {
+        this->file_browser->setCurrentIndex(index);
+    }
+}
+
 void
 Gui::analyze_audio_collection(const bool &is_all_files)
 {
@@ -1140,6 +1150,7 @@ Gui::init_decks_area()
     {
         Deck *dk = new Deck(tr("Deck ") + QString::number(i+1), this->ats[i]);
         dk->init_display();
+        dk->zoomed_waveform->set_playback(this->playbacks[i]);
         this->decks.push_back(dk);
         this->decks_layout->addWidget(dk);
     }
@@ -1207,6 +1218,14 @@ Gui::connect_decks_area()
                             this->update_speed_label(in_speed, i);
                         });
 
+        // Store vinyl type and RPM found by the timecode controller.
+        QObject::connect(this->tcode_controls[i].data(), &Timecode_control_process::vinyl_detected, this,
+                        [this, i](int in_vinyl_type, int in_rpm)
+                        {
+                            this->settings->set_vinyl_type(i, static_cast<dscratch_vinyls_t>(in_vinyl_type));
+                            this->settings->set_rpm(i, static_cast<dscratch_vinyl_rpm_t>(in_rpm));
+                        });
+
         // Manual mode only: reset speed to 100% when right clicking on speed label.
         QObject::connect(this->decks[i]->speed, &SpeedQLabel::right_clicked,
                         [this, i]()
@@ -1483,7 +1502,7 @@ Gui::connect_file_control_area()
 
 bool BrowserQSortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    QModelIndex index2 = this->sourceModel()->index(source_row, 2, source_parent); // Tags
+    QModelIndex index2 = this->sourceModel()->index(source_row, COLUMN_TAGS, source_parent); // Tags
 
     // Get list of tags applied to the track.
     QRegularExpression exp("\\s(?!\\w)");
@@ -1534,6 +1553,7 @@ Gui::init_file_browser_area()
     this->file_system_model = new Audio_collection_model();
     this->proxy_model = new BrowserQSortFilterProxyModel();
     this->proxy_model->setSourceModel(this->file_system_model);
+    this->proxy_model->setSortRole(Qt::UserRole);
     this->file_browser = new QTreeView();
     this->file_browser->setModel(this->proxy_model);
     this->file_browser->setSelectionMode(QAbstractItemView::ExtendedSelection);
@@ -1742,6 +1762,8 @@ Gui::filter_tagged_files()
         exp.remove(exp.length()-1, 1);
     }
 
+    // Filter all the items (not only the ones already shown).
+    this->file_system_model->fetch_all_rows();
     this->proxy_model->setFilterRegExp(QRegExp(exp, Qt::CaseInsensitive,
                                                QRegExp::FixedString));
 }
@@ -1800,6 +1822,8 @@ Gui::connect_file_browser_area()
     QObject::connect(this->shortcut_file_search_press_enter, &QShortcut::activated, [this](){this->press_enter_in_search_bar();});
     QObject::connect(this->file_search, &QLineEdit::returnPressed, [this](){this->press_enter_in_search_bar();});
     QObject::connect(this->shortcut_file_search_press_esc, &QShortcut::activated, [this](){this->press_esc_in_search_bar();});
+    QObject::connect(this->file_system_model, &Audio_collection_model::search_results_available,
+                     [this](int in_first_result, int){if (in_first_result == 0) this->select_search_result(0);});
 
     // Progress for file analyzis.
     QObject::connect(this->file_system_model->concurrent_watcher_analyze.data(), &QFutureWatcher<void>::progressRangeChanged,
@@ -2901,6 +2925,15 @@ Gui::run_sampler_decoding_process_on_deck(const unsigned short &deck_index,
     QFileInfo info(item->get_full_path());
     if (info.isFile() == true)
     {
+        // Stop the sampler, its track can only be overwritten when the real-time thread does not play it anymore.
+        this->set_sampler_state(deck_index, sampler_index, false);
+        if ((this->playbacks[deck_index]->set_sampler_state(sampler_index, false) == false) ||
+            (this->playbacks[deck_index]->wait_for_commands() == false))
+        {
+            qCWarning(DS_PLAYBACK) << "can not stop sampler" << sampler_index;
+            return;
+        }
+
         // Execute decoding.
         QList<QSharedPointer<Audio_file_decoding_process>> samplers;
         samplers = this->dec_samplers[deck_index];
@@ -2979,7 +3012,11 @@ Gui::sampler_button_del_clicked(const unsigned short &deck_index,
                                 const unsigned short &sampler_index)
 {
     // Remove track loaded in the sampler.
-    this->playbacks[deck_index]->del_sampler(sampler_index);
+    if (this->playbacks[deck_index]->del_sampler(sampler_index) == false)
+    {
+        qCWarning(DS_PLAYBACK) << "can not remove track from sampler" << sampler_index;
+        return;
+    }
     this->set_sampler_state(deck_index, sampler_index, false);
     this->set_sampler_text("--", deck_index, sampler_index);
 
@@ -3003,7 +3040,8 @@ Gui::on_file_browser_header_click(const int &index)
     // Get the order.
     Qt::SortOrder order = this->file_browser->header()->sortIndicatorOrder();
 
-    // Sort the items.
+    // Sort all the items (not only the ones already shown).
+    this->file_system_model->fetch_all_rows();
     this->proxy_model->sort(index, order);
 }
 
@@ -3062,6 +3100,7 @@ void
 Gui::resize_file_browser_columns()
 {
     this->file_browser->resizeColumnToContents(COLUMN_KEY);
+    this->file_browser->resizeColumnToContents(COLUMN_BPM);
     this->file_browser->resizeColumnToContents(COLUMN_FILE_NAME);
 }
 
@@ -3106,18 +3145,25 @@ Gui::run_audio_file_decoding_process()
         QLabel    *deck_track_name = this->decks[deck_index]->track_name;
         QLabel   **deck_cue_point  = this->decks[deck_index]->cue_point_labels;
         Waveform  *deck_waveform   = this->decks[deck_index]->waveform;
+        Zoomed_waveform *deck_zoomed_waveform = this->decks[deck_index]->zoomed_waveform;
         QSharedPointer<Audio_file_decoding_process> decode_process = this->decs[deck_index];
 
         // Execute decoding if not trying to open the existing track.
         if (info.fileName().compare(deck_track_name->text()) != 0 )
         {
-            // Stop playback.
-            this->playbacks[deck_index]->stop();
+            // Stop playback, the track can only be cleared when the real-time thread does not play it anymore.
+            if ((this->playbacks[deck_index]->stop() == false) ||
+                (this->playbacks[deck_index]->wait_for_commands() == false))
+            {
+                qCWarning(DS_PLAYBACK) << "can not stop playback of deck" << deck_index;
+                return;
+            }
 
             // Clear audio track and waveform.
             decode_process->clear();
             deck_waveform->reset();
             deck_waveform->update();
+            deck_zoomed_waveform->reset();
 
             // Decode track.
             if (decode_process->run(info.absoluteFilePath(), item->get_file_hash(), item->get_data(COLUMN_KEY).toString()) == false)
@@ -3133,10 +3179,12 @@ Gui::run_audio_file_decoding_process()
 
         // Force waveform computation.
         deck_waveform->reset();
+        deck_zoomed_waveform->reset();
 
         // Reset playback process.
         this->playbacks[deck_index]->reset();
         deck_waveform->move_slider(0.0);
+        deck_zoomed_waveform->move_slider(0.0);
 
         // Reset cue points on Dicer.
         dicer_t dicer_index;
@@ -3305,7 +3353,7 @@ Gui::set_remaining_time(const unsigned int &remaining_time, const unsigned short
     }
     this->decks[deck_index]->rem_time_msec->setText(msec);
 
-    // Move slider on waveform when remaining time changed.
+    // Move slider on waveform when remaining time changed (zoomed waveform follows the playhead by itself).
     this->decks[deck_index]->waveform->move_slider(this->playbacks[deck_index]->get_position());
 
     return;
@@ -3756,15 +3804,10 @@ Gui::show_next_keys()
     // Get music key of selected deck/sampler.
     QString deck_key = this->ats[this->get_selected_deck_index()]->get_music_key();
 
-    // Get next and prev keys and iterate over the full audio collection for highlighting.
+    // Highlight tracks of next, previous and opposite keys.
     if (deck_key.length() > 0)
     {
-        // Get next keys and highlight.
-        QString next_key;
-        QString prev_key;
-        QString oppos_key;
-        Utils::get_next_music_keys(deck_key, next_key, prev_key, oppos_key);
-        this->file_system_model->set_next_keys(next_key, prev_key, oppos_key);
+        this->file_system_model->set_next_keys(Utils::get_music_key_code(deck_key));
     }
 
     // Refresh the file browser.
@@ -3863,6 +3906,7 @@ Deck::Deck(const QString &title, const QSharedPointer<Audio_track> &at) : Playba
                                                                           track_name            {nullptr},
                                                                           thru_button           {nullptr},
                                                                           key                   {nullptr},
+                                                                          zoomed_waveform       {nullptr},
                                                                           waveform              {nullptr},
                                                                           remaining_time_layout {nullptr},
                                                                           rem_time_minus        {nullptr},
@@ -3896,6 +3940,7 @@ Deck::~Deck()
     delete this->track_name;
     delete this->thru_button;
     delete this->key;
+    delete this->zoomed_waveform;
     delete this->waveform;
     delete this->remaining_time_layout;
     delete this->buttons_layout;
@@ -3928,6 +3973,8 @@ Deck::init_display()
     this->key = new QLabel();
     this->key->setObjectName("KeyValue");
     this->set_key("");
+    this->zoomed_waveform = new Zoomed_waveform(this->at);
+    this->zoomed_waveform->setObjectName("ZoomedWaveform");
     this->waveform = new Waveform(this->at);
     this->waveform->setObjectName("Waveform");
 
@@ -4078,7 +4125,8 @@ Deck::init_display()
     track_layout->addWidget(this->thru_button, 5);
     sub_layout->addLayout(track_layout,                5);
     sub_layout->addLayout(this->remaining_time_layout, 5);
-    sub_layout->addWidget(this->waveform,              85);
+    sub_layout->addWidget(this->zoomed_waveform,       40);
+    sub_layout->addWidget(this->waveform,              45);
     sub_layout->addLayout(this->buttons_layout,        5);
     general_layout->addLayout(sub_layout,              90);
 
@@ -35,6 +35,8 @@
 #include <QtDebug>
 #include <QMouseEvent>
 #include <iostream>
+#include <algorithm>
+#include <climits>
 #include <math.h>
 
 #include "gui/waveform.h"
@@ -54,10 +56,9 @@ Waveform::Waveform(const QSharedPointer<Audio_track> &at, QWidget *parent) : QLa
     this->area_width  = 0;
     this->slider_absolute_position = 0;
 
-    // Create table of points to display.
-    this->points = new QPointF[POINTS_MAX_SIZE];
+    // Lines to display are generated at first paint.
     this->end_of_waveform = 0;
-    this->force_regenerate_polyline = true;
+    this->force_regenerate_lines = true;
 
     // Create slider.
     this->slider_position_x = 0;
@@ -84,16 +85,13 @@ Waveform::Waveform(const QSharedPointer<Audio_track> &at, QWidget *parent) : QLa
 
 Waveform::~Waveform()
 {
-    // Delete table of points.
-    delete [] this->points;
-
     return;
 }
 
 void
 Waveform::reset()
 {
-    this->force_regenerate_polyline = true;
+    this->force_regenerate_lines = true;
 
     return;
 }
@@ -110,49 +108,72 @@ Waveform::get_area_size()
     {
         this->area_height = new_height;
         this->area_width  = new_width;
-        this->force_regenerate_polyline = true;
+        this->force_regenerate_lines = true;
     }
 
     return;
 }
 
-bool
-Waveform::generate_polyline()
+int
+Waveform::get_y(const int &sample_value)
 {
-    // Get audio track table of samples.
-    unsigned int j = 0;
-    short signed int *samples = this->at->get_samples();
+    return qRound((float)((sample_value - SHRT_MAX) * this->area_height) / (float)(SHRT_MAX * -1 * 2));
+}
 
-    // For each points take a sample (every 100 samples) and convert it to be
-    // displayed in painting area.
+bool
+Waveform::generate_lines()
+{
+    this->peak_lines.clear();
+    this->rms_lines.clear();
     this->end_of_waveform = 0;
-    for (unsigned int i = 0; i < POINTS_MAX_SIZE; i++)
+    this->force_regenerate_lines = false;
+
+    // Get the summary of the track which is precomputed at decoding time.
+    Audio_track_overview *overview = this->at->get_overview();
+    if ((overview == nullptr) || (this->area_width <= 0))
     {
-        // Get sample.
-        short signed int current_sample = samples[j];
+        return false;
+    }
 
-        // Adapt value to paiting area.
-        float x = (float)(this->area_width * i) / (float)POINTS_MAX_SIZE;
-        float y = 0.0;
-        if (j <= this->at->get_end_of_samples())
+    // Use the level of the overview which has about one bin per pixel
+    // (the full width of the area is the max length of a track).
+    float               frames_per_pixel = (float)(this->at->get_max_nb_samples() / 2) / (float)this->area_width;
+    unsigned short int  level            = overview->get_level(frames_per_pixel);
+    const Overview_bin *bins             = overview->get_bins(level);
+    unsigned int        nb_bins          = overview->get_nb_bins(level);
+    float               bins_per_pixel   = frames_per_pixel / (float)overview->get_bin_size(level);
+
+    // For each pixel, merge the bins it covers.
+    this->peak_lines.reserve(this->area_width);
+    this->rms_lines.reserve(this->area_width);
+    for (int x = 0; x < this->area_width; x++)
+    {
+        unsigned int first = x * bins_per_pixel;
+        unsigned int last  = std::min(nb_bins, std::max(first + 1, (unsigned int)((x + 1) * bins_per_pixel)));
+        if (first >= nb_bins)
         {
-            y = (float)(((float)(current_sample - SHRT_MAX) * this->area_height) / (float)(SHRT_MAX * -1 * 2));
-            this->end_of_waveform = i;
+            // There is no more sample (track is finished).
+            break;
         }
-        else
+
+        int   min = SHRT_MAX;
+        int   max = SHRT_MIN;
+        float sum = 0.0;
+        for (unsigned int i = first; i < last; i++)
         {
-            // There is no more sample (track is finish), set polyline to 0.
-            y = (float)(this->area_height / 2);
+            min  = std::min(min, (int)bins[i].min);
+            max  = std::max(max, (int)bins[i].max);
+            sum += (float)bins[i].rms * bins[i].rms;
         }
+        int rms = sqrt(sum / (last - first));
 
-        this->points[i].setX(x);
-        this->points[i].setY(y);
-
-        // Next sample.
-        j += 100;
+        this->peak_lines << QLine(x, this->get_y(max), x, this->get_y(min));
+        this->rms_lines  << QLine(x, this->get_y(rms), x, this->get_y(-rms));
+        this->end_of_waveform = x;
     }
 
-    this->force_regenerate_polyline = false;
+    // Flat line after the end of the track.
+    this->peak_lines << QLine(this->end_of_waveform, this->area_height / 2, this->area_width, this->area_height / 2);
 
     return true;
 }
@@ -163,18 +184,20 @@ Waveform::paintEvent(QPaintEvent *)
     // Get area size.
     this->get_area_size();
 
-    // Generate list of points to draw if size of the waveform changed.
-    if (this->force_regenerate_polyline == true)
+    // Generate list of lines to draw if size of the waveform changed.
+    if (this->force_regenerate_lines == true)
     {
-        this->generate_polyline();
+        this->generate_lines();
     }
 
     QPainter painter;
     painter.begin(this);
 
-    // Draw polyline on current area.
+    // Draw peaks and energy of the track on current area.
     painter.setPen(QColor("grey"));
-    painter.drawPolyline(this->points, POINTS_MAX_SIZE); // waveform from track
+    painter.drawLines(this->peak_lines);
+    painter.setPen(QColor("lightgrey"));
+    painter.drawLines(this->rms_lines);
 
     // Draw minute separators.
     painter.setPen(QColor(0, 102, 0)); // kind of green
@@ -200,9 +223,7 @@ Waveform::jump_slider(const int &x_pos)
     }
 
     // Move slider to new position if possible.
-    unsigned int x_index = floor(((float)x_pos * (float)this->at->get_max_nb_samples())
-                                   / ((float)this->area_width * 100.0));
-    if (x_index <= this->end_of_waveform)
+    if ((x_pos >= 0) && ((unsigned int)x_pos <= this->end_of_waveform))
     {
         this->slider_position_x = x_pos;
         this->slider->setGeometry(this->slider_position_x, 0, 2, this->area_height);
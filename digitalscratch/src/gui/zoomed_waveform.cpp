@@ -0,0 +1,318 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------( zoomed_waveform.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*   Display a zoomed waveform of the audio track, centered on the playhead   */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <QPainter>
+#include <QtDebug>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <climits>
+#include <math.h>
+
+#include "gui/zoomed_waveform.h"
+#include "app/application_logging.h"
+
+Zoomed_waveform::Zoomed_waveform(const QSharedPointer<Audio_track> &at, QWidget *parent) : QLabel(parent)
+{
+    // Get audio track.
+    if (at.data() == nullptr)
+    {
+        qCCritical(DS_OBJECTLIFE) << "audio track can not be null";
+    }
+    this->at = at;
+
+    // Init.
+    this->position         = 0.0;
+    this->position_changed = true;
+    this->tiles_height     = 0;
+    this->generation       = 0;
+    this->tiles_changed    = 0;
+
+    // One thread is enough to render tiles much faster than they are displayed.
+    this->tile_pool.setMaxThreadCount(1);
+
+    // Repaint at display rate (only if needed).
+    QObject::connect(&this->refresh_timer, &QTimer::timeout, this, &Zoomed_waveform::refresh);
+    this->refresh_timer.start(ZOOMED_WAVEFORM_REFRESH_MS);
+
+    return;
+}
+
+Zoomed_waveform::~Zoomed_waveform()
+{
+    this->refresh_timer.stop();
+    this->tile_pool.clear();
+    this->tile_pool.waitForDone();
+
+    return;
+}
+
+void
+Zoomed_waveform::reset()
+{
+    // Wait for tiles being rendered (they read the track overview which is going to change).
+    this->generation.fetchAndAddOrdered(1);
+    this->tile_pool.clear();
+    this->tile_pool.waitForDone();
+
+    // Drop all tiles.
+    QMutexLocker lock(&this->tiles_mutex);
+    this->tiles.clear();
+    this->pending_tiles.clear();
+    this->position_changed = true;
+
+    return;
+}
+
+bool
+Zoomed_waveform::move_slider(const float &position)
+{
+    // Check position.
+    if ((position < 0.0) || (position > 1.0))
+    {
+        return false;
+    }
+
+    // Store position, display will be updated at next refresh.
+    if (position != this->position)
+    {
+        this->position         = position;
+        this->position_changed = true;
+    }
+
+    return true;
+}
+
+void
+Zoomed_waveform::set_playback(const QSharedPointer<Deck_playback_process> &playback)
+{
+    this->playback = playback;
+
+    return;
+}
+
+void
+Zoomed_waveform::refresh()
+{
+    // Follow the playhead at display rate.
+    if (this->playback.data() != nullptr)
+    {
+        this->move_slider(this->playback->get_position());
+    }
+
+    if ((this->position_changed == true) || (this->tiles_changed.fetchAndStoreOrdered(0) != 0))
+    {
+        this->position_changed = false;
+        this->update();
+    }
+
+    return;
+}
+
+int
+Zoomed_waveform::get_y(const int &sample_value,
+                       const int &height)
+{
+    return qRound((float)((sample_value - SHRT_MAX) * height) / (float)(SHRT_MAX * -1 * 2));
+}
+
+void
+Zoomed_waveform::request_tile(const int &tile_index)
+{
+    // Called with tiles_mutex locked.
+    if ((tile_index < 0) ||
+        (this->tiles.contains(tile_index) == true) ||
+        (this->pending_tiles.contains(tile_index) == true))
+    {
+        return;
+    }
+
+    // Render it in the background.
+    this->pending_tiles.insert(tile_index);
+    int height          = this->tiles_height;
+    int tile_generation = this->generation.load();
+    QtConcurrent::run(&this->tile_pool, [this, tile_index, height, tile_generation]()
+    {
+        this->render_tile(tile_index, height, tile_generation);
+    });
+
+    return;
+}
+
+void
+Zoomed_waveform::render_tile(const int &tile_index,
+                             const int &height,
+                             const int &tile_generation)
+{
+    QImage image(ZOOMED_WAVEFORM_TILE_WIDTH, height + 1, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    // Get bins of the track overview which are the closest to the zoom level.
+    Audio_track_overview *overview = this->at->get_overview();
+    if (overview != nullptr)
+    {
+        unsigned short int  level          = overview->get_level(ZOOMED_WAVEFORM_FRAMES_PER_PIXEL);
+        const Overview_bin *bins           = overview->get_bins(level);
+        unsigned int        nb_bins        = overview->get_nb_bins(level);
+        unsigned int        bins_per_pixel = std::max(1u, ZOOMED_WAVEFORM_FRAMES_PER_PIXEL / overview->get_bin_size(level));
+
+        // Draw one peak and one rms line per pixel.
+        QPainter painter(&image);
+        QPen     peak_pen(QColor("grey"));
+        QPen     rms_pen(QColor("lightgrey"));
+        for (int x = 0; x < ZOOMED_WAVEFORM_TILE_WIDTH; x++)
+        {
+            unsigned int first = (tile_index * ZOOMED_WAVEFORM_TILE_WIDTH + x) * bins_per_pixel;
+            unsigned int last  = std::min(first + bins_per_pixel, nb_bins);
+            if (first >= nb_bins)
+            {
+                // Track is finished, draw a flat line.
+                painter.setPen(peak_pen);
+                painter.drawLine(x, height / 2, ZOOMED_WAVEFORM_TILE_WIDTH - 1, height / 2);
+                break;
+            }
+
+            int   min = SHRT_MAX;
+            int   max = SHRT_MIN;
+            float sum = 0.0;
+            for (unsigned int i = first; i < last; i++)
+            {
+                min  = std::min(min, (int)bins[i].min);
+                max  = std::max(max, (int)bins[i].max);
+                sum += (float)bins[i].rms * bins[i].rms;
+            }
+            int rms = sqrt(sum / (last - first));
+
+            painter.setPen(peak_pen);
+            painter.drawLine(x, this->get_y(max, height), x, this->get_y(min, height));
+            painter.setPen(rms_pen);
+            painter.drawLine(x, this->get_y(rms, height), x, this->get_y(-rms, height));
+        }
+        painter.end();
+    }
+
+    // Put tile in cache (if it is still useful).
+    QMutexLocker lock(&this->tiles_mutex);
+    this->pending_tiles.remove(tile_index);
+    if (tile_generation == this->generation.load())
+    {
+        this->tiles.insert(tile_index, image);
+        this->drop_far_tiles(tile_index);
+        this->tiles_changed = 1;
+    }
+
+    return;
+}
+
+void
+Zoomed_waveform::drop_far_tiles(const int &tile_index)
+{
+    // Remove tiles which are the most far from the last rendered one.
+    while (this->tiles.size() > ZOOMED_WAVEFORM_MAX_TILES)
+    {
+        int farthest = tile_index;
+        foreach (int index, this->tiles.keys())
+        {
+            if (abs(index - tile_index) > abs(farthest - tile_index))
+            {
+                farthest = index;
+            }
+        }
+        this->tiles.remove(farthest);
+    }
+
+    return;
+}
+
+void
+Zoomed_waveform::paintEvent(QPaintEvent *)
+{
+    // Get area size.
+    int width  = this->frameSize().width() - 1;
+    int height = this->frameSize().height() - 1;
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // Get the part of the track to show (playhead is in the middle).
+    float nb_pixels_in_track = (float)(this->at->get_max_nb_samples() / 2) / (float)ZOOMED_WAVEFORM_FRAMES_PER_PIXEL;
+    int   left               = qRound(this->position * nb_pixels_in_track) - width / 2;
+    int   first_tile         = floor((float)left / (float)ZOOMED_WAVEFORM_TILE_WIDTH);
+    int   last_tile          = floor((float)(left + width) / (float)ZOOMED_WAVEFORM_TILE_WIDTH);
+
+    QPainter painter;
+    painter.begin(this);
+
+    {
+        QMutexLocker lock(&this->tiles_mutex);
+
+        // Tiles are rendered for a specific height.
+        if (height != this->tiles_height)
+        {
+            this->generation.fetchAndAddOrdered(1);
+            this->tiles.clear();
+            this->pending_tiles.clear();
+            this->tiles_height = height;
+        }
+
+        // Blit available tiles, ask for missing ones (and for the next one to be ready when playing).
+        for (int t = first_tile; t <= last_tile + 1; t++)
+        {
+            if (this->tiles.contains(t) == true)
+            {
+                if (t <= last_tile)
+                {
+                    painter.drawImage(t * ZOOMED_WAVEFORM_TILE_WIDTH - left, 0, this->tiles.value(t));
+                }
+            }
+            else
+            {
+                this->request_tile(t);
+            }
+        }
+    }
+
+    // Draw playhead.
+    painter.setPen(QColor("orange"));
+    painter.drawLine(width / 2, 0, width / 2, height);
+    painter.drawLine(width / 2 + 1, 0, width / 2 + 1, height);
+
+    // Draw border.
+    painter.setPen(QColor(0, 102, 0)); // kind of green
+    painter.drawRect(0, 0, width, height);
+
+    painter.end();
+
+    return;
+}
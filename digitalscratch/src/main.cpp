@@ -51,6 +51,7 @@
 #include "player/control_and_playback_process.h"
 #include "audiodev/audio_io_control_rules.h"
 #include "audiodev/jack_client_control_rules.h"
+#include "audiodev/sound_card_control_rules.h"
 #include "control/timecode_control_process.h"
 #include "control/dicer_control_process.h"
 #include "singleton.h"
@@ -162,7 +163,15 @@ int main(int argc, char *argv[])
     }
 
     // Access sound card.
-    QSharedPointer<Audio_IO_control_rules> sound_card(new Jack_client_control_rules(settings->get_nb_decks() * 2));
+    QSharedPointer<Audio_IO_control_rules> sound_card;
+    if (settings->get_sound_driver() == SOUND_DRIVER_INTERNAL)
+    {
+        sound_card = QSharedPointer<Audio_IO_control_rules>(new Sound_card_control_rules(settings->get_nb_decks() * 2));
+    }
+    else
+    {
+        sound_card = QSharedPointer<Audio_IO_control_rules>(new Jack_client_control_rules(settings->get_nb_decks() * 2));
+    }
     sound_card->set_capture(true);
 
     // Sound capture and playback process.
@@ -0,0 +1,248 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*--------------------------------------------------( callback_profiler.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*          Timing histograms of the sound card callback (lock-free)          */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <QtAlgorithms>
+#include <cmath>
+
+#include "player/callback_profiler.h"
+
+Timing_histogram::Timing_histogram()
+{
+    this->reset();
+}
+
+int
+Timing_histogram::get_bucket(const quint64 &ns)
+{
+    if (ns < 4)
+    {
+        return static_cast<int>(ns);
+    }
+
+    // Power of 2 of the value, then its 2 next bits.
+    int exponent = 63 - static_cast<int>(qCountLeadingZeroBits(ns));
+    int bucket   = 4 * (exponent - 1) + static_cast<int>((ns >> (exponent - 2)) & 3);
+
+    return qMin(bucket, PROFILER_NB_BUCKETS - 1);
+}
+
+quint64
+Timing_histogram::get_bucket_upper_bound(const int &bucket)
+{
+    if (bucket < 4)
+    {
+        return static_cast<quint64>(bucket + 1);
+    }
+
+    int exponent = bucket / 4 + 1;
+    int sub      = bucket % 4;
+
+    return static_cast<quint64>(5 + sub) << (exponent - 2);
+}
+
+void
+Timing_histogram::add(const quint64 &ns)
+{
+    // Only one writer: no need of atomic read-modify-write, values just have to be readable from another thread.
+    QAtomicInteger<quint32> &bucket = this->buckets[get_bucket(ns)];
+    bucket.store(bucket.load() + 1);
+    if (ns > this->max_ns.load())
+    {
+        this->max_ns.store(ns);
+    }
+}
+
+void
+Timing_histogram::reset()
+{
+    for (int i = 0; i < PROFILER_NB_BUCKETS; i++)
+    {
+        this->buckets[i].store(0);
+    }
+    this->max_ns.store(0);
+}
+
+Timing_stats
+Timing_histogram::get_stats() const
+{
+    // Copy buckets, the writer may go on meanwhile.
+    quint32 counts[PROFILER_NB_BUCKETS];
+    Timing_stats stats;
+    stats.count = 0;
+    for (int i = 0; i < PROFILER_NB_BUCKETS; i++)
+    {
+        counts[i]    = this->buckets[i].load();
+        stats.count += counts[i];
+    }
+    stats.max_ns = this->max_ns.load();
+    stats.p50_ns = 0;
+    stats.p99_ns = 0;
+
+    // Percentiles: first bucket reaching the rank.
+    quint64 p50_rank   = static_cast<quint64>(ceil(stats.count * 0.50));
+    quint64 p99_rank   = static_cast<quint64>(ceil(stats.count * 0.99));
+    quint64 cumulative = 0;
+    for (int i = 0; (i < PROFILER_NB_BUCKETS) && (cumulative < p99_rank); i++)
+    {
+        cumulative += counts[i];
+        if ((stats.p50_ns == 0) && (cumulative >= p50_rank))
+        {
+            stats.p50_ns = get_bucket_upper_bound(i);
+        }
+        if (cumulative >= p99_rank)
+        {
+            stats.p99_ns = get_bucket_upper_bound(i);
+        }
+    }
+
+    // Percentiles can not be more than the max value.
+    stats.p50_ns = qMin(stats.p50_ns, stats.max_ns);
+    stats.p99_ns = qMin(stats.p99_ns, stats.max_ns);
+
+    return stats;
+}
+
+Callback_profiler::Callback_profiler()
+{
+    this->nb_frames       = 0;
+    this->reset_requested = 0;
+    this->timer.start();
+}
+
+void
+Callback_profiler::start_period()
+{
+    if (this->reset_requested.loadAcquire() != 0)
+    {
+        this->periods.reset();
+        for (int deck = 0; deck < PROFILER_MAX_DECKS; deck++)
+        {
+            for (int stage = 0; stage < static_cast<int>(Profiler_stage::NB_STAGES); stage++)
+            {
+                this->stages[deck][stage].reset();
+            }
+        }
+        this->reset_requested.storeRelease(0);
+    }
+    this->timer.restart();
+}
+
+quint64
+Callback_profiler::get_time_ns() const
+{
+    return static_cast<quint64>(this->timer.nsecsElapsed());
+}
+
+void
+Callback_profiler::add_timing(const unsigned short int &deck_index, const Profiler_stage &stage, const quint64 &ns)
+{
+    if (deck_index < PROFILER_MAX_DECKS)
+    {
+        this->stages[deck_index][static_cast<int>(stage)].add(ns);
+    }
+}
+
+void
+Callback_profiler::end_period(const unsigned short int &nb_frames)
+{
+    this->periods.add(this->get_time_ns());
+    this->nb_frames.store(nb_frames);
+}
+
+void
+Callback_profiler::reset()
+{
+    // Done by the real-time thread at the next period (only one writer).
+    this->reset_requested.storeRelease(1);
+}
+
+Timing_stats
+Callback_profiler::get_period_stats() const
+{
+    return this->periods.get_stats();
+}
+
+Timing_stats
+Callback_profiler::get_stage_stats(const unsigned short int &deck_index, const Profiler_stage &stage) const
+{
+    return this->stages[qMin(static_cast<int>(deck_index), PROFILER_MAX_DECKS - 1)][static_cast<int>(stage)].get_stats();
+}
+
+static QString format_stats(const QString &name, const Timing_stats &stats)
+{
+    return QString("%1: n=%2 p50=%3us p99=%4us max=%5us").arg(name)
+                                                         .arg(stats.count)
+                                                         .arg(stats.p50_ns / 1000.0, 0, 'f', 1)
+                                                         .arg(stats.p99_ns / 1000.0, 0, 'f', 1)
+                                                         .arg(stats.max_ns / 1000.0, 0, 'f', 1);
+}
+
+QString
+Callback_profiler::get_report(const unsigned short int &nb_decks,
+                              const unsigned int       &sample_rate,
+                              const int                &nb_xruns,
+                              const float              &dsp_load) const
+{
+    // Whole period, compared to the time available to process it.
+    Timing_stats period = this->get_period_stats();
+    QString report = format_stats("period", period);
+    int nb_frames = this->nb_frames.load();
+    if ((nb_frames > 0) && (sample_rate > 0))
+    {
+        double budget_ns = nb_frames * 1e9 / sample_rate;
+        report += QString(" (budget %1us for %2 frames, p99 %3% max %4%)").arg(budget_ns / 1000.0, 0, 'f', 1)
+                                                                          .arg(nb_frames)
+                                                                          .arg(100.0 * period.p99_ns / budget_ns, 0, 'f', 1)
+                                                                          .arg(100.0 * period.max_ns / budget_ns, 0, 'f', 1);
+    }
+
+    // Stages of each deck.
+    const char *stage_names[] = { "control", "playback", "samplers" };
+    for (unsigned short int deck = 0; (deck < nb_decks) && (deck < PROFILER_MAX_DECKS); deck++)
+    {
+        for (int stage = 0; stage < static_cast<int>(Profiler_stage::NB_STAGES); stage++)
+        {
+            report += "\n" + format_stats(QString("deck %1 %2").arg(deck + 1).arg(stage_names[stage]),
+                                          this->get_stage_stats(deck, static_cast<Profiler_stage>(stage)));
+        }
+    }
+
+    // Data of the sound card.
+    report += QString("\nxruns: %1").arg(nb_xruns);
+    if (dsp_load >= 0.0f)
+    {
+        report += QString(", DSP load: %1%").arg(dsp_load, 0, 'f', 1);
+    }
+
+    return report;
+}
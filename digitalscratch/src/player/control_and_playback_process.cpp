@@ -35,6 +35,8 @@
 
 #include "player/control_and_playback_process.h"
 #include "app/application_logging.h"
+#include "app/application_settings.h"
+#include "singleton.h"
 
 
 Control_and_playback_process::Control_and_playback_process(const QList<QSharedPointer<Timecode_control_process>>     &tcode_controls,
@@ -43,6 +45,8 @@ Control_and_playback_process::Control_and_playback_process(const QList<QSharedPo
                                                            const QSharedPointer<Audio_IO_control_rules>              &sound_card,
                                                            const unsigned short int                                  &nb_decks)
 {
+    this->report_timer = nullptr;
+
     if (tcode_controls.count()  == 0 ||
         playbacks.count()       == 0 ||
         manual_controls.count() == 0 ||
@@ -75,19 +79,91 @@ Control_and_playback_process::~Control_and_playback_process()
 void
 Control_and_playback_process::init()
 {
+    // Dump timings of the sound card callback from time to time (enabled with "ds.profiler.info=true" logging rule).
+    if (DS_PROFILER().isInfoEnabled() == true)
+    {
+        this->report_timer = new QTimer(this);
+        QObject::connect(this->report_timer, &QTimer::timeout, this, &Control_and_playback_process::log_profiling_report);
+        this->report_timer->start(PROFILER_REPORT_PERIOD_MS);
+    }
+
     return;
 }
 
+Callback_profiler *
+Control_and_playback_process::get_profiler()
+{
+    return &this->profiler;
+}
+
+QString
+Control_and_playback_process::get_profiling_report()
+{
+    return this->profiler.get_report(this->nb_decks,
+                                     Singleton<Application_settings>::get_instance().get_sample_rate(),
+                                     this->sound_card->get_nb_xruns(),
+                                     this->sound_card->get_dsp_load());
+}
+
+void
+Control_and_playback_process::log_profiling_report()
+{
+    foreach (const QString &line, this->get_profiling_report().split('\n'))
+    {
+        qCInfo(DS_PROFILER) << qPrintable(line);
+    }
+}
+
 bool
 Control_and_playback_process::start()
 {
-    return this->sound_card->start(this);
+    // From now, deck commands are only applied by the real-time thread.
+    this->set_decks_realtime_running(true);
+
+    // Deck changes requested while the sound card was stopped.
+    this->apply_deck_commands();
+
+    if (this->sound_card->start(this) == false)
+    {
+        this->set_decks_realtime_running(false);
+        return false;
+    }
+
+    return true;
 }
 
 bool
 Control_and_playback_process::stop()
 {
-    return this->sound_card->stop();
+    bool result = this->sound_card->stop();
+
+    // Deck changes requested after the last period, next ones are applied by the threads requesting them.
+    this->set_decks_realtime_running(this->sound_card->is_running());
+    this->apply_deck_commands();
+
+    return result;
+}
+
+void
+Control_and_playback_process::apply_deck_commands()
+{
+    // Only when the real-time thread is not running (it is the only one applying deck commands).
+    if (this->sound_card->is_running() == false)
+    {
+        for (unsigned short int i = 0; i < this->nb_decks; i++)
+        {
+            this->playbacks[i]->apply_commands();
+        }
+    }
+}
+
+void
+Control_and_playback_process::set_decks_realtime_running(const bool &running)
+{
+    for (unsigned short int i = 0; i < this->nb_decks; i++)
+    {
+        this->playbacks[i]->set_realtime_running(running);
+    }
 }
 
 bool
@@ -100,6 +176,7 @@ void
 Control_and_playback_process::kill()
 {
     this->sound_card->stop();
+    this->set_decks_realtime_running(false);
     emit terminated();
 }
 
@@ -109,6 +186,7 @@ Control_and_playback_process::run(const unsigned short int &nb_buffer_frames) //
 {
     QList<float *> input_buffers;
     QList<float *> output_buffers;
+    this->profiler.start_period();
 
     // Get sound card buffers.
     if(this->sound_card->get_input_buffers(nb_buffer_frames, input_buffers) == false)
@@ -129,6 +207,7 @@ Control_and_playback_process::run(const unsigned short int &nb_buffer_frames) //
             case ProcessMode::TIMECODE:
             {
                 // Analyze captured data with libdigitalscratch.
+                quint64 start_ns = this->profiler.get_time_ns();
                 if (this->tcode_controls[i]->run(nb_buffer_frames,
                                                  input_buffers[i*2],
                                                  input_buffers[i*2 + 1]) == false)
@@ -136,13 +215,11 @@ Control_and_playback_process::run(const unsigned short int &nb_buffer_frames) //
                     qCWarning(DS_PLAYBACK) << "timecode analysis failed for deck " << i + 1;
                     return false;
                 }
+                this->profiler.add_timing(i, Profiler_stage::CONTROL, this->profiler.get_time_ns() - start_ns);
 
                 // Play data.
-                if (this->playbacks[i]->run(output_buffers[i*2],
-                                            output_buffers[i*2 + 1],
-                                            nb_buffer_frames) == false)
+                if (this->play(i, output_buffers, nb_buffer_frames) == false)
                 {
-                    qCWarning(DS_PLAYBACK) << "playback process failed for deck " << i + 1;
                     return false;
                 }
 
@@ -158,24 +235,53 @@ Control_and_playback_process::run(const unsigned short int &nb_buffer_frames) //
             case ProcessMode::MANUAL:
             {
                 // Get playback parameters (mainly speed) from gui buttons.
+                quint64 start_ns = this->profiler.get_time_ns();
                 if (this->manual_controls[i]->run() == false)
                 {
                     qCWarning(DS_PLAYBACK) << "manual playback control failed for deck " << i + 1;
                     return false;
                 }
+                this->profiler.add_timing(i, Profiler_stage::CONTROL, this->profiler.get_time_ns() - start_ns);
 
                 // Play data.
-                if (this->playbacks[i]->run(output_buffers[i*2],
-                                            output_buffers[i*2 + 1],
-                                            nb_buffer_frames) == false)
+                if (this->play(i, output_buffers, nb_buffer_frames) == false)
                 {
-                    qCWarning(DS_PLAYBACK) << "playback process failed for deck " << i + 1;
                     return false;
                 }
                 break;
             }
         }
     }
+    this->profiler.end_period(nb_buffer_frames);
+
+    return true;
+}
+
+bool
+Control_and_playback_process::play(const unsigned short int &deck_index,
+                                   QList<float*>            &output_buffers,
+                                   const unsigned short int &nb_buffer_frames)
+{
+    // Play main track, then samplers (timed separately).
+    quint64 start_ns = this->profiler.get_time_ns();
+    if (this->playbacks[deck_index]->run_track(output_buffers[deck_index*2],
+                                               output_buffers[deck_index*2 + 1],
+                                               nb_buffer_frames) == false)
+    {
+        qCWarning(DS_PLAYBACK) << "playback process failed for deck " << deck_index + 1;
+        return false;
+    }
+    quint64 track_ns = this->profiler.get_time_ns();
+    this->profiler.add_timing(deck_index, Profiler_stage::PLAYBACK, track_ns - start_ns);
+
+    if (this->playbacks[deck_index]->run_samplers(output_buffers[deck_index*2],
+                                                  output_buffers[deck_index*2 + 1],
+                                                  nb_buffer_frames) == false)
+    {
+        qCWarning(DS_PLAYBACK) << "sampler playback failed for deck " << deck_index + 1;
+        return false;
+    }
+    this->profiler.add_timing(deck_index, Profiler_stage::SAMPLERS, this->profiler.get_time_ns() - track_ns);
 
     return true;
 }
@@ -0,0 +1,101 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*-------------------------------------------------( deck_command_queue.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*      Lock-free queue of deck commands (GUI/MIDI -> sound card thread)      */
+/*                                                                            */
+/*============================================================================*/
+
+
+
+#include "player/deck_command_queue.h"
+
+Deck_command_queue::Deck_command_queue()
+{
+    for (quint32 i = 0; i < DECK_COMMAND_QUEUE_SIZE; i++)
+    {
+        this->cells[i].sequence.store(i);
+    }
+    this->push_position.store(0);
+    this->pop_position = 0;
+}
+
+bool
+Deck_command_queue::push(const Deck_command &command)
+{
+    // Reserve a cell, several writers may compete for it.
+    Cell   *cell     = nullptr;
+    quint32 position = this->push_position.load();
+    for (;;)
+    {
+        cell = &this->cells[position & (DECK_COMMAND_QUEUE_SIZE - 1)];
+        qint32 diff = static_cast<qint32>(cell->sequence.loadAcquire() - position);
+        if (diff == 0)
+        {
+            // Cell is free, take it if no other writer did it meanwhile.
+            if (this->push_position.testAndSetRelaxed(position, position + 1) == true)
+            {
+                break;
+            }
+            position = this->push_position.load();
+        }
+        else if (diff < 0)
+        {
+            // Cell is not read yet: queue is full.
+            return false;
+        }
+        else
+        {
+            // Another writer took the cell.
+            position = this->push_position.load();
+        }
+    }
+
+    // Write command, then make it visible to the reader.
+    cell->command = command;
+    cell->sequence.storeRelease(position + 1);
+
+    return true;
+}
+
+bool
+Deck_command_queue::pop(Deck_command &out_command)
+{
+    Cell *cell = &this->cells[this->pop_position & (DECK_COMMAND_QUEUE_SIZE - 1)];
+    if (static_cast<qint32>(cell->sequence.loadAcquire() - (this->pop_position + 1)) < 0)
+    {
+        // Nothing written yet in this cell: queue is empty.
+        return false;
+    }
+
+    // Read command, then give the cell back to writers for the next round.
+    out_command = cell->command;
+    cell->sequence.storeRelease(this->pop_position + DECK_COMMAND_QUEUE_SIZE);
+    this->pop_position++;
+
+    return true;
+}
@@ -32,6 +32,8 @@
 /*============================================================================*/
 
 #include <QtDebug>
+#include <QThread>
+#include <QElapsedTimer>
 #include <cmath>
 #include <iostream>
 #include <algorithm>
@@ -58,6 +60,7 @@ Deck_playback_process::Deck_playback_process(const QSharedPointer<Audio_track>
     for (unsigned short int i = 0; i < MAX_NB_CUE_POINTS; i++) this->cue_points << 0;
     this->current_sample             = 0;
     this->stopped                    = true;
+    this->paused                     = false;
     this->remaining_time             = 0;
     this->src_state                  = nullptr;
     this->src_data                   = nullptr;
@@ -66,6 +69,9 @@ Deck_playback_process::Deck_playback_process(const QSharedPointer<Audio_track>
     for (unsigned short int i = 0; i < this->nb_samplers; i++) this->sampler_current_states  << false;
     this->need_update_remaining_time = 0;
     this->need_update_samplers_remaining_time = 0;
+    this->next_sync_ticket    = 0;
+    this->applied_sync_ticket = 0;
+    this->realtime_running    = 0;
 
     // Init libsamplerate.
     int error;
@@ -95,63 +101,181 @@ Deck_playback_process::~Deck_playback_process()
 }
 
 bool
-Deck_playback_process::reset()
+Deck_playback_process::push_command(const Deck_command_type &type, const unsigned int &value, const bool &state)
 {
-    this->current_sample = 0;
-    this->remaining_time = 0;
-    this->stopped        = false;
-    this->paused         = false;
-    for (int i = 0; i < MAX_NB_CUE_POINTS; i++)
+    Deck_command command;
+    command.type  = type;
+    command.value = value;
+    command.state = state;
+
+    if (this->commands.push(command) == false)
     {
-        this->read_cue_point(i);
+        qCWarning(DS_PLAYBACK) << "deck command queue is full, command dropped";
+        return false;
     }
 
-    // Reset libsamplerate.
-    if (this->src_state != nullptr)
+    return true;
+}
+
+void
+Deck_playback_process::apply_commands()
+{
+    // Real-time thread only: apply changes requested by other threads since last period.
+    Deck_command command;
+    while (this->commands.pop(command) == true)
+    {
+        switch (command.type)
+        {
+            case Deck_command_type::STOP:
+                this->stopped = true;
+                break;
+
+            case Deck_command_type::PLAY:
+                this->paused = false;
+                break;
+
+            case Deck_command_type::PAUSE:
+                this->paused = true;
+                break;
+
+            case Deck_command_type::RESET:
+                this->current_sample = 0;
+                this->remaining_time = 0;
+                this->stopped        = false;
+                this->paused         = false;
+                if (this->src_state != nullptr)
+                {
+                    src_reset(this->src_state);
+                }
+                break;
+
+            case Deck_command_type::JUMP:
+                this->current_sample = command.value;
+                break;
+
+            case Deck_command_type::SAMPLER_STATE:
+                this->change_sampler_state(command.value, command.state);
+                break;
+
+            case Deck_command_type::SAMPLER_RESET:
+                this->sampler_current_samples[command.value] = 0;
+                this->sampler_remaining_times[command.value] = 0;
+                break;
+
+            case Deck_command_type::SYNC:
+                // Tickets can be pushed out of order by different threads, keep the last one.
+                if ((int)(command.value - this->applied_sync_ticket.load()) > 0)
+                {
+                    this->applied_sync_ticket.storeRelease(command.value);
+                }
+                break;
+        }
+    }
+}
+
+void
+Deck_playback_process::set_realtime_running(const bool &running)
+{
+    // Wait for a thread applying commands inline, it must not run at the same time as the real-time one.
+    QMutexLocker locker(&this->inline_commands_lock);
+    this->realtime_running = running ? 1 : 0;
+}
+
+bool
+Deck_playback_process::wait_for_commands()
+{
+    // No real-time thread (sound card stopped): nobody else reads the queue, apply commands here.
+    {
+        QMutexLocker locker(&this->inline_commands_lock);
+        if (this->realtime_running.load() == 0)
+        {
+            this->apply_commands();
+            return true;
+        }
+    }
+
+    // Commands pushed before the ticket are applied when the real-time thread reaches it.
+    int ticket = this->next_sync_ticket.fetchAndAddOrdered(1) + 1;
+    if (this->push_command(Deck_command_type::SYNC, ticket) == false)
     {
-        src_reset(this->src_state);
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    while ((this->applied_sync_ticket.loadAcquire() - ticket) < 0)
+    {
+        if (timer.elapsed() > DECK_COMMAND_SYNC_TIMEOUT_MS)
+        {
+            qCWarning(DS_PLAYBACK) << "deck commands not applied by the real-time thread";
+            return false;
+        }
+        QThread::usleep(100);
     }
 
     return true;
 }
 
-void
+bool
+Deck_playback_process::reset()
+{
+    // Cue points are read from DB here, not in the real-time thread.
+    for (int i = 0; i < MAX_NB_CUE_POINTS; i++)
+    {
+        this->read_cue_point(i);
+    }
+
+    // Reset position, state and libsamplerate.
+    return this->push_command(Deck_command_type::RESET);
+}
+
+bool
 Deck_playback_process::stop()
 {
-    this->stopped = true;
+    return this->push_command(Deck_command_type::STOP);
 }
 
-void
+bool
 Deck_playback_process::pause()
 {
-    this->paused = true;
+    return this->push_command(Deck_command_type::PAUSE);
 }
 
-void
+bool
 Deck_playback_process::play()
 {
-    this->paused = false;
+    return this->push_command(Deck_command_type::PLAY);
 }
 
 
 bool
 Deck_playback_process::reset_sampler(const unsigned short int &sampler_index)
 {
-    this->sampler_current_samples[sampler_index] = 0;
-    this->sampler_remaining_times[sampler_index] = 0;
-
-    return true;
+    return this->push_command(Deck_command_type::SAMPLER_RESET, sampler_index);
 }
 
-void
+bool
 Deck_playback_process::del_sampler(const unsigned short int &sampler_index)
 {
-    this->reset_sampler(sampler_index);
-    this->set_sampler_state(sampler_index, false);
+    // Stop the sampler.
+    if ((this->reset_sampler(sampler_index) == false) ||
+        (this->set_sampler_state(sampler_index, false) == false))
+    {
+        return false;
+    }
+
+    // Its track can only be cleared when the real-time thread does not play it anymore.
+    if (this->is_sampler_loaded(sampler_index) == true)
+    {
+        if (this->wait_for_commands() == false)
+        {
+            return false;
+        }
+        this->at_samplers[sampler_index]->reset();
+    }
     emit sampler_remaining_time_changed(0, sampler_index);
-    this->at_samplers[sampler_index]->reset();
 
-    return;
+    return true;
 }
 
 bool
@@ -248,7 +372,7 @@ Deck_playback_process::play_samplers(QVector<float*> &io_playback_bufs, const un
                 else
                 {
                     // Stop playback of this sample.
-                    this->set_sampler_state(i, false);
+                    this->change_sampler_state(i, false);
                     emit sampler_state_changed(i, false);
                 }
             }
@@ -266,6 +390,12 @@ Deck_playback_process::get_sampler_state(const unsigned short int &sampler_index
 
 bool
 Deck_playback_process::set_sampler_state(const unsigned short int &sampler_index, const bool &state)
+{
+    return this->push_command(Deck_command_type::SAMPLER_STATE, sampler_index, state);
+}
+
+void
+Deck_playback_process::change_sampler_state(const unsigned short int &sampler_index, const bool &state)
 {
     this->sampler_current_states[sampler_index] = state;
 
@@ -274,8 +404,6 @@ Deck_playback_process::set_sampler_state(const unsigned short int &sampler_index
     {
         this->sampler_current_samples[sampler_index] = 0;
     }
-
-    return true;
 }
 
 bool
@@ -366,9 +494,22 @@ Deck_playback_process::update_samplers_remaining_time()
 
 bool
 Deck_playback_process::run(float io_playback_buf_1[], float io_playback_buf_2[], const unsigned short int &buf_size)
+{
+    // Play main track, then mix samplers with it.
+    this->run_track(io_playback_buf_1, io_playback_buf_2, buf_size);
+    this->run_samplers(io_playback_buf_1, io_playback_buf_2, buf_size);
+
+    return true;
+}
+
+bool
+Deck_playback_process::run_track(float io_playback_buf_1[], float io_playback_buf_2[], const unsigned short int &buf_size)
 {
     QVector<float*> playback_bufs = { io_playback_buf_1, io_playback_buf_2 };
 
+    // Apply changes requested since last period.
+    this->apply_commands();
+
     // Track is not loaded, play empty sound.
     if ((this->is_track_loaded() == false) || (this->stopped == true))
     {
@@ -388,6 +529,14 @@ Deck_playback_process::run(float io_playback_buf_1[], float io_playback_buf_2[],
         }
     }
 
+    return true;
+}
+
+bool
+Deck_playback_process::run_samplers(float io_playback_buf_1[], float io_playback_buf_2[], const unsigned short int &buf_size)
+{
+    QVector<float*> playback_bufs = { io_playback_buf_1, io_playback_buf_2 };
+
     // Play samplers.
     if (this->play_samplers(playback_bufs, buf_size) == false)
     {
@@ -572,9 +721,7 @@ Deck_playback_process::jump_to_position(const float &position)
     }
 
     // We jump.
-    this->current_sample = new_pos;
-
-    return true;
+    return this->push_command(Deck_command_type::JUMP, new_pos);
 }
 
 bool
@@ -629,9 +776,7 @@ bool
 Deck_playback_process::jump_to_cue_point(const unsigned short int &cue_point_number)
 {
     // Jump
-    this->current_sample = this->cue_points[cue_point_number];
-
-    return true;
+    return this->push_command(Deck_command_type::JUMP, this->cue_points[cue_point_number]);
 }
 
 bool
@@ -36,6 +36,7 @@
 #include <iostream>
 #include <QPixmap>
 #include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <QMimeData>
 #include <QCoreApplication>
 
@@ -45,24 +46,28 @@
 #include "tracks/audio_collection_model.h"
 #include "tracks/audio_track.h"
 #include "tracks/data_persistence.h"
+#include "tracks/audio_collection_scanner.h"
 #include "utils.h"
 #include "singleton.h"
 
-Audio_collection_item::Audio_collection_item(const QList<QVariant> &in_data,
-                                             QString                in_file_hash,
+Audio_collection_item::Audio_collection_item(QString                in_file_hash,
                                              QString                in_full_path,
                                              bool                   in_is_directory,
                                              Audio_collection_item *in_parent)
 {
     this->parentItem     = in_parent;
     this->fileHash       = in_file_hash;
-    this->itemData       = in_data;
     this->fullPath       = in_full_path;
     this->directoryFlag  = in_is_directory;
     this->next_key       = false;
     this->next_major_key = false;
+    this->first_beat     = 0;
+    this->bpm            = 0.0;
+    this->key_code       = -1;
 }
 
+QAtomicInt Audio_collection_item::key_changes;
+
 Audio_collection_item::~Audio_collection_item()
 {
     qDeleteAll(this->childItems);
@@ -83,21 +88,49 @@ int Audio_collection_item::get_child_count() const
     return this->childItems.count();
 }
 
-int Audio_collection_item::get_column_count() const
-{
-    return this->itemData.count();
-}
-
 QVariant Audio_collection_item::get_data(int in_column) const
 {
-    return this->itemData.value(in_column);
+    switch (in_column)
+    {
+        case COLUMN_FILE_NAME:
+            return this->fullPath.mid(this->fullPath.lastIndexOf('/') + 1);
+        case COLUMN_KEY:
+            return Utils::get_music_key_from_code(this->key_code);
+        case COLUMN_BPM:
+            return this->bpm;
+        case COLUMN_TAGS:
+            return this->tags;
+        case COLUMN_PATH:
+            return this->fullPath.left(qMax(this->fullPath.lastIndexOf('/'), 0));
+        default:
+            return QVariant();
+    }
 }
 
 void Audio_collection_item::set_data(int in_column, QVariant in_data)
 {
-    if (in_column < this->itemData.size())
+    switch (in_column)
     {
-        this->itemData.replace(in_column, in_data);
+        case COLUMN_KEY:
+        {
+            // Keep key code up to date (used by the index of keys).
+            int key_code = Utils::get_music_key_code(in_data.toString());
+            if (key_code != this->key_code)
+            {
+                this->key_code = key_code;
+                key_changes.fetchAndAddRelaxed(1);
+            }
+            break;
+        }
+        case COLUMN_BPM:
+            this->bpm = in_data.toFloat();
+            break;
+        case COLUMN_TAGS:
+            this->tags = in_data.toStringList();
+            break;
+        default:
+            // File name and path are parts of the full path.
+            break;
     }
 }
 
@@ -126,6 +159,16 @@ QString Audio_collection_item::get_file_hash() const
     return this->fileHash;
 }
 
+unsigned int Audio_collection_item::get_first_beat() const
+{
+    return this->first_beat;
+}
+
+int Audio_collection_item::get_key_code() const
+{
+    return this->key_code;
+}
+
 bool Audio_collection_item::is_directory()
 {
     return this->directoryFlag;
@@ -166,7 +209,9 @@ bool Audio_collection_item::read_from_db()
     {
         // File found in DB, put data back to item.
         this->set_data(COLUMN_KEY, at->get_music_key());
+        this->set_data(COLUMN_BPM, at->get_bpm());
         this->set_data(COLUMN_TAGS, at->get_tags());
+        this->first_beat = at->get_first_beat();
     }
     else
     {
@@ -177,23 +222,60 @@ bool Audio_collection_item::read_from_db()
     return true;
 }
 
+void Audio_collection_item::set_metadata(const Track_metadata &metadata)
+{
+    this->set_data(COLUMN_KEY, metadata.music_key);
+    this->set_data(COLUMN_BPM, metadata.bpm);
+    this->set_data(COLUMN_TAGS, metadata.tags);
+    this->first_beat = metadata.first_beat;
+}
+
 void Audio_collection_item::compute_audio_characteristics()
 {
     Application_settings *settings = &Singleton<Application_settings>::get_instance();
 
-    // Check in application settings if we should analyze only files with missing data.
+    // Check in application settings if we should analyze only files which were never analysed.
     if ((settings->get_audio_collection_full_refresh() == true) ||
-        ((settings->get_audio_collection_full_refresh() == false) && (this->get_data(COLUMN_KEY) == "")))
+        (this->needs_analysis() == true))
     {
-        // Calculate music key.
-        this->calculate_music_key();
+        // Calculate music key and tempo.
+        this->analyse_audio_file();
     }
 }
 
-void Audio_collection_item::calculate_music_key()
+bool Audio_collection_item::needs_analysis() const
+{
+    // Analysis always sets a tempo (or BPM_NOT_DETECTED), so tracks without detected tempo are not done again.
+    return (this->get_data(COLUMN_KEY).toString() == "") ||
+           (this->bpm == 0.0);
+}
+
+void Audio_collection_item::analyse_audio_file()
 {
     // Calculate data and put them back in current audio item.
-    this->set_data(COLUMN_KEY, Utils::get_file_music_key(this->fullPath));
+    QString      key        = "";
+    float        bpm        = 0.0;
+    unsigned int first_beat = 0;
+    Utils::analyse_audio_file(this->fullPath, key, bpm, first_beat);
+    if (bpm <= 0.0)
+    {
+        bpm = BPM_NOT_DETECTED;
+    }
+    this->set_data(COLUMN_KEY, key);
+    this->set_data(COLUMN_BPM, bpm);
+    this->first_beat = first_beat;
+
+    // Also summarize the waveform, so decks do not have to do it when they load the track.
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    QByteArray overview;
+    if ((this->fileHash != "") &&
+        ((settings->get_audio_collection_full_refresh() == true) ||
+         (data_persist->get_analysis(this->fileHash, ANALYSIS_WAVEFORM_OVERVIEW, overview) == false)) &&
+        (Utils::get_file_overview(this->fullPath, overview) == true))
+    {
+        data_persist->store_analysis(this->fileHash, ANALYSIS_WAVEFORM_OVERVIEW, overview);
+    }
 }
 
 void Audio_collection_item::set_tag_list(const QStringList &tags)
@@ -212,15 +294,37 @@ void Audio_collection_item::store_to_db()
     at->set_hash(this->get_file_hash());
     at->set_fullpath(this->get_full_path());
     at->set_music_key(this->get_data(COLUMN_KEY).toString());
+    at->set_bpm(this->get_data(COLUMN_BPM).toFloat());
+    at->set_first_beat(this->first_beat);
     if (data_persist->store_audio_track(at) == false)
     {
         qCWarning(DS_DB) << "can not store" << this->get_full_path() << "to DB";
     }
 }
 
+void Audio_collection_item::queue_to_db()
+{
+    Singleton<Data_persistence>::get_instance().queue_audio_track(this->get_metadata());
+}
+
+Track_metadata Audio_collection_item::get_metadata() const
+{
+    // Same data as the one stored by store_to_db().
+    Track_metadata track;
+    track.hash       = this->fileHash;
+    track.fullpath   = this->fullPath;
+    track.music_key  = this->get_data(COLUMN_KEY).toString();
+    track.bpm        = this->get_data(COLUMN_BPM).toFloat();
+    track.first_beat = this->first_beat;
+    track.tags       = this->get_data(COLUMN_TAGS).toStringList();
+
+    return track;
+}
+
 Audio_collection_model::Audio_collection_model(QObject *in_parent) : QAbstractItemModel(in_parent)
 {
-    this->rootItem = nullptr;
+    this->rootItem        = nullptr;
+    this->nb_fetched_rows = 0;
     this->create_header("", false);
     this->audio_item_list.clear();
     this->root_path = "";
@@ -229,6 +333,17 @@ Audio_collection_model::Audio_collection_model(QObject *in_parent) : QAbstractIt
     this->concurrent_future = QSharedPointer<QFuture<void>>(new QFuture<void>);
     this->concurrent_watcher_read  = QSharedPointer<QFutureWatcher<void>>(new QFutureWatcher<void>);
     this->concurrent_watcher_analyze = QSharedPointer<QFutureWatcher<void>>(new QFutureWatcher<void>);
+    this->concurrent_watcher_changes = QSharedPointer<QFutureWatcher<Directory_changes>>(new QFutureWatcher<Directory_changes>);
+
+    // Watch collection directories, scan changes once they settled.
+    this->watch_generation   = 0;
+    this->changes_generation = 0;
+    this->key_index_valid    = false;
+    this->key_index_changes  = 0;
+    this->directory_changes_timer.setSingleShot(true);
+    QObject::connect(&this->directory_watcher, &QFileSystemWatcher::directoryChanged, this, &Audio_collection_model::on_directory_changed);
+    QObject::connect(&this->directory_changes_timer, &QTimer::timeout, this, &Audio_collection_model::scan_changed_directories);
+    QObject::connect(this->concurrent_watcher_changes.data(), &QFutureWatcher<Directory_changes>::finished, this, &Audio_collection_model::apply_directory_changes);
 }
 
 Audio_collection_model::~Audio_collection_model()
@@ -249,6 +364,12 @@ Audio_collection_model::~Audio_collection_model()
         this->concurrent_watcher_read->cancel();
         this->concurrent_watcher_read->waitForFinished();
     }
+    if (this->concurrent_watcher_changes->isStarted() == true)
+    {
+        this->concurrent_watcher_changes->waitForFinished();
+    }
+    this->search_generation.fetchAndAddOrdered(1);
+    this->search_future.waitForFinished();
 }
 
 void Audio_collection_model::set_icons(QPixmap in_audio_file_icon,
@@ -261,11 +382,11 @@ void Audio_collection_model::set_icons(QPixmap in_audio_file_icon,
 void Audio_collection_model::create_header(QString in_path, bool in_show_path)
 {
     // Create root item which is the collection header.
-    QList<QVariant> rootData;
-    rootData << tr("Track") << tr("Key") << tr("Tags");
+    this->header_titles.clear();
+    this->header_titles << tr("Track") << tr("Key") << tr("BPM") << tr("Tags");
     if (in_show_path == true)
     {
-        rootData << tr("Path");
+        this->header_titles << tr("Path");
     }
 
     if (this->rootItem != nullptr)
@@ -273,7 +394,8 @@ void Audio_collection_model::create_header(QString in_path, bool in_show_path)
         delete this->rootItem;
     }
 
-    this->rootItem = new Audio_collection_item(rootData, "", in_path, false, nullptr);
+    this->rootItem        = new Audio_collection_item("", in_path, false, nullptr);
+    this->nb_fetched_rows = 0;
 }
 
 QModelIndex Audio_collection_model::set_root_path(QString in_root_path)
@@ -286,9 +408,22 @@ QModelIndex Audio_collection_model::set_root_path(QString in_root_path)
 
     // Reset internal list of audio files (item pointers).
     this->audio_item_list.clear();
-
-    // Fill the model.
-    this->setup_model_data(in_root_path, this->rootItem);
+    this->item_by_path.clear();
+    this->search_result_list.clear();
+    this->next_key_items.clear();
+    this->key_index_valid = false;
+
+    // Fill the model (directories are parsed in parallel, only new or modified files are hashed).
+    QList<File_index_entry>  files;
+    Audio_collection_scanner scanner;
+    scanner.scan_directory(in_root_path, files);
+    this->setup_model_data(files, this->rootItem);
+    this->nb_fetched_rows = qMin(FETCH_ROWS_BATCH_SIZE, this->rootItem->get_child_count());
+
+    // Watch changes in all directories of the collection (watcher lives in the model thread).
+    QStringList directories = scanner.get_sub_directories();
+    directories.prepend(QDir(in_root_path).absolutePath());
+    QMetaObject::invokeMethod(this, "watch_directories", Qt::QueuedConnection, Q_ARG(QStringList, directories));
 
     // Store root path.
     this->root_path = in_root_path;
@@ -314,9 +449,17 @@ QModelIndex Audio_collection_model::set_playlist(const Playlist &playlist)
 
     // Reset internal list of audio files (item pointers).
     this->audio_item_list.clear();
+    this->item_by_path.clear();
+    this->search_result_list.clear();
+    this->next_key_items.clear();
+    this->key_index_valid = false;
 
     // Fill the model.
-    this->setup_model_data_from_tracklist(playlist.get_tracklist(), this->rootItem);
+    QList<File_index_entry>  files;
+    Audio_collection_scanner scanner;
+    scanner.scan_files(playlist.get_tracklist(), files);
+    this->setup_model_data(files, this->rootItem);
+    this->nb_fetched_rows = qMin(FETCH_ROWS_BATCH_SIZE, this->rootItem->get_child_count());
 
     // Model has been updated.
     this->endResetModel();
@@ -338,13 +481,47 @@ QModelIndex Audio_collection_model::get_root_index()
 
 int Audio_collection_model::columnCount(const QModelIndex &in_parent) const
 {
-    if (in_parent.isValid() == true)
+    Q_UNUSED(in_parent);
+
+    return this->header_titles.size();
+}
+
+bool Audio_collection_model::canFetchMore(const QModelIndex &in_parent) const
+{
+    // Only files of the root item are shown progressively.
+    if ((in_parent.isValid() == true) || (this->rootItem == nullptr))
     {
-        return static_cast<Audio_collection_item*>(in_parent.internalPointer())->get_column_count();
+        return false;
     }
-    else
+
+    return this->nb_fetched_rows < this->rootItem->get_child_count();
+}
+
+void Audio_collection_model::fetchMore(const QModelIndex &in_parent)
+{
+    if (this->canFetchMore(in_parent) == true)
     {
-        return rootItem->get_column_count();
+        this->fetch_rows(qMin(this->nb_fetched_rows + FETCH_ROWS_BATCH_SIZE, this->rootItem->get_child_count()) - 1);
+    }
+}
+
+void Audio_collection_model::fetch_all_rows()
+{
+    if (this->rootItem != nullptr)
+    {
+        this->fetch_rows(this->rootItem->get_child_count() - 1);
+    }
+}
+
+void Audio_collection_model::fetch_rows(const int &in_last_row)
+{
+    if ((this->rootItem != nullptr) &&
+        (in_last_row >= this->nb_fetched_rows) &&
+        (in_last_row < this->rootItem->get_child_count()))
+    {
+        this->beginInsertRows(QModelIndex(), this->nb_fetched_rows, in_last_row);
+        this->nb_fetched_rows = in_last_row + 1;
+        this->endInsertRows();
     }
 }
 
@@ -391,7 +568,12 @@ QVariant Audio_collection_model::data(const QModelIndex &in_index, int in_role)
 
     Audio_collection_item *item = static_cast<Audio_collection_item*>(in_index.internalPointer());
 
-    if (in_role == Qt::DisplayRole)
+    if ((in_role == Qt::UserRole) && (in_index.column() == COLUMN_BPM))
+    {
+        // Raw tempo, used to sort tracks.
+        return item->get_data(in_index.column());
+    }
+    else if ((in_role == Qt::DisplayRole) || (in_role == Qt::UserRole))
     {
         if (in_index.column() == COLUMN_TAGS)
         {
@@ -407,6 +589,19 @@ QVariant Audio_collection_model::data(const QModelIndex &in_index, int in_role)
             }
             return tags_str;
         }
+        else if (in_index.column() == COLUMN_BPM)
+        {
+            // Show tempo only if it was computed.
+            float bpm = item->get_data(in_index.column()).toFloat();
+            if (bpm > 0.0)
+            {
+                return QString::number(bpm, 'f', 1);
+            }
+            else
+            {
+                return QString("");
+            }
+        }
         else
         {
             return item->get_data(in_index.column());
@@ -483,7 +678,7 @@ QVariant Audio_collection_model::headerData(int in_section, Qt::Orientation in_o
 {
     if (in_orientation == Qt::Horizontal && in_role == Qt::DisplayRole)
     {
-        return this->rootItem->get_data(in_section);
+        return this->header_titles.value(in_section);
     }
 
     return QVariant();
@@ -563,7 +758,8 @@ int Audio_collection_model::rowCount(const QModelIndex &in_parent) const
 
     if (in_parent.isValid() == false)
     {
-        parentItem = this->rootItem;
+        // Files not fetched yet are hidden to the view.
+        return this->nb_fetched_rows;
     }
     else
     {
@@ -573,98 +769,61 @@ int Audio_collection_model::rowCount(const QModelIndex &in_parent) const
     return parentItem->get_child_count();
 }
 
-void Audio_collection_model::setup_model_data(QString in_path, Audio_collection_item *in_item)
+void Audio_collection_model::setup_model_data(const QList<File_index_entry> &in_files, Audio_collection_item *in_item)
 {
-    // Create a Qdir based on input path.
-    QStringList filters;
-    for (int i = 0; i < Utils::audio_file_extensions.size(); i++)
+    // Iterate over files (already hashed by the scanner).
+    foreach (const File_index_entry &file, in_files)
     {
-        filters << (QString("*.") + Utils::audio_file_extensions.at(i));
+        // It is a file, add the item (displayed data is read later from DB or from analysis).
+        Audio_collection_item *file_item = new Audio_collection_item(file.hash,
+                                                                     file.path,
+                                                                     false,
+                                                                     in_item);
+        in_item->append_child(file_item);
+
+        // Add the item's reference to a list (useful for future parsing).
+        this->audio_item_list << file_item;
+        this->item_by_path.insert(file.path, file_item);
     }
-    QDir dir(in_path);
-    dir.setNameFilters(filters);
-    dir.setFilter(QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot);
-    dir.setSorting(QDir::DirsFirst);
+    this->key_index_valid = false;
+}
 
-    // Iterate in directory.
-    QFileInfoList file_info_list = dir.entryInfoList();
-    foreach (QFileInfo file_info, file_info_list)
+void Audio_collection_model::read_items_from_db(const QList<Audio_collection_item*> &in_items,
+                                                const int                           &in_generation)
+{
+    // Get data of items by chunks (a few queries each), stop between chunks if requested.
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    for (int first = 0; (first < in_items.size()) && (this->read_generation.load() == in_generation); first += READ_DB_CHUNK_SIZE)
     {
-        // Prepare data to show for the item.
-        QString displayed_path(file_info.fileName());
-        QList<QVariant> line;
-        line << displayed_path;
-        line << ""; // music key
-        line << ""; // tag list
-        line << file_info.absolutePath(); // absolute path
-
-        // Add a child item.
-        if (file_info.isDir() == false)
+        QList<Audio_collection_item*> chunk = in_items.mid(first, READ_DB_CHUNK_SIZE);
+        QStringList hashes;
+        foreach (Audio_collection_item *item, chunk)
         {
-            // It is a file, add the item.
-            Audio_collection_item *file_item = new Audio_collection_item(line,
-                                                                         Utils::get_file_hash(file_info.absoluteFilePath()),
-                                                                         file_info.absoluteFilePath(),
-                                                                         false,
-                                                                         in_item);
-            in_item->append_child(file_item);
-
-            // Add the item's reference to a list (useful for future parsing).
-            this->audio_item_list << file_item;
+            hashes << item->get_file_hash();
         }
-        else
+        QHash<QString, Track_metadata> tracks;
+        if (data_persist->get_audio_tracks(hashes, tracks) == false)
         {
-            // It is a directory, analyze file under it.
-            this->setup_model_data(file_info.absoluteFilePath(), in_item);
+            qCWarning(DS_DB) << "can not read collection from DB";
+            break;
         }
-    }
-}
 
-void Audio_collection_model::setup_model_data_from_tracklist(QStringList in_tracklist, Audio_collection_item *in_item)
-{
-    // Iterate over tracklist.
-    for (int i = 0; i < in_tracklist.size(); i++)
-    {
-        QFileInfo file_info(in_tracklist.at(i));
-        if (file_info.exists() == true)
+        // Put data back to items.
+        foreach (Audio_collection_item *item, chunk)
         {
-            // Prepare data to show for the item.
-            QString displayed_path(file_info.fileName());
-            QList<QVariant> line;
-            line << displayed_path;
-            line << ""; // music key
-            line << ""; // tag list
-            line << file_info.absolutePath(); // absolute path
-
-            // Add a child item.
-            if (file_info.isDir() == false)
+            QHash<QString, Track_metadata>::const_iterator track = tracks.constFind(item->get_file_hash());
+            if (track != tracks.constEnd())
             {
-                if (Utils::audio_file_extensions.contains(file_info.suffix(), Qt::CaseInsensitive) == true)
-                {
-                    // It is a file (mp3 or flac), add the item.
-                    Audio_collection_item *file_item = new Audio_collection_item(line,
-                                                                                 Utils::get_file_hash(file_info.absoluteFilePath()),
-                                                                                 file_info.absoluteFilePath(),
-                                                                                 false,
-                                                                                 in_item);
-                    in_item->append_child(file_item);
-
-                    // Add the item's reference to a list (useful for future parsing).
-                    this->audio_item_list << file_item;
-                }
+                item->set_metadata(*track);
+            }
+            else
+            {
+                // Not found: store the audio track to DB.
+                item->queue_to_db();
             }
         }
     }
-}
-
-void external_read_from_db(Audio_collection_item *&in_audio_item)
-{
-    // Only a wrapper to get data from DB for an audio item object.
-    if (in_audio_item->read_from_db() == false)
-    {
-        // Not found: store the audio track to DB.
-        in_audio_item->store_to_db();
-    }
+    data_persist->flush_audio_tracks();
 }
 
 void Audio_collection_model::concurrent_read_collection_from_db()
@@ -674,16 +833,18 @@ void Audio_collection_model::concurrent_read_collection_from_db()
     if (data_persist->is_initialized == true)
     {
         // Read audio item from database for the whole collection.
-        QFuture<void> future = QtConcurrent::map(this->audio_item_list, &external_read_from_db);
+        QFuture<void> future = QtConcurrent::run(this, &Audio_collection_model::read_items_from_db,
+                                                 this->audio_item_list, this->read_generation.load());
         this->concurrent_watcher_read->setFuture(future);
     }
 }
 
 void Audio_collection_model::stop_concurrent_read_collection_from_db()
 {
+    // QtConcurrent::run() can not be canceled, the reader stops at the end of its current chunk.
+    this->read_generation.fetchAndAddOrdered(1);
     if (this->concurrent_watcher_read->isRunning() == true)
     {
-        this->concurrent_watcher_read->cancel();
         this->concurrent_watcher_read->waitForFinished();
     }
 }
@@ -713,10 +874,12 @@ void Audio_collection_model::concurrent_analyse_audio_collection()
 
 void Audio_collection_model::write_collection_to_db()
 {
+    // Write items by batches (one transaction per batch).
     foreach (Audio_collection_item *item, this->audio_item_list)
     {
-        item->store_to_db();
+        item->queue_to_db();
     }
+    Singleton<Data_persistence>::get_instance().flush_audio_tracks();
 }
 
 void Audio_collection_model::concurrent_analyse_audio_selection(QList<Audio_collection_item *> &items)
@@ -755,7 +918,7 @@ int Audio_collection_model::get_nb_new_items()
     int nb_items = 0;
     foreach (Audio_collection_item *item, this->audio_item_list)
     {
-        if (item->get_data(COLUMN_KEY) == "")
+        if (item->needs_analysis() == true)
         {
             // This file does not have been analyzed, let's consider it as a new one.
             nb_items++;
@@ -766,44 +929,223 @@ int Audio_collection_model::get_nb_new_items()
 }
 
 void
-Audio_collection_model::set_next_keys(QString in_next_key,
-                                      QString in_previous_key,
-                                      QString in_next_major_key)
+Audio_collection_model::update_key_index()
 {
-    // Iterate over all items and set flags to true if they are of next/previous/major keys.
-    foreach (Audio_collection_item *item, this->audio_item_list)
+    // Read the number of key changes first: a change during the update will be seen next time.
+    int key_changes = Audio_collection_item::key_changes.load();
+    if ((this->key_index_valid == false) ||
+        (this->key_index_changes != key_changes))
+    {
+        for (int key = 0; key < NB_MUSIC_KEYS; key++)
+        {
+            this->items_by_key[key].clear();
+        }
+        foreach (Audio_collection_item *item, this->audio_item_list)
+        {
+            if (item->get_key_code() >= 0)
+            {
+                this->items_by_key[item->get_key_code()] << item;
+            }
+        }
+        this->key_index_valid   = true;
+        this->key_index_changes = key_changes;
+    }
+}
+
+void
+Audio_collection_model::set_next_keys(const int &in_key_code)
+{
+    // Reset items flagged previously.
+    foreach (Audio_collection_item *item, this->next_key_items)
     {
-        // Reset.
         item->set_next_key(false);
         item->set_next_major_key(false);
+    }
+    this->next_key_items.clear();
+
+    // Get compatible keys.
+    quint32 next_keys       = 0;
+    quint32 next_major_keys = 0;
+    Utils::get_next_music_key_masks(in_key_code, next_keys, next_major_keys);
+    if ((next_keys | next_major_keys) == 0)
+    {
+        return;
+    }
 
-        if ((item->get_data(COLUMN_KEY) == in_next_key) ||
-            (item->get_data(COLUMN_KEY) == in_previous_key))
+    // Set flags only on items of compatible keys.
+    this->update_key_index();
+    for (int key = 0; key < NB_MUSIC_KEYS; key++)
+    {
+        if ((next_keys & (1u << key)) != 0)
         {
             // The item is a next or previous key.
-            item->set_next_key(true);
+            foreach (Audio_collection_item *item, this->items_by_key[key])
+            {
+                item->set_next_key(true);
+            }
+            this->next_key_items << this->items_by_key[key];
         }
-        else if (item->get_data(COLUMN_KEY) == in_next_major_key)
+        else if ((next_major_keys & (1u << key)) != 0)
         {
             // The item is a next major or minor key.
-            item->set_next_major_key(true);
+            foreach (Audio_collection_item *item, this->items_by_key[key])
+            {
+                item->set_next_major_key(true);
+            }
+            this->next_key_items << this->items_by_key[key];
         }
     }
 
     return;
 }
 
-QModelIndexList
-Audio_collection_model::search(QString in_text)
+Search_query
+Audio_collection_model::get_search_query(const QString &in_text)
 {
-    // Get elements that matches with in_text.
-    QModelIndexList items = this->match(this->index(0, 0),
-                                        Qt::DisplayRole,
-                                        QVariant::fromValue(in_text),
-                                        -1,
-                                        Qt::MatchFlags(Qt::MatchStartsWith | Qt::MatchWrap));
+    // Words are text terms, except facets: "key:8A", "bpm:124" or "bpm:120-128" and "tag:name".
+    Search_query query;
+    foreach (const QString &word, in_text.split(' ', QString::SkipEmptyParts))
+    {
+        QString value = word.section(':', 1);
+        if ((word.startsWith("key:", Qt::CaseInsensitive) == true) && (value.isEmpty() == false))
+        {
+            // Keys are stored as 2 digits clock numbers.
+            query.key = value.toUpper().rightJustified(3, '0');
+        }
+        else if ((word.startsWith("bpm:", Qt::CaseInsensitive) == true) && (value.isEmpty() == false))
+        {
+            query.bpm_min = value.section('-', 0, 0).toFloat();
+            query.bpm_max = value.contains('-') == true ? value.section('-', 1).toFloat() : query.bpm_min;
+            query.bpm_min -= 0.5;
+            query.bpm_max += 0.5;
+        }
+        else if ((word.startsWith("tag:", Qt::CaseInsensitive) == true) && (value.isEmpty() == false))
+        {
+            query.tag = value;
+        }
+        else
+        {
+            query.terms << word;
+        }
+    }
 
-    return items;
+    return query;
+}
+
+void
+Audio_collection_model::search(const QString &in_text)
+{
+    // Stop the previous search and forget its results.
+    int generation = this->search_generation.fetchAndAddOrdered(1) + 1;
+    this->search_result_list.clear();
+    Search_query query = get_search_query(in_text);
+
+    if (Singleton<Data_persistence>::get_instance().has_search_index == true)
+    {
+        // Results are sent page by page from a separate thread (see add_search_results()).
+        this->search_future = QtConcurrent::run(this, &Audio_collection_model::run_search, query, generation);
+    }
+    else
+    {
+        // No search index, check all items (terms are searched in full paths, as with the index).
+        foreach (Audio_collection_item *item, this->audio_item_list)
+        {
+            bool found = true;
+            foreach (const QString &term, query.terms)
+            {
+                if (item->get_full_path().contains(term, Qt::CaseInsensitive) == false)
+                {
+                    found = false;
+                }
+            }
+            float bpm = item->get_data(COLUMN_BPM).toFloat();
+            if (((query.key.isEmpty() == false) && (item->get_data(COLUMN_KEY).toString() != query.key)) ||
+                ((query.bpm_max > 0.0) && ((bpm < query.bpm_min) || (bpm > query.bpm_max))) ||
+                ((query.tag.isEmpty() == false) && (item->get_data(COLUMN_TAGS).toStringList().contains(query.tag) == false)))
+            {
+                found = false;
+            }
+            if (found == true)
+            {
+                this->search_result_list << item;
+            }
+        }
+        if (this->search_result_list.isEmpty() == false)
+        {
+            emit this->search_results_available(0, this->search_result_list.size());
+        }
+    }
+}
+
+void
+Audio_collection_model::run_search(const Search_query &in_query, const int &in_generation)
+{
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QString     after_path;
+    QStringList paths;
+    do
+    {
+        // Get next page of results and send it to the model thread (stop if another search started).
+        paths.clear();
+        if (data_persist->search_files(in_query, after_path, SEARCH_PAGE_SIZE, paths) == false)
+        {
+            break;
+        }
+        if (paths.isEmpty() == false)
+        {
+            after_path = paths.last();
+            QMetaObject::invokeMethod(this, "add_search_results", Qt::QueuedConnection,
+                                      Q_ARG(QStringList, paths), Q_ARG(int, in_generation));
+        }
+    }
+    while ((paths.size() == SEARCH_PAGE_SIZE) &&
+           (this->search_generation.load() == in_generation));
+}
+
+void
+Audio_collection_model::add_search_results(const QStringList &in_paths,
+                                           const int         &in_generation)
+{
+    // Results of a previous search.
+    if (in_generation != this->search_generation.load())
+    {
+        return;
+    }
+
+    // Keep only files shown by the model.
+    int first_result = this->search_result_list.size();
+    foreach (const QString &path, in_paths)
+    {
+        Audio_collection_item *item = this->item_by_path.value(path, nullptr);
+        if (item != nullptr)
+        {
+            this->search_result_list << item;
+        }
+    }
+    if (this->search_result_list.size() > first_result)
+    {
+        emit this->search_results_available(first_result, this->search_result_list.size() - first_result);
+    }
+}
+
+int
+Audio_collection_model::get_nb_search_results()
+{
+    return this->search_result_list.size();
+}
+
+QModelIndex
+Audio_collection_model::get_search_result(const int &in_number)
+{
+    if ((in_number < 0) || (in_number >= this->search_result_list.size()))
+    {
+        return QModelIndex();
+    }
+    Audio_collection_item *item = this->search_result_list[in_number];
+    int row = item->get_row();
+    this->fetch_rows(row);
+
+    return this->createIndex(row, 0, item);
 }
 
 void
@@ -814,7 +1156,253 @@ Audio_collection_model::clear()
         this->beginRemoveRows(this->get_root_index(), 0, this->rowCount());
         this->endRemoveRows();
         this->rootItem->childItems.clear();
+        this->nb_fetched_rows = 0;
         qDeleteAll(this->audio_item_list);
         this->audio_item_list.clear();
+        this->item_by_path.clear();
+        this->next_key_items.clear();
+        this->key_index_valid = false;
+    }
+
+    // Forget the last search.
+    this->search_generation.fetchAndAddOrdered(1);
+    this->search_result_list.clear();
+
+    // Stop watching directories of the previous collection.
+    this->watch_generation++;
+    this->directory_changes_timer.stop();
+    this->changed_directories.clear();
+    this->new_item_list.clear();
+    if (this->directory_watcher.directories().isEmpty() == false)
+    {
+        this->directory_watcher.removePaths(this->directory_watcher.directories());
+    }
+}
+
+void Audio_collection_model::watch_directories(const QStringList &in_directories)
+{
+    if (in_directories.isEmpty() == false)
+    {
+        QStringList failed = this->directory_watcher.addPaths(in_directories);
+        if (failed.isEmpty() == false)
+        {
+            qCWarning(DS_FILE) << "can not watch" << failed.size() << "directories of the collection";
+        }
+    }
+}
+
+void Audio_collection_model::on_directory_changed(const QString &in_path)
+{
+    // Wait a bit for other changes (a file being copied generates a lot of events).
+    this->changed_directories << in_path;
+    this->directory_changes_timer.start(DIRECTORY_CHANGES_DELAY_MS);
+}
+
+Directory_changes external_scan_changed_directories(const QStringList   &in_directories,
+                                                    const QSet<QString> &in_watched_directories)
+{
+    // List changed directories (not recursively), and fully scan new sub directories.
+    Directory_changes        changes;
+    Audio_collection_scanner scanner;
+    QList<File_index_entry>  files;
+    foreach (const QString &directory, in_directories)
+    {
+        changes.scanned_directories << directory;
+        if ((QDir(directory).exists() == true) &&
+            (scanner.scan_directory(directory, files, false) == true))
+        {
+            changes.files << files;
+            QStringList sub_directories = scanner.get_sub_directories();
+            changes.sub_directories.insert(directory, sub_directories);
+            foreach (const QString &sub_directory, sub_directories)
+            {
+                if ((in_watched_directories.contains(sub_directory) == false) &&
+                    (in_directories.contains(sub_directory) == false) &&
+                    (scanner.scan_directory(sub_directory, files) == true))
+                {
+                    changes.files << files;
+                    changes.new_directories << sub_directory << scanner.get_sub_directories();
+                }
+            }
+        }
+    }
+
+    return changes;
+}
+
+void Audio_collection_model::scan_changed_directories()
+{
+    // Do not change the list of items while it is parsed by other threads, try again later.
+    if ((this->concurrent_watcher_changes->isRunning() == true) ||
+        (this->concurrent_watcher_read->isRunning()    == true) ||
+        (this->concurrent_watcher_analyze->isRunning() == true))
+    {
+        this->directory_changes_timer.start(DIRECTORY_CHANGES_DELAY_MS);
+        return;
+    }
+
+    if (this->changed_directories.isEmpty() == false)
+    {
+        QStringList directories = this->changed_directories.toList();
+        this->changed_directories.clear();
+        this->changes_generation = this->watch_generation;
+        QFuture<Directory_changes> future = QtConcurrent::run(&external_scan_changed_directories,
+                                                              directories,
+                                                              this->directory_watcher.directories().toSet());
+        this->concurrent_watcher_changes->setFuture(future);
+    }
+}
+
+void Audio_collection_model::apply_directory_changes()
+{
+    // Drop result if the collection changed in the meantime.
+    if (this->changes_generation != this->watch_generation)
+    {
+        return;
+    }
+
+    // Collection is parsed by other threads, scan again later.
+    Directory_changes changes = this->concurrent_watcher_changes->result();
+    if ((this->concurrent_watcher_read->isRunning()    == true) ||
+        (this->concurrent_watcher_analyze->isRunning() == true))
+    {
+        this->changed_directories.unite(changes.scanned_directories.toSet());
+        this->directory_changes_timer.start(DIRECTORY_CHANGES_DELAY_MS);
+        return;
+    }
+    this->new_item_list.clear();
+
+    // Get directories which do not exist anymore (and stop watching them).
+    QStringList watched_directories = this->directory_watcher.directories();
+    QStringList removed_directories;
+    foreach (const QString &directory, changes.scanned_directories)
+    {
+        if (changes.sub_directories.contains(directory) == false)
+        {
+            removed_directories << directory;
+        }
+        else
+        {
+            foreach (const QString &watched, watched_directories)
+            {
+                if ((QFileInfo(watched).path() == directory) &&
+                    (changes.sub_directories[directory].contains(watched) == false))
+                {
+                    removed_directories << watched;
+                }
+            }
+        }
+    }
+    QStringList unwatched_directories;
+    foreach (const QString &watched, watched_directories)
+    {
+        foreach (const QString &removed, removed_directories)
+        {
+            if ((watched == removed) || (watched.startsWith(removed + '/') == true))
+            {
+                unwatched_directories << watched;
+                break;
+            }
+        }
+    }
+    if (unwatched_directories.isEmpty() == false)
+    {
+        this->directory_watcher.removePaths(unwatched_directories);
+    }
+
+    // Remove items of files which do not exist anymore.
+    QSet<QString> found_files;
+    foreach (const File_index_entry &file, changes.files)
+    {
+        found_files << file.path;
+    }
+    QSet<QString> existing_files;
+    for (int row = this->rootItem->get_child_count() - 1; row >= 0; row--)
+    {
+        Audio_collection_item *item = this->rootItem->get_child(row);
+        QString path    = item->get_full_path();
+        bool    removed = (changes.sub_directories.contains(QFileInfo(path).path()) == true) &&
+                          (found_files.contains(path) == false);
+        foreach (const QString &removed_directory, removed_directories)
+        {
+            if (path.startsWith(removed_directory + '/') == true)
+            {
+                removed = true;
+                break;
+            }
+        }
+
+        if (removed == true)
+        {
+            // Rows not fetched yet are unknown to the view.
+            bool fetched = row < this->nb_fetched_rows;
+            if (fetched == true)
+            {
+                this->beginRemoveRows(QModelIndex(), row, row);
+            }
+            this->rootItem->childItems.removeAt(row);
+            this->audio_item_list.removeOne(item);
+            this->item_by_path.remove(path);
+            this->search_result_list.removeAll(item);
+            this->next_key_items.removeAll(item);
+            this->key_index_valid = false;
+            if (fetched == true)
+            {
+                this->nb_fetched_rows--;
+                this->endRemoveRows();
+            }
+            delete item;
+        }
+        else
+        {
+            existing_files << path;
+        }
+    }
+
+    // Add items of new files.
+    QList<File_index_entry> new_files;
+    foreach (const File_index_entry &file, changes.files)
+    {
+        if (existing_files.contains(file.path) == false)
+        {
+            existing_files << file.path;
+            new_files << file;
+        }
+    }
+    if (new_files.isEmpty() == false)
+    {
+        // New rows are shown now only if all rows are already shown, otherwise they are fetched later.
+        int first_row  = this->rootItem->get_child_count();
+        int first_item = this->audio_item_list.size();
+        if (this->nb_fetched_rows == first_row)
+        {
+            this->beginInsertRows(QModelIndex(), first_row, first_row + new_files.size() - 1);
+            this->setup_model_data(new_files, this->rootItem);
+            this->nb_fetched_rows += new_files.size();
+            this->endInsertRows();
+        }
+        else
+        {
+            this->setup_model_data(new_files, this->rootItem);
+        }
+
+        // Get already known data of new items.
+        this->new_item_list = this->audio_item_list.mid(first_item);
+        this->read_items_from_db(this->new_item_list, this->read_generation.load());
+    }
+
+    // Watch new directories.
+    this->watch_directories(changes.new_directories);
+
+    // Analyse only new items.
+    if (this->new_item_list.isEmpty() == false)
+    {
+        this->concurrent_analyse_audio_selection(this->new_item_list);
+    }
+
+    // Some changes arrived during the scan.
+    if (this->changed_directories.isEmpty() == false)
+    {
+        this->directory_changes_timer.start(DIRECTORY_CHANGES_DELAY_MS);
     }
 }
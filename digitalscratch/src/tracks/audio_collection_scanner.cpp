@@ -0,0 +1,288 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*-------------------------------------------( audio_collection_scanner.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*  Scan audio files of a collection, using an index to not hash them again   */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <QtDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QtConcurrentMap>
+
+#include "app/application_logging.h"
+#include "tracks/audio_collection_scanner.h"
+#include "utils.h"
+#include "singleton.h"
+
+// Content of one directory (not recursive).
+struct Directory_listing
+{
+    QString                 path;
+    QStringList             sub_directories;
+    QList<File_index_entry> files;
+};
+
+Directory_listing external_list_directory(const QString &in_path)
+{
+    // Only a wrapper to list a directory in a separate thread.
+    QStringList filters;
+    for (int i = 0; i < Utils::audio_file_extensions.size(); i++)
+    {
+        filters << (QString("*.") + Utils::audio_file_extensions.at(i));
+    }
+    QDir dir(in_path);
+    dir.setNameFilters(filters);
+    dir.setFilter(QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot);
+    dir.setSorting(QDir::DirsFirst);
+
+    Directory_listing listing;
+    listing.path = in_path;
+    foreach (QFileInfo file_info, dir.entryInfoList())
+    {
+        if (file_info.isDir() == true)
+        {
+            listing.sub_directories << file_info.absoluteFilePath();
+        }
+        else
+        {
+            File_index_entry entry;
+            entry.path  = file_info.absoluteFilePath();
+            entry.size  = file_info.size();
+            entry.mtime = file_info.lastModified().toMSecsSinceEpoch();
+            listing.files << entry;
+        }
+    }
+
+    return listing;
+}
+
+void external_hash_file(File_index_entry *&in_entry)
+{
+    // Only a wrapper to hash a file in a separate thread.
+    in_entry->hash = Utils::get_file_hash(in_entry->path);
+}
+
+void append_files_of_directory(const QString                           &path,
+                               const QHash<QString, Directory_listing> &listings,
+                               QList<File_index_entry>                 &out_files)
+{
+    // Files of sub directories first (same order as a recursive walk).
+    const Directory_listing &listing = listings[path];
+    foreach (const QString &sub_directory, listing.sub_directories)
+    {
+        append_files_of_directory(sub_directory, listings, out_files);
+    }
+    out_files << listing.files;
+}
+
+Audio_collection_scanner::Audio_collection_scanner()
+{
+    this->nb_hashed_files = 0;
+
+    return;
+}
+
+Audio_collection_scanner::~Audio_collection_scanner()
+{
+    return;
+}
+
+bool
+Audio_collection_scanner::scan_directory(const QString           &root_path,
+                                         QList<File_index_entry> &out_files,
+                                         const bool              &recursive)
+{
+    out_files.clear();
+    this->sub_directories.clear();
+    this->nb_hashed_files = 0;
+
+    // Check root path.
+    QDir root_dir(root_path);
+    if ((root_path.isEmpty() == true) || (root_dir.exists() == false))
+    {
+        qCWarning(DS_FILE) << "can not scan" << root_path << ": directory does not exist";
+        return false;
+    }
+    QString root = root_dir.absolutePath();
+
+    // Walk the tree level by level, directories of a level are listed in parallel.
+    QHash<QString, Directory_listing> listings;
+    QStringList                       directories(root);
+    while (directories.isEmpty() == false)
+    {
+        QList<Directory_listing> level = QtConcurrent::blockingMapped(directories, &external_list_directory);
+        directories.clear();
+        foreach (const Directory_listing &listing, level)
+        {
+            listings.insert(listing.path, listing);
+            this->sub_directories << listing.sub_directories;
+            if (recursive == true)
+            {
+                directories << listing.sub_directories;
+            }
+        }
+    }
+    if (recursive == true)
+    {
+        append_files_of_directory(root, listings, out_files);
+    }
+    else
+    {
+        out_files = listings[root].files;
+    }
+
+    // Get hash of files (from index if possible).
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QHash<QString, File_index_entry> index;
+    data_persist->get_file_index(root, index);
+    this->update_hashes(out_files, index);
+
+    // Forget files which do not exist anymore (only in scanned directories).
+    foreach (const File_index_entry &entry, out_files)
+    {
+        index.remove(entry.path);
+    }
+    if (recursive == false)
+    {
+        foreach (const QString &path, index.keys())
+        {
+            if (QFileInfo(path).path() != root)
+            {
+                index.remove(path);
+            }
+        }
+    }
+    if (index.isEmpty() == false)
+    {
+        data_persist->delete_file_index(index.keys());
+    }
+
+    qCDebug(DS_FILE) << out_files.size() << "files found in" << root << "," << this->nb_hashed_files << "hashed";
+
+    return true;
+}
+
+bool
+Audio_collection_scanner::scan_files(const QStringList       &paths,
+                                     QList<File_index_entry> &out_files)
+{
+    out_files.clear();
+    this->sub_directories.clear();
+    this->nb_hashed_files = 0;
+
+    // Keep only existing audio files.
+    foreach (const QString &path, paths)
+    {
+        QFileInfo file_info(path);
+        if ((file_info.exists() == true) &&
+            (file_info.isDir() == false) &&
+            (Utils::audio_file_extensions.contains(file_info.suffix(), Qt::CaseInsensitive) == true))
+        {
+            File_index_entry entry;
+            entry.path  = file_info.absoluteFilePath();
+            entry.size  = file_info.size();
+            entry.mtime = file_info.lastModified().toMSecsSinceEpoch();
+            out_files << entry;
+        }
+    }
+
+    // Get hash of files (from index of their common parent directory if possible).
+    QHash<QString, File_index_entry> index;
+    if (out_files.isEmpty() == false)
+    {
+        QString common_dir = QFileInfo(out_files.first().path).path();
+        foreach (const File_index_entry &entry, out_files)
+        {
+            while ((entry.path.startsWith(common_dir + '/') == false) && (QFileInfo(common_dir).isRoot() == false))
+            {
+                common_dir = QFileInfo(common_dir).path();
+            }
+        }
+        Singleton<Data_persistence>::get_instance().get_file_index(common_dir, index);
+    }
+    this->update_hashes(out_files, index);
+
+    return true;
+}
+
+int
+Audio_collection_scanner::get_nb_hashed_files()
+{
+    return this->nb_hashed_files;
+}
+
+const QStringList &
+Audio_collection_scanner::get_sub_directories()
+{
+    return this->sub_directories;
+}
+
+void
+Audio_collection_scanner::update_hashes(QList<File_index_entry>                &files,
+                                        const QHash<QString, File_index_entry> &index)
+{
+    // Get files which are not in the index or which changed since they were indexed.
+    QList<File_index_entry*> files_to_hash;
+    for (int i = 0; i < files.size(); i++)
+    {
+        File_index_entry &file = files[i];
+        QHash<QString, File_index_entry>::const_iterator indexed = index.constFind(file.path);
+        if ((indexed != index.constEnd()) &&
+            (indexed->size  == file.size) &&
+            (indexed->mtime == file.mtime))
+        {
+            file.hash = indexed->hash;
+        }
+        else
+        {
+            files_to_hash << &file;
+        }
+    }
+
+    // Hash them in parallel and update the index.
+    this->nb_hashed_files = files_to_hash.size();
+    if (files_to_hash.isEmpty() == false)
+    {
+        QtConcurrent::blockingMap(files_to_hash, &external_hash_file);
+
+        QList<File_index_entry> new_entries;
+        foreach (File_index_entry *file, files_to_hash)
+        {
+            if (file->hash.isEmpty() == false)
+            {
+                new_entries << *file;
+            }
+        }
+        Singleton<Data_persistence>::get_instance().store_file_index(new_entries);
+    }
+
+    return;
+}
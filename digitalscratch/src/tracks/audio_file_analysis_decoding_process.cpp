@@ -0,0 +1,377 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*-------------------------------( audio_file_analysis_decoding_process.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*      Behavior class: decode an audio file for analysis (key, bpm,...)      */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <QtDebug>
+#include <QFile>
+#include <algorithm>
+
+#include <samplerate.h>
+extern "C"
+{
+    #include "libavutil/log.h"
+    #include "libavutil/opt.h"
+    #include "libavutil/channel_layout.h"
+}
+
+#include "app/application_logging.h"
+#include "tracks/audio_file_analysis_decoding_process.h"
+
+Audio_file_analysis_decoding_process::Audio_file_analysis_decoding_process(const unsigned int       &sample_rate,
+                                                                           const unsigned short int &nb_segments,
+                                                                           const unsigned int       &segment_length)
+{
+    this->sample_rate    = sample_rate;
+    this->nb_segments    = nb_segments;
+    this->segment_length = segment_length;
+    this->nb_samples     = 0;
+    this->max_nb_samples = MAX_MINUTES_TRACK * 60 * this->sample_rate;
+
+    // Init libAV log level.
+    av_log_set_level(AV_LOG_QUIET);
+
+    return;
+}
+
+Audio_file_analysis_decoding_process::~Audio_file_analysis_decoding_process()
+{
+    return;
+}
+
+void
+Audio_file_analysis_decoding_process::clear()
+{
+    this->nb_samples = 0;
+    this->segment_positions.clear();
+    this->segment_starts.clear();
+}
+
+bool
+Audio_file_analysis_decoding_process::run(const QString &path)
+{
+    // Check if file exists.
+    if (QFile::exists(path) == false)
+    {
+        qCWarning(DS_FILE) << "file" << path << "does not exists";
+        return false;
+    }
+
+    // Decode compressed audio.
+    this->clear();
+    if (this->decode(path) == false)
+    {
+        qCWarning(DS_FILE) << "can not decode" << path;
+        return false;
+    }
+
+    return true;
+}
+
+const float *
+Audio_file_analysis_decoding_process::get_samples() const
+{
+    return this->samples.constData();
+}
+
+const short signed int *
+Audio_file_analysis_decoding_process::get_short_samples()
+{
+    // Convert float samples to integer ones (format needed by libKeyFinder).
+    if ((unsigned int)this->short_samples.size() < this->nb_samples)
+    {
+        this->short_samples.resize(this->nb_samples);
+    }
+    src_float_to_short_array(this->samples.constData(), this->short_samples.data(), this->nb_samples);
+
+    return this->short_samples.constData();
+}
+
+unsigned int
+Audio_file_analysis_decoding_process::get_nb_samples() const
+{
+    return this->nb_samples;
+}
+
+unsigned int
+Audio_file_analysis_decoding_process::get_sample_rate() const
+{
+    return this->sample_rate;
+}
+
+const QVector<unsigned int> &
+Audio_file_analysis_decoding_process::get_segment_positions() const
+{
+    return this->segment_positions;
+}
+
+const QVector<unsigned int> &
+Audio_file_analysis_decoding_process::get_segment_starts() const
+{
+    return this->segment_starts;
+}
+
+bool
+Audio_file_analysis_decoding_process::append_frame(AVFrame            *frame,
+                                                   AVStream           *audio_stream,
+                                                   SwrContext         *swr,
+                                                   const unsigned int &max_segment_nb_samples,
+                                                   unsigned int       &segment_nb_samples)
+{
+    // First frame of a segment: keep track of where it is in the file.
+    if (segment_nb_samples == 0)
+    {
+        int64_t    timestamp = frame->best_effort_timestamp;
+        AVRational msec_base = {1, 1000};
+        if ((timestamp == AV_NOPTS_VALUE) || (timestamp < 0))
+        {
+            timestamp = 0;
+        }
+        if ((this->segment_starts.size() > 0) && (this->segment_starts.last() == this->nb_samples))
+        {
+            // Previous frame did not produce any sample, forget its position.
+            this->segment_positions.removeLast();
+            this->segment_starts.removeLast();
+        }
+        this->segment_positions << (unsigned int)av_rescale_q(timestamp, audio_stream->time_base, msec_base);
+        this->segment_starts    << this->nb_samples;
+    }
+
+    // Get the max number of samples which could be produced by this frame.
+    int out_nb_samples = swr_get_out_samples(swr, frame->nb_samples);
+    if (out_nb_samples <= 0)
+    {
+        return false;
+    }
+    unsigned int out_count = std::min((unsigned int)out_nb_samples, this->max_nb_samples - this->nb_samples);
+
+    // Grow the buffer if necessary (it is never shrinked, so it is reused by next decoding).
+    if ((this->nb_samples + out_count) > (unsigned int)this->samples.size())
+    {
+        unsigned int new_size = std::max(this->nb_samples + out_count, (unsigned int)this->samples.size() * 2);
+        this->samples.resize(std::min(new_size, this->max_nb_samples));
+    }
+
+    // Downmix, resample and convert to float in one pass.
+    uint8_t *output = (uint8_t *)(this->samples.data() + this->nb_samples);
+    int nb_converted = swr_convert(swr,
+                                   &output, out_count,                                     // out buffer
+                                   (const uint8_t **)frame->extended_data, frame->nb_samples); // in buffer
+    if (nb_converted < 0)
+    {
+        qCWarning(DS_FILE) << "audio frame conversion failed";
+        return true;
+    }
+
+    // Keep only what is needed for the current segment.
+    unsigned int nb_kept = std::min((unsigned int)nb_converted, max_segment_nb_samples - segment_nb_samples);
+    this->nb_samples   += nb_kept;
+    segment_nb_samples += nb_kept;
+
+    return (segment_nb_samples >= max_segment_nb_samples) || (this->nb_samples >= this->max_nb_samples);
+}
+
+bool
+Audio_file_analysis_decoding_process::decode_segment(AVFormatContext    *format_context,
+                                                     AVCodecContext     *codec_context,
+                                                     AVStream           *audio_stream,
+                                                     AVFrame            *frame,
+                                                     SwrContext         *swr,
+                                                     const unsigned int &max_segment_nb_samples)
+{
+    // Create a packet.
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = nullptr;
+    packet.size = 0;
+
+    // Read the packets in a loop until the segment is full.
+    unsigned int segment_nb_samples = 0;
+    bool         decoding_done      = false;
+    while ((decoding_done == false) && (av_read_frame(format_context, &packet) == 0))
+    {
+        if (packet.stream_index == audio_stream->index)
+        {
+            if (avcodec_send_packet(codec_context, &packet) < 0)
+            {
+                qCWarning(DS_FILE) << "packet decode error";
+            }
+            else
+            {
+                // A packet can contain more than one frame.
+                while ((decoding_done == false) && (avcodec_receive_frame(codec_context, frame) == 0))
+                {
+                    decoding_done = this->append_frame(frame, audio_stream, swr, max_segment_nb_samples, segment_nb_samples);
+                }
+            }
+        }
+
+        // Cleanup packet.
+        av_packet_unref(&packet);
+    }
+
+    return segment_nb_samples > 0;
+}
+
+bool
+Audio_file_analysis_decoding_process::decode(const QString &path)
+{
+    // Get file name to decode.
+    QByteArray  filename_array = path.toUtf8();
+    const char *filename       = filename_array.constData();
+
+    // Allocate a frame.
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+    {
+        return false;
+    }
+
+    // Open file.
+    AVFormatContext *format_context = nullptr;
+    if (avformat_open_input(&format_context, filename, nullptr, nullptr) != 0)
+    {
+        av_frame_free(&frame);
+        qCWarning(DS_FILE) << "error opening file" << filename;
+        return false;
+    }
+
+    // Get audio format.
+    if (avformat_find_stream_info(format_context, nullptr) < 0)
+    {
+        av_frame_free(&frame);
+        avformat_close_input(&format_context);
+        qCWarning(DS_FILE) << "error finding the stream info" << filename;
+        return false;
+    }
+
+    // Find the audio stream (some container files can have multiple streams in them).
+    AVStream *audio_stream = nullptr;
+    for (unsigned int i = 0; i < format_context->nb_streams; ++i)
+    {
+        if (format_context->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+        {
+            audio_stream = format_context->streams[i];
+            break;
+        }
+    }
+    if (audio_stream == nullptr)
+    {
+        av_frame_free(&frame);
+        avformat_close_input(&format_context);
+        qCWarning(DS_FILE) << "could not find any audio stream in the file" << filename;
+        return false;
+    }
+
+    // Get decoder for the codec of the audio file.
+    AVCodec        *codec         = avcodec_find_decoder(audio_stream->codecpar->codec_id);
+    AVCodecContext *codec_context = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(codec_context, audio_stream->codecpar);
+    if ((codec_context->codec == nullptr) ||
+        (avcodec_open2(codec_context, codec_context->codec, nullptr) != 0))
+    {
+        av_frame_free(&frame);
+        avcodec_free_context(&codec_context);
+        avformat_close_input(&format_context);
+        qCWarning(DS_FILE) << "couldn't open a proper decoder" << filename;
+        return false;
+    }
+
+    // Set up SWR (software resample) context for a conversion from any format
+    // to mono float samples at the analysis sample rate.
+    int64_t in_channel_layout = codec_context->channel_layout;
+    if (in_channel_layout == 0)
+    {
+        in_channel_layout = av_get_default_channel_layout(codec_context->channels);
+    }
+    SwrContext *swr = swr_alloc();
+    av_opt_set_int(swr, "in_channel_layout",  in_channel_layout,           0);
+    av_opt_set_int(swr, "out_channel_layout", AV_CH_LAYOUT_MONO,           0);
+    av_opt_set_int(swr, "in_sample_rate",     codec_context->sample_rate,  0);
+    av_opt_set_int(swr, "out_sample_rate",    this->sample_rate,           0);
+    av_opt_set_sample_fmt(swr, "in_sample_fmt",  codec_context->sample_fmt, 0);
+    av_opt_set_sample_fmt(swr, "out_sample_fmt", AV_SAMPLE_FMT_FLT,         0);
+    if (swr_init(swr) < 0)
+    {
+        av_frame_free(&frame);
+        avcodec_free_context(&codec_context);
+        avformat_close_input(&format_context);
+        swr_free(&swr);
+        qCWarning(DS_FILE) << "can not convert audio format" << filename;
+        return false;
+    }
+
+    // Get length of the track (sec).
+    double duration = 0.0;
+    if (format_context->duration != AV_NOPTS_VALUE)
+    {
+        duration = (double)format_context->duration / AV_TIME_BASE;
+    }
+
+    bool result = true;
+    if ((this->nb_segments == 0) ||
+        (duration < (double)(this->nb_segments * this->segment_length * 2)))
+    {
+        // Short track (or unknown length): decode all of it.
+        result = this->decode_segment(format_context, codec_context, audio_stream, frame, swr, this->max_nb_samples);
+    }
+    else
+    {
+        // Long track: only decode some parts, each one centered in an equal slice of the track.
+        AVRational   time_base_q            = {1, AV_TIME_BASE};
+        unsigned int max_segment_nb_samples = this->segment_length * this->sample_rate;
+        for (unsigned short int i = 0; (i < this->nb_segments) && (result == true); i++)
+        {
+            double  start     = (duration * (2 * i + 1) / (2 * this->nb_segments)) - (this->segment_length / 2.0);
+            int64_t timestamp = av_rescale_q((int64_t)(start * AV_TIME_BASE), time_base_q, audio_stream->time_base);
+            if (av_seek_frame(format_context, audio_stream->index, timestamp, AVSEEK_FLAG_BACKWARD) < 0)
+            {
+                qCWarning(DS_FILE) << "can not seek in" << filename;
+                result = false;
+            }
+            else
+            {
+                // Forget what the decoder and the resampler kept from the previous position.
+                avcodec_flush_buffers(codec_context);
+                swr_init(swr);
+                result = this->decode_segment(format_context, codec_context, audio_stream, frame, swr, max_segment_nb_samples);
+            }
+        }
+    }
+
+    // Cleanup.
+    av_frame_free(&frame);
+    avcodec_free_context(&codec_context);
+    avformat_close_input(&format_context);
+    swr_free(&swr);
+
+    return result;
+}
@@ -43,6 +43,8 @@ extern "C"
 
 #include "app/application_logging.h"
 #include "tracks/audio_file_decoding_process.h"
+#include "tracks/data_persistence.h"
+#include "singleton.h"
 
 Audio_file_decoding_process::Audio_file_decoding_process(const QSharedPointer<Audio_track> &at,
                                                          const bool &do_resample)
@@ -118,9 +120,47 @@ Audio_file_decoding_process::run(const QString &path,
     // Set file hash.
     this->at->set_hash(file_hash);
 
+    // Summarize decoded samples at several resolutions (used to display the waveform).
+    this->compute_overview();
+
     return true;
 }
 
+void
+Audio_file_decoding_process::compute_overview()
+{
+    Audio_track_overview *overview = this->at->get_overview();
+    if (overview == nullptr)
+    {
+        return;
+    }
+
+    // Without a hash, the overview can not be stored: just compute it (and do not open the DB).
+    if (this->at->get_hash() == "")
+    {
+        overview->compute(this->at->get_samples(), this->at->get_end_of_samples() / 2);
+        return;
+    }
+
+    // The file could have been summarized when it was previously loaded.
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QByteArray        data;
+    if ((data_persist->get_analysis(this->at->get_hash(), ANALYSIS_WAVEFORM_OVERVIEW, data) == true) &&
+        (overview->from_byte_array(data, this->at->get_sample_rate()) == true))
+    {
+        return;
+    }
+
+    // Compute it and keep it for the next time.
+    overview->compute(this->at->get_samples(), this->at->get_end_of_samples() / 2);
+    if (overview->to_byte_array(this->at->get_sample_rate(), data) == true)
+    {
+        data_persist->store_analysis(this->at->get_hash(), ANALYSIS_WAVEFORM_OVERVIEW, data);
+    }
+
+    return;
+}
+
 void
 Audio_file_decoding_process::resample_track()
 {
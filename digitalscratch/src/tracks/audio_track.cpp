@@ -46,6 +46,7 @@ Audio_track::Audio_track(const unsigned int &sample_rate)
     this->sample_rate = sample_rate;
     this->max_nb_samples = 0;
     this->samples = nullptr;
+    this->overview = nullptr;
     this->reset();
 
     return;
@@ -59,6 +60,7 @@ Audio_track::Audio_track(const short unsigned int &max_minutes,
     this->max_nb_samples = max_minutes * 2 * 60 * this->sample_rate;
     // Add also several seconds more, which is used to put more infos in decoding step.
     this->samples = new short signed int[this->max_nb_samples + this->get_security_nb_samples()];
+    this->overview = new Audio_track_overview(this->max_nb_samples / 2);
     this->reset();
 
     return;
@@ -67,6 +69,7 @@ Audio_track::Audio_track(const short unsigned int &max_minutes,
 Audio_track::~Audio_track()
 {
     delete [] this->samples;
+    delete this->overview;
 
     return;
 }
@@ -82,10 +85,16 @@ Audio_track::reset()
     this->filename       = "";
     this->music_key      = "";
     this->music_key_tag  = "";
+    this->bpm            = 0.0;
+    this->first_beat     = 0;
     if (this->samples != nullptr)
     {
         memset(&this->samples[0], 0, (this->max_nb_samples + this->get_security_nb_samples()) * sizeof this->samples[0]);
     }
+    if (this->overview != nullptr)
+    {
+        this->overview->reset();
+    }
 
     return;
 }
@@ -255,6 +264,34 @@ Audio_track::set_music_key_tag(const QString &key_tag)
     return true;
 }
 
+float
+Audio_track::get_bpm() const
+{
+    return this->bpm;
+}
+
+bool
+Audio_track::set_bpm(const float &bpm)
+{
+    this->bpm = bpm;
+
+    return true;
+}
+
+unsigned int
+Audio_track::get_first_beat() const
+{
+    return this->first_beat;
+}
+
+bool
+Audio_track::set_first_beat(const unsigned int &first_beat)
+{
+    this->first_beat = first_beat;
+
+    return true;
+}
+
 QStringList
 Audio_track::get_tags() const
 {
@@ -268,3 +305,9 @@ Audio_track::set_tags(const QStringList &tags)
 
     return true;
 }
+
+Audio_track_overview *
+Audio_track::get_overview() const
+{
+    return this->overview;
+}
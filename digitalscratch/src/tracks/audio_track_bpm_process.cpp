@@ -0,0 +1,282 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*--------------------------------------------( audio_track_bpm_process.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*    Behavior class: compute tempo (bpm) and beat grid of an audio track     */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <QtDebug>
+#include <cmath>
+#include <algorithm>
+
+#include "tracks/audio_track_bpm_process.h"
+#include "app/application_logging.h"
+
+Audio_track_bpm_process::Audio_track_bpm_process(const QSharedPointer<Audio_file_analysis_decoding_process> &analysis)
+{
+    if (analysis.data() == nullptr)
+    {
+        qCWarning(DS_BPM) << "analysis data is null";
+    }
+    else
+    {
+        this->analysis = analysis;
+    }
+    this->bpm           = 0.0;
+    this->first_beat    = 0;
+    this->envelope_rate = 0.0;
+
+    return;
+}
+
+Audio_track_bpm_process::~Audio_track_bpm_process()
+{
+    return;
+}
+
+bool
+Audio_track_bpm_process::run()
+{
+    // Check if there are enough decoded audio data (at least a few beats).
+    if ((this->analysis.data() == nullptr) ||
+        (this->analysis->get_nb_samples() < this->analysis->get_sample_rate() * 5))
+    {
+        return false;
+    }
+    this->envelope_rate = (float)this->analysis->get_sample_rate() / (float)BPM_ENVELOPE_HOP;
+
+    // Get variations of energy of the signal.
+    this->compute_onset_envelope();
+
+    // Search a periodicity of the onsets in the tempo range.
+    int min_lag = floor(60.0 * this->envelope_rate / BPM_MAX);
+    int max_lag = ceil(60.0 * this->envelope_rate / BPM_MIN);
+    QVector<float> acf;
+    this->compute_autocorrelation(acf, max_lag * BPM_NB_HARMONICS);
+    float period = this->find_beat_period(acf, min_lag, max_lag);
+    if (period <= 0.0)
+    {
+        qCWarning(DS_BPM) << "no tempo found";
+        return false;
+    }
+    this->bpm = qRound(6000.0 * this->envelope_rate / period) / 100.0;
+
+    // Get position of the first beat of the track.
+    float position = this->find_beat_phase(period) * 1000.0 / this->envelope_rate;
+    if (this->analysis->get_segment_positions().size() > 0)
+    {
+        position += this->analysis->get_segment_positions().first();
+    }
+    this->first_beat = (unsigned int)fmod(position, 60000.0 / this->bpm);
+
+    return true;
+}
+
+float
+Audio_track_bpm_process::get_bpm()
+{
+    return this->bpm;
+}
+
+unsigned int
+Audio_track_bpm_process::get_first_beat()
+{
+    return this->first_beat;
+}
+
+void
+Audio_track_bpm_process::compute_onset_envelope()
+{
+    const float           *samples    = this->analysis->get_samples();
+    unsigned int           nb_samples = this->analysis->get_nb_samples();
+    QVector<unsigned int>  starts     = this->analysis->get_segment_starts();
+    if (starts.size() == 0)
+    {
+        starts << 0;
+    }
+
+    this->onsets.clear();
+    this->segment_starts.clear();
+    for (int s = 0; s < starts.size(); s++)
+    {
+        // Each part is handled separately, there is no continuity between them.
+        unsigned int end = (s + 1 < starts.size()) ? starts[s + 1] : nb_samples;
+        int nb_values    = (end - starts[s]) / BPM_ENVELOPE_HOP;
+        int begin        = this->onsets.size();
+        this->segment_starts << begin;
+
+        // Positive variation of the log energy (a note attack or a drum hit).
+        float previous = 0.0;
+        for (int v = 0; v < nb_values; v++)
+        {
+            const float *frame  = samples + starts[s] + v * BPM_ENVELOPE_HOP;
+            float        energy = 0.0;
+            for (int i = 0; i < BPM_ENVELOPE_HOP; i++)
+            {
+                energy += frame[i] * frame[i];
+            }
+            float value = log(1.0 + 1000.0 * energy / BPM_ENVELOPE_HOP);
+            this->onsets << ((v == 0) ? 0.0 : std::max(0.0f, value - previous));
+            previous = value;
+        }
+
+        // Remove the local mean (half a second), so only salient onsets remain.
+        int            half_window = std::max(1, (int)(this->envelope_rate / 4.0));
+        QVector<float> sums(nb_values + 1, 0.0);
+        for (int v = 0; v < nb_values; v++)
+        {
+            sums[v + 1] = sums[v] + this->onsets[begin + v];
+        }
+        for (int v = 0; v < nb_values; v++)
+        {
+            int   from = std::max(0, v - half_window);
+            int   to   = std::min(nb_values, v + half_window + 1);
+            float mean = (sums[to] - sums[from]) / (to - from);
+            this->onsets[begin + v] = std::max(0.0f, this->onsets[begin + v] - mean);
+        }
+    }
+
+    return;
+}
+
+void
+Audio_track_bpm_process::compute_autocorrelation(QVector<float> &acf, const int &max_lag)
+{
+    acf.fill(0.0, max_lag + 1);
+    const float *onsets = this->onsets.constData();
+    for (int s = 0; s < this->segment_starts.size(); s++)
+    {
+        int begin = this->segment_starts[s];
+        int end   = (s + 1 < this->segment_starts.size()) ? this->segment_starts[s + 1] : this->onsets.size();
+        int size  = end - begin;
+        for (int lag = 0; (lag <= max_lag) && (lag < size); lag++)
+        {
+            float sum = 0.0;
+            for (int i = begin; i < end - lag; i++)
+            {
+                sum += onsets[i] * onsets[i + lag];
+            }
+            acf[lag] += sum / (size - lag);
+        }
+    }
+
+    return;
+}
+
+float
+Audio_track_bpm_process::find_beat_period(const QVector<float> &acf,
+                                          const int            &min_lag,
+                                          const int            &max_lag)
+{
+    // Comb filter: a period matches if its multiples are also periodicities of the signal.
+    int   best_lag   = -1;
+    float best_score = 0.0;
+    for (int lag = std::max(1, min_lag); lag <= max_lag; lag++)
+    {
+        float score = 0.0;
+        for (int k = 1; (k <= BPM_NB_HARMONICS) && (k * lag < acf.size()); k++)
+        {
+            score += acf[k * lag] / k;
+        }
+
+        // Prefer tempos close to the usual ones to avoid half/double tempo errors.
+        float octaves = log2(60.0 * this->envelope_rate / lag / BPM_PRIOR_CENTER) / BPM_PRIOR_WIDTH;
+        score *= exp(-0.5 * octaves * octaves);
+        if (score > best_score)
+        {
+            best_score = score;
+            best_lag   = lag;
+        }
+    }
+    if (best_lag < 0)
+    {
+        return 0.0;
+    }
+
+    // Refine the period: the peak around the biggest available multiple of the
+    // lag gives a resolution which is a fraction of an envelope value.
+    int k = BPM_NB_HARMONICS;
+    while ((k > 1) && ((k * best_lag + k) >= acf.size() - 1))
+    {
+        k--;
+    }
+    int peak = k * best_lag;
+    for (int i = std::max(1, k * best_lag - k / 2 - 1); (i <= k * best_lag + k / 2 + 1) && (i < acf.size() - 1); i++)
+    {
+        if (acf[i] > acf[peak])
+        {
+            peak = i;
+        }
+    }
+    float delta = 0.0;
+    if ((peak > 0) && (peak < acf.size() - 1))
+    {
+        // Parabolic interpolation of the peak.
+        float denominator = acf[peak - 1] - 2.0 * acf[peak] + acf[peak + 1];
+        if (denominator < 0.0)
+        {
+            delta = 0.5 * (acf[peak - 1] - acf[peak + 1]) / denominator;
+            delta = std::max(-0.5f, std::min(0.5f, delta));
+        }
+    }
+
+    return (peak + delta) / k;
+}
+
+float
+Audio_track_bpm_process::find_beat_phase(const float &period)
+{
+    // Use the first decoded part, the closest one to the beginning of the track.
+    int begin = 0;
+    int end   = (this->segment_starts.size() > 1) ? this->segment_starts[1] : this->onsets.size();
+
+    // Try all positions in one beat period, keep the one where beats match most onsets.
+    int   best_phase = 0;
+    float best_score = -1.0;
+    for (int phase = 0; phase < (int)ceil(period); phase++)
+    {
+        float score = 0.0;
+        for (int beat = 0; ; beat++)
+        {
+            int i = begin + phase + qRound(beat * period);
+            if (i >= end)
+            {
+                break;
+            }
+            score += this->onsets[i];
+        }
+        if (score > best_score)
+        {
+            best_score = score;
+            best_phase = phase;
+        }
+    }
+
+    return best_phase;
+}
@@ -51,6 +51,20 @@ Audio_track_key_process::Audio_track_key_process(const QSharedPointer<Audio_trac
     return;
 }
 
+Audio_track_key_process::Audio_track_key_process(const QSharedPointer<Audio_file_analysis_decoding_process> &analysis)
+{
+    if (analysis.data() == nullptr)
+    {
+        qCWarning(DS_MUSICKEY) << "analysis data is null";
+    }
+    else
+    {
+        this->analysis = analysis;
+    }
+
+    return;
+}
+
 Audio_track_key_process::~Audio_track_key_process()
 {
     return;
@@ -59,30 +73,58 @@ Audio_track_key_process::~Audio_track_key_process()
 bool
 Audio_track_key_process::run()
 {
-    // Check if there are decoded audio data in audio track.
-    if (this->at->get_end_of_samples() == 0)
+    QString key = "";
+    if (this->analysis.data() != nullptr)
     {
-        return false;
+        // Check if there are decoded mono audio data.
+        if (this->analysis->get_nb_samples() == 0)
+        {
+            return false;
+        }
+
+        // Compute the musical key.
+        key = kfinder_get_key((short signed int *)this->analysis->get_short_samples(),
+                              this->analysis->get_nb_samples(),
+                              this->analysis->get_sample_rate(),
+                              1);
+    }
+    else
+    {
+        // Check if there are decoded audio data in audio track.
+        if ((this->at.data() == nullptr) || (this->at->get_end_of_samples() == 0))
+        {
+            return false;
+        }
+
+        // Compute the musical key.
+        key = kfinder_get_key(at->get_samples(),
+                              at->get_end_of_samples(),
+                              at->get_sample_rate(),
+                              2);
     }
 
-    // Compute the musical key.
-    QString key = kfinder_get_key(at->get_samples(),
-                                  at->get_end_of_samples(),
-                                  at->get_sample_rate(),
-                                  2);
     if (key != "")
     {
         // Transform music key to a clock number.
-        key = Utils::convert_music_key_to_clock_number(key);
+        this->music_key = Utils::convert_music_key_to_clock_number(key);
 
         // Set music key to the audio track.
-        this->at->set_music_key(key);
+        if (this->at.data() != nullptr)
+        {
+            this->at->set_music_key(this->music_key);
+        }
     }
     else
     {
-        qCWarning(DS_MUSICKEY) << "no music key found" << this->at->get_path();
+        qCWarning(DS_MUSICKEY) << "no music key found";
         return false;
     }
 
     return true;
 }
+
+QString
+Audio_track_key_process::get_music_key()
+{
+    return this->music_key;
+}
@@ -0,0 +1,312 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                           Digital Scratch Player                           */
+/*                                                                            */
+/*                                                                            */
+/*-----------------------------------------------( audio_track_overview.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*    Data class: multi-resolution summary (min/max/rms) of an audio track    */
+/*                                                                            */
+/*============================================================================*/
+
+
+#include <climits>
+#include <stdint.h>
+#include <cmath>
+#include <algorithm>
+#include <QDataStream>
+
+#include "tracks/audio_track_overview.h"
+
+Audio_track_overview::Audio_track_overview(const unsigned int &max_nb_frames)
+{
+    // Allocate all levels for the biggest possible track.
+    for (unsigned short int l = 0; l < OVERVIEW_NB_LEVELS; l++)
+    {
+        this->levels[l].resize(max_nb_frames / this->get_bin_size(l) + 1);
+    }
+    this->reset();
+
+    return;
+}
+
+Audio_track_overview::~Audio_track_overview()
+{
+    return;
+}
+
+void
+Audio_track_overview::reset()
+{
+    for (unsigned short int l = 0; l < OVERVIEW_NB_LEVELS; l++)
+    {
+        this->nb_bins[l] = 0;
+    }
+    this->nb_frames = 0;
+
+    return;
+}
+
+void
+Audio_track_overview::compute(const short signed int   *samples,
+                              const unsigned int       &nb_frames,
+                              const unsigned short int &nb_channels)
+{
+    // Most detailed level: the only pass over the samples. The inner loop has
+    // no branch and only local accumulators, so the compiler can vectorize it.
+    unsigned int  nb_bins = std::min((nb_frames + OVERVIEW_BASE_BIN_SIZE - 1) / OVERVIEW_BASE_BIN_SIZE,
+                                     (unsigned int)this->levels[0].size());
+    Overview_bin *bins    = this->levels[0].data();
+    for (unsigned int b = 0; b < nb_bins; b++)
+    {
+        const short signed int *bin_samples = samples + b * OVERVIEW_BASE_BIN_SIZE * nb_channels;
+        unsigned int            nb_samples  = std::min((unsigned int)OVERVIEW_BASE_BIN_SIZE,
+                                                       nb_frames - b * OVERVIEW_BASE_BIN_SIZE) * nb_channels;
+        int                     min         = SHRT_MAX;
+        int                     max         = SHRT_MIN;
+        int64_t                 sum         = 0;
+        for (unsigned int i = 0; i < nb_samples; i++)
+        {
+            int value = bin_samples[i];
+            min  = std::min(min, value);
+            max  = std::max(max, value);
+            sum += value * value;
+        }
+        bins[b].min = min;
+        bins[b].max = max;
+        bins[b].rms = sqrt((double)sum / nb_samples);
+    }
+    this->nb_bins[0] = nb_bins;
+    this->nb_frames  = std::min(nb_frames, nb_bins * OVERVIEW_BASE_BIN_SIZE);
+
+    // Next levels are computed from the previous one.
+    this->compute_levels();
+
+    return;
+}
+
+static void
+l_merge_bins(const Overview_bin *bins,
+             const unsigned int &first,
+             const unsigned int &last,
+             Overview_bin       &out_bin)
+{
+    // Peaks are kept, rms is the one of all merged samples (bins have about the same size).
+    int    min = SHRT_MAX;
+    int    max = SHRT_MIN;
+    double sum = 0.0;
+    for (unsigned int i = first; i < last; i++)
+    {
+        min  = std::min(min, (int)bins[i].min);
+        max  = std::max(max, (int)bins[i].max);
+        sum += (double)bins[i].rms * bins[i].rms;
+    }
+    out_bin.min = min;
+    out_bin.max = max;
+    out_bin.rms = sqrt(sum / (last - first));
+
+    return;
+}
+
+static void
+l_get_merged_range(const unsigned int &bin,              // Range of source bins covering a destination bin.
+                   const double       &nb_src_per_dst,
+                   const unsigned int &nb_src,
+                   unsigned int       &out_first,
+                   unsigned int       &out_last)
+{
+    out_first = std::min((unsigned int)floor(bin * nb_src_per_dst), nb_src - 1);
+    out_last  = std::min((unsigned int)ceil((bin + 1) * nb_src_per_dst), nb_src);
+    out_last  = std::max(out_last, out_first + 1);
+
+    return;
+}
+
+void
+Audio_track_overview::compute_levels()
+{
+    for (unsigned short int l = 1; l < OVERVIEW_NB_LEVELS; l++)
+    {
+        const Overview_bin *previous    = this->levels[l - 1].constData();
+        unsigned int        nb_previous = this->nb_bins[l - 1];
+        unsigned int        nb_bins     = std::min((nb_previous + OVERVIEW_LEVEL_FACTOR - 1) / OVERVIEW_LEVEL_FACTOR,
+                                                   (unsigned int)this->levels[l].size());
+        Overview_bin       *bins        = this->levels[l].data();
+        for (unsigned int b = 0; b < nb_bins; b++)
+        {
+            unsigned int first = b * OVERVIEW_LEVEL_FACTOR;
+            l_merge_bins(previous, first, std::min(first + OVERVIEW_LEVEL_FACTOR, nb_previous), bins[b]);
+        }
+        this->nb_bins[l] = nb_bins;
+    }
+
+    return;
+}
+
+unsigned int
+Audio_track_overview::get_bin_size(const unsigned short int &level) const
+{
+    unsigned int size = OVERVIEW_BASE_BIN_SIZE;
+    for (unsigned short int l = 0; l < level; l++)
+    {
+        size *= OVERVIEW_LEVEL_FACTOR;
+    }
+
+    return size;
+}
+
+unsigned int
+Audio_track_overview::get_nb_bins(const unsigned short int &level) const
+{
+    if (level >= OVERVIEW_NB_LEVELS)
+    {
+        return 0;
+    }
+
+    return this->nb_bins[level];
+}
+
+const Overview_bin *
+Audio_track_overview::get_bins(const unsigned short int &level) const
+{
+    if (level >= OVERVIEW_NB_LEVELS)
+    {
+        return nullptr;
+    }
+
+    return this->levels[level].constData();
+}
+
+unsigned short int
+Audio_track_overview::get_level(const unsigned int &nb_frames_per_pixel) const
+{
+    for (unsigned short int l = OVERVIEW_NB_LEVELS - 1; l > 0; l--)
+    {
+        if (this->get_bin_size(l) <= nb_frames_per_pixel)
+        {
+            return l;
+        }
+    }
+
+    return 0;
+}
+
+bool
+Audio_track_overview::to_byte_array(const unsigned int &sample_rate,
+                                    QByteArray         &out_data) const
+{
+    if ((this->nb_bins[0] == 0) || (sample_rate == 0))
+    {
+        return false;
+    }
+
+    // Merge most detailed bins in bins of OVERVIEW_STORED_BIN_MS, and keep
+    // 8 bits per value (enough to draw it). Peaks are rounded outwards.
+    double       nb_bins_per_stored = OVERVIEW_STORED_BIN_MS * sample_rate / 1000.0 / OVERVIEW_BASE_BIN_SIZE;
+    unsigned int nb_stored          = ceil(this->nb_bins[0] / nb_bins_per_stored);
+    QByteArray   mins(nb_stored, 0);
+    QByteArray   maxs(nb_stored, 0);
+    QByteArray   rms(nb_stored, 0);
+    for (unsigned int b = 0; b < nb_stored; b++)
+    {
+        unsigned int first = 0;
+        unsigned int last  = 0;
+        Overview_bin bin;
+        l_get_merged_range(b, nb_bins_per_stored, this->nb_bins[0], first, last);
+        l_merge_bins(this->levels[0].constData(), first, last, bin);
+        mins[b] = (qint8)(bin.min >> 8);
+        maxs[b] = (qint8)std::min((bin.max + 255) >> 8, (int)SCHAR_MAX);
+        rms[b]  = (quint8)std::min((bin.rms + 127) >> 7, (int)UCHAR_MAX);
+    }
+
+    // Header (format version, sample rate and nb of summarized frames, stored bins) in
+    // little endian, followed by each value of all bins (similar values compress better).
+    QByteArray  data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << (quint8)OVERVIEW_DATA_VERSION << (quint32)sample_rate << (quint32)this->nb_frames
+           << (quint16)OVERVIEW_STORED_BIN_MS << (quint32)nb_stored;
+    stream.writeRawData(mins.constData(), nb_stored);
+    stream.writeRawData(maxs.constData(), nb_stored);
+    stream.writeRawData(rms.constData(),  nb_stored);
+    out_data = qCompress(data, 1);
+
+    return true;
+}
+
+bool
+Audio_track_overview::from_byte_array(const QByteArray   &data,
+                                      const unsigned int &sample_rate)
+{
+    QByteArray  raw_data = qUncompress(data);
+    QDataStream stream(raw_data);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    // Check header.
+    quint8  version   = 0;
+    quint32 data_rate = 0;
+    quint32 nb_frames = 0;
+    quint16 bin_ms    = 0;
+    quint32 nb_stored = 0;
+    stream >> version >> data_rate >> nb_frames >> bin_ms >> nb_stored;
+    if ((version != OVERVIEW_DATA_VERSION) || (data_rate == 0) || (bin_ms == 0) || (nb_stored == 0) ||
+        (stream.status() != QDataStream::Ok) ||
+        (raw_data.size() - stream.device()->pos() != 3 * (qint64)nb_stored))
+    {
+        return false;
+    }
+    const qint8  *mins = (const qint8 *)raw_data.constData() + stream.device()->pos();
+    const qint8  *maxs = mins + nb_stored;
+    const quint8 *rms  = (const quint8 *)(maxs + nb_stored);
+
+    // Most detailed level (for the current sample rate) is built from stored bins.
+    this->nb_frames  = std::min((quint64)nb_frames * sample_rate / data_rate,
+                                (quint64)this->levels[0].size() * OVERVIEW_BASE_BIN_SIZE);
+    this->nb_bins[0] = (this->nb_frames + OVERVIEW_BASE_BIN_SIZE - 1) / OVERVIEW_BASE_BIN_SIZE;
+    double nb_stored_per_bin = (double)OVERVIEW_BASE_BIN_SIZE * 1000.0 / sample_rate / bin_ms;
+    Overview_bin *bins = this->levels[0].data();
+    for (unsigned int b = 0; b < this->nb_bins[0]; b++)
+    {
+        unsigned int first = 0;
+        unsigned int last  = 0;
+        int          min   = SCHAR_MAX;
+        int          max   = SCHAR_MIN;
+        double       sum   = 0.0;
+        l_get_merged_range(b, nb_stored_per_bin, nb_stored, first, last);
+        for (unsigned int i = first; i < last; i++)
+        {
+            min  = std::min(min, (int)mins[i]);
+            max  = std::max(max, (int)maxs[i]);
+            sum += (double)rms[i] * rms[i];
+        }
+        bins[b].min = min * 256;
+        bins[b].max = std::min(max * 256, (int)SHRT_MAX);
+        bins[b].rms = std::min(sqrt(sum / (last - first)) * 128.0, (double)SHRT_MAX);
+    }
+
+    // Next levels are computed from it.
+    this->compute_levels();
+
+    return true;
+}
@@ -33,6 +33,7 @@
 #include <QtDebug>
 #include <QSqlError>
 #include <QFileInfo>
+#include <QFile>
 #include <QDir>
 #include <QSqlQuery>
 #include <QDateTime>
@@ -45,30 +46,41 @@
 
 Data_persistence::Data_persistence() // FIXME: rename to Audio_track_persistence ?
 {
-    this->is_initialized = this->init_db();
+    this->cache.setMaxCost(DB_CACHE_MAX_TRACKS);
+    this->cache_generation = 0;
+    this->has_search_index = false;
+    this->has_upsert       = false;
+    this->db_generation.store(0);
+    this->is_initialized   = this->init_db();
 
     return;
 }
 
 Data_persistence::~Data_persistence()
 {
-    this->mutex.lock();
-    if (this->db.isValid() == true)
-    {
-        this->db.close();
-    }
-    this->mutex.unlock();
+    this->flush_audio_tracks();
+
+    // Close the connection of the current thread (other ones are closed when their thread finishes).
+    this->connections.setLocalData(nullptr);
 
     return;
 }
 
+Db_connection::~Db_connection()
+{
+    // Statements must be released before the connection is removed.
+    QString name = this->db.connectionName();
+    this->queries.clear();
+    this->db.close();
+    this->db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(name);
+}
+
 bool Data_persistence::init_db()
 {
-    // Create DB.
-    this->mutex.lock();
-    this->db = QSqlDatabase::addDatabase("QSQLITE");
+    // Get DB file.
     QFileInfo path_info(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/digitalscratch.sqlite");
-    this->db.setDatabaseName(path_info.absoluteFilePath());
+    this->db_path = path_info.absoluteFilePath();
 
     // Make sure path exists, if not create it.
     QDir dir;
@@ -80,31 +92,42 @@ bool Data_persistence::init_db()
 #endif
 
     // Open DB.
-    if (this->db.open() == false)
+    this->mutex.lock();
+    if (this->get_db().isOpen() == false)
     {
-        qCWarning(DS_DB) << "cannot open DB:" << this->db.lastError().text();
+        this->mutex.unlock();
         return false;
     }
-    else
+
+    // Readers do not block the writer (and vice versa), setting is kept in the DB file.
+    QSqlQuery query(this->get_db());
+    if ((query.exec("PRAGMA journal_mode = WAL") == false) ||
+        (query.next() == false) ||
+        (query.value(0).toString() != "wal"))
     {
-        // Enable foreign key support.
-        QSqlQuery query;
-        if (query.exec("PRAGMA foreign_keys = ON") == false)
-        {
-            return false;
-        }
+        qCWarning(DS_DB) << "can not enable WAL journal mode, concurrent readers will wait for writers";
+    }
+    query.finish();
 
-        // Disable wait on write (on hdd).
-        if (query.exec("PRAGMA synchronous = OFF") == false)
-        {
-            return false;
-        }
+    // Upsert needs SQLite 3.24, with an older version rows are inserted then updated.
+    this->has_upsert = false;
+    if ((query.exec("SELECT sqlite_version()") == true) && (query.next() == true))
+    {
+        QStringList version = query.value(0).toString().split('.');
+        this->has_upsert = (version.value(0).toInt() > 3) ||
+                           ((version.value(0).toInt() == 3) && (version.value(1).toInt() >= 24));
+    }
+    query.finish();
+    if (this->has_upsert == false)
+    {
+        qCDebug(DS_DB) << "SQLite version does not support upsert, use insert then update";
     }
 
     // Create DB structure if needed.
     if (this->create_db_structure() == false)
     {
         qCWarning(DS_DB) << "creating base DB structure failed";
+        this->mutex.unlock();
         return false;
     }
 
@@ -113,10 +136,82 @@ bool Data_persistence::init_db()
     return true;
 }
 
+QSqlDatabase &Data_persistence::get_db()
+{
+    // Each thread has its own connection, open it the first time (or again if DB file was replaced).
+    if ((this->connections.hasLocalData() == true) &&
+        (this->connections.localData()->generation != this->db_generation.load()))
+    {
+        this->connections.setLocalData(nullptr);
+    }
+    if (this->connections.hasLocalData() == false)
+    {
+        Db_connection *connection = new Db_connection;
+        connection->generation = this->db_generation.load();
+        connection->db = QSqlDatabase::addDatabase("QSQLITE", QString("digitalscratch_%1").arg((quintptr)connection));
+        connection->db.setDatabaseName(this->db_path);
+        if (connection->db.open() == false)
+        {
+            // Do not keep it, next call will try again.
+            qCWarning(DS_DB) << "cannot open DB:" << connection->db.lastError().text();
+            delete connection;
+            return this->closed_db;
+        }
+
+        // Enable foreign key support, disable wait on write (on hdd)
+        // and wait for the other connections instead of failing when DB is locked.
+        QSqlQuery query(connection->db);
+        if ((query.exec("PRAGMA foreign_keys = ON")  == false) ||
+            (query.exec("PRAGMA synchronous = OFF")  == false) ||
+            (query.exec("PRAGMA busy_timeout = " + QString::number(DB_BUSY_TIMEOUT_MS)) == false))
+        {
+            qCWarning(DS_DB) << "can not setup DB connection:" << query.lastError().text();
+        }
+        query.finish();
+        this->connections.setLocalData(connection);
+    }
+
+    return this->connections.localData()->db;
+}
+
+#ifdef ENABLE_TEST_MODE
+bool Data_persistence::reset_db()
+{
+    // Drop tracks waiting to be written and cached data.
+    this->pending_mutex.lock();
+    this->pending_tracks.clear();
+    this->pending_mutex.unlock();
+    this->clear_cache();
+
+    // Close connection of this thread, other threads open a new one the next time they use the DB.
+    this->mutex.lock();
+    this->connections.setLocalData(nullptr);
+    this->db_generation.fetchAndAddRelaxed(1);
+    QFile::remove(this->db_path);
+    QFile::remove(this->db_path + "-wal");
+    QFile::remove(this->db_path + "-shm");
+    this->has_search_index = false;
+    this->mutex.unlock();
+
+    // Create an empty DB.
+    this->is_initialized = this->init_db();
+
+    return this->is_initialized;
+}
+
+bool Data_persistence::set_has_upsert(const bool &has_upsert)
+{
+    bool previous = this->has_upsert;
+    this->has_upsert = has_upsert;
+
+    return previous;
+}
+#endif
+
 #ifndef ENABLE_TEST_MODE
 void Data_persistence::backup_db()
 {
-    QFileInfo db_file(this->db.databaseName());
+    QFileInfo db_file(this->db_path);
     QString db_dir(db_file.absolutePath());
     QString db_name(db_file.fileName());
     QString timestamp(QDateTime::currentDateTime().toString("yyyyMMdd-HH:mm:ss"));
@@ -131,6 +226,16 @@ void Data_persistence::backup_db()
 
         if (dir.cd(db_backup_dir) == true)
         {
+            // Move changes still in the WAL file (e.g. after a crash) into the DB file, otherwise they are not in the copy.
+            if (this->get_db().isOpen() == true)
+            {
+                QSqlQuery query(this->get_db());
+                if (query.exec("PRAGMA wal_checkpoint(TRUNCATE)") == false)
+                {
+                    qCWarning(DS_DB) << "can not checkpoint WAL file before backup:" << query.lastError().text();
+                }
+            }
+
             // Backup the DB file: duplicate it and prefix the name with date/time.
             QFile::copy(db_file.absoluteFilePath(), db_backup_dir + QDir::separator() + db_backup_name);
 
@@ -154,9 +259,9 @@ bool Data_persistence::create_db_structure()
     bool result = true;
 
     // Create DB structure
-    if (this->db.isOpen() == true)
+    if (this->get_db().isOpen() == true)
     {
-        QSqlQuery query;
+        QSqlQuery query(this->get_db());
 
         // Create TRACK table
         result = query.exec("CREATE TABLE IF NOT EXISTS \"TRACK\" "
@@ -166,7 +271,34 @@ bool Data_persistence::create_db_structure()
                             " \"key\" VARCHAR, "
                             " \"key_tag\" VARCHAR, "
                             " \"path\" VARCHAR, "
-                            " \"filename\" VARCHAR);");
+                            " \"filename\" VARCHAR, "
+                            " \"first_beat\" INTEGER, "
+                            " \"key_code\" INTEGER);");
+
+        // Add columns which did not exist in previous versions.
+        if (result == true)
+        {
+            result = this->add_column_if_missing("TRACK", "first_beat", "INTEGER");
+        }
+        if (result == true)
+        {
+            result = this->add_column_if_missing("TRACK", "key_code", "INTEGER");
+        }
+
+        // Compute key code (see Utils::get_music_key_code()) of tracks stored by previous versions.
+        if (result == true)
+        {
+            result = query.exec("UPDATE TRACK SET key_code = CAST(substr(key, 1, 2) AS INTEGER) - 1 + "
+                                "(CASE substr(key, 3, 1) WHEN 'B' THEN 12 ELSE 0 END) "
+                                "WHERE key_code IS NULL AND length(key) = 3 AND substr(key, 3, 1) IN ('A', 'B') "
+                                "AND CAST(substr(key, 1, 2) AS INTEGER) BETWEEN 1 AND 12;");
+        }
+
+        // Add an index on TRACK.key_code to get tracks of compatible keys.
+        if (result == true)
+        {
+            result = query.exec("CREATE INDEX IF NOT EXISTS index_TRACK_key_code on TRACK (key_code);");
+        }
 
         // Add an index on TRACK.hash which will be the main key to search a track.
         if (result == true)
@@ -204,6 +336,64 @@ bool Data_persistence::create_db_structure()
                                 " FOREIGN KEY(id_track) REFERENCES TRACK(id_track), "
                                 " FOREIGN KEY(id_tag) REFERENCES TAG(id_tag));");
         }
+
+        // Create TRACK_ANALYSIS table (binary results of track analysis, identified by hash of the file).
+        if (result == true)
+        {
+            result = query.exec("CREATE TABLE IF NOT EXISTS \"TRACK_ANALYSIS\" "
+                                "(\"id_analysis\" INTEGER PRIMARY KEY  AUTOINCREMENT  NOT NULL  UNIQUE , "
+                                " \"hash\" VARCHAR NOT NULL , "
+                                " \"type\" VARCHAR NOT NULL , "
+                                " \"data\" BLOB);");
+        }
+        if (result == true)
+        {
+            result = query.exec("CREATE UNIQUE INDEX IF NOT EXISTS index_TRACK_ANALYSIS_hash_type on TRACK_ANALYSIS (hash, type);");
+        }
+
+        // Create FILE_INDEX table (hash of files identified by path, size and modification time).
+        if (result == true)
+        {
+            result = query.exec("CREATE TABLE IF NOT EXISTS \"FILE_INDEX\" "
+                                "(\"id_file\" INTEGER PRIMARY KEY  AUTOINCREMENT  NOT NULL  UNIQUE , "
+                                " \"path\" VARCHAR NOT NULL , "
+                                " \"size\" INTEGER NOT NULL , "
+                                " \"mtime\" INTEGER NOT NULL , "
+                                " \"hash\" VARCHAR NOT NULL);");
+        }
+        if (result == true)
+        {
+            result = query.exec("CREATE UNIQUE INDEX IF NOT EXISTS index_FILE_INDEX_path on FILE_INDEX (path);");
+        }
+        if (result == true)
+        {
+            result = query.exec("CREATE INDEX IF NOT EXISTS index_FILE_INDEX_hash on FILE_INDEX (hash);");
+        }
+
+        // Remove analysis of a track when it is deleted, or when no indexed file has its hash anymore.
+        if (result == true)
+        {
+            result = query.exec("CREATE TRIGGER IF NOT EXISTS TRACK_ANALYSIS_track_delete AFTER DELETE ON TRACK BEGIN "
+                                "DELETE FROM TRACK_ANALYSIS WHERE hash = old.hash; END;");
+        }
+        if (result == true)
+        {
+            result = query.exec("CREATE TRIGGER IF NOT EXISTS TRACK_ANALYSIS_file_delete AFTER DELETE ON FILE_INDEX "
+                                "WHEN NOT EXISTS (SELECT 1 FROM FILE_INDEX WHERE hash = old.hash) BEGIN "
+                                "DELETE FROM TRACK_ANALYSIS WHERE hash = old.hash; END;");
+        }
+        if (result == true)
+        {
+            result = query.exec("CREATE TRIGGER IF NOT EXISTS TRACK_ANALYSIS_file_update AFTER UPDATE OF hash ON FILE_INDEX "
+                                "WHEN old.hash <> new.hash AND NOT EXISTS (SELECT 1 FROM FILE_INDEX WHERE hash = old.hash) BEGIN "
+                                "DELETE FROM TRACK_ANALYSIS WHERE hash = old.hash; END;");
+        }
+
+        // Create full-text search index of files (not mandatory, search is slower without it).
+        if (result == true)
+        {
+            this->has_search_index = this->create_search_index();
+        }
     }
     else
     {
@@ -215,9 +405,134 @@ bool Data_persistence::create_db_structure()
     return result;
 }
 
-bool Data_persistence::rollback_transaction()
+// Columns of the search index for files of FILE_INDEX (aliased F): file name, directory, tags and key of the track.
+#define SEARCH_INDEX_ROWS "SELECT F.id_file, " \
+                          "replace(F.path, rtrim(F.path, replace(F.path, '/', '')), ''), " \
+                          "rtrim(F.path, replace(F.path, '/', '')), " \
+                          "coalesce((SELECT group_concat(TAG.name, ' ') FROM TRACK " \
+                                    "JOIN TRACK_TAG ON TRACK_TAG.id_track = TRACK.id_track " \
+                                    "JOIN TAG ON TAG.id_tag = TRACK_TAG.id_tag " \
+                                    "WHERE TRACK.hash = F.hash), ''), " \
+                          "coalesce((SELECT key FROM TRACK WHERE TRACK.hash = F.hash), '') " \
+                          "FROM FILE_INDEX F "
+
+static QString
+search_index_update(const QString &condition)
+{
+    // Index again files matching the condition on FILE_INDEX (aliased F).
+    return "DELETE FROM FILE_SEARCH WHERE rowid IN (SELECT F.id_file FROM FILE_INDEX F WHERE " + condition + "); "
+           "INSERT INTO FILE_SEARCH (rowid, filename, path, tags, key) " SEARCH_INDEX_ROWS "WHERE " + condition + "; ";
+}
+
+bool Data_persistence::create_search_index()
+{
+    QSqlQuery query(this->get_db());
+
+    // The index is filled when it is created, then triggers keep it up to date.
+    bool is_new = (query.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name = 'FILE_SEARCH'") == true) &&
+                  (query.next() == false);
+    query.finish();
+
+    // Trigram tokenizer: match any part of words (at least 3 characters), not only their beginning.
+    if (query.exec("CREATE VIRTUAL TABLE IF NOT EXISTS FILE_SEARCH USING fts5(filename, path, tags, key, tokenize = 'trigram')") == false)
+    {
+        qCWarning(DS_DB) << "can not create search index (FTS5 not available ?): " << query.lastError().text();
+        return false;
+    }
+
+    QStringList triggers;
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_file_insert AFTER INSERT ON FILE_INDEX BEGIN " +
+                search_index_update("F.id_file = new.id_file") + "END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_file_update AFTER UPDATE ON FILE_INDEX BEGIN "
+                "DELETE FROM FILE_SEARCH WHERE rowid = old.id_file; " +
+                search_index_update("F.id_file = new.id_file") + "END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_file_delete AFTER DELETE ON FILE_INDEX BEGIN "
+                "DELETE FROM FILE_SEARCH WHERE rowid = old.id_file; END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_track_insert AFTER INSERT ON TRACK BEGIN " +
+                search_index_update("F.hash = new.hash") + "END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_track_update AFTER UPDATE OF key ON TRACK BEGIN " +
+                search_index_update("F.hash = new.hash") + "END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_track_tag_insert AFTER INSERT ON TRACK_TAG BEGIN " +
+                search_index_update("F.hash = (SELECT hash FROM TRACK WHERE id_track = new.id_track)") + "END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_track_tag_delete AFTER DELETE ON TRACK_TAG BEGIN " +
+                search_index_update("F.hash = (SELECT hash FROM TRACK WHERE id_track = old.id_track)") + "END;";
+    triggers << "CREATE TRIGGER IF NOT EXISTS FILE_SEARCH_tag_update AFTER UPDATE OF name ON TAG BEGIN " +
+                search_index_update("F.hash IN (SELECT TRACK.hash FROM TRACK "
+                                    "JOIN TRACK_TAG ON TRACK_TAG.id_track = TRACK.id_track "
+                                    "WHERE TRACK_TAG.id_tag = new.id_tag)") + "END;";
+    foreach (const QString &trigger, triggers)
+    {
+        if (query.exec(trigger) == false)
+        {
+            qCWarning(DS_DB) << "can not create search index trigger: " << query.lastError().text();
+            return false;
+        }
+    }
+
+    // Index files already known.
+    if ((is_new == true) &&
+        (query.exec("INSERT INTO FILE_SEARCH (rowid, filename, path, tags, key) " SEARCH_INDEX_ROWS) == false))
+    {
+        qCWarning(DS_DB) << "can not fill search index: " << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool Data_persistence::add_column_if_missing(const QString &table,
+                                             const QString &column,
+                                             const QString &type)
+{
+    // Check if the column already exists.
+    QSqlQuery query(this->get_db());
+    if (query.exec("PRAGMA table_info(" + table + ")") == false)
+    {
+        qCWarning(DS_DB) << "can not get structure of table" << table << ":" << query.lastError().text();
+        return false;
+    }
+    while (query.next() == true)
+    {
+        if (query.value(1).toString() == column)
+        {
+            return true;
+        }
+    }
+
+    // Column is missing, add it.
+    if (query.exec("ALTER TABLE \"" + table + "\" ADD COLUMN \"" + column + "\" " + type) == false)
+    {
+        qCWarning(DS_DB) << "can not add column" << column << "to table" << table << ":" << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+QSqlQuery &Data_persistence::get_query(const QString &sql)
 {
-    return this->db.rollback();
+    // Prepare the statement only once (for the connection of the current thread), then it is only bound and executed.
+    QSqlDatabase &db = this->get_db();
+    if (this->connections.hasLocalData() == false)
+    {
+        // No connection: this query only fails.
+        static thread_local QSqlQuery closed_query(this->closed_db);
+        return closed_query;
+    }
+    QHash<QString, QSharedPointer<QSqlQuery>> &queries = this->connections.localData()->queries;
+    QSharedPointer<QSqlQuery> query = queries.value(sql);
+    if (query.isNull() == true)
+    {
+        query = QSharedPointer<QSqlQuery>(new QSqlQuery(db));
+        query->setForwardOnly(true);
+        if (query->prepare(sql) == false)
+        {
+            qCWarning(DS_DB) << "can not prepare query (" << query->lastError().text() << ") " << sql;
+        }
+        queries.insert(sql, query);
+    }
+
+    return *query;
 }
 
 bool Data_persistence::store_audio_track(const QSharedPointer<Audio_track> &at)
@@ -236,61 +551,22 @@ bool Data_persistence::store_audio_track(const QSharedPointer<Audio_track> &at)
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
+        // Queued tracks first, so they do not overwrite this one later.
+        this->flush_audio_tracks();
+
+        Track_metadata track;
+        track.hash          = at->get_hash();
+        track.music_key     = at->get_music_key();
+        track.music_key_tag = at->get_music_key_tag();
+        track.bpm           = at->get_bpm();
+        track.first_beat    = at->get_first_beat();
+        track.fullpath      = at->get_fullpath();
+
+        // Only one writer at a time.
         this->mutex.lock();
+        result = this->upsert_audio_tracks(QList<Track_metadata>() << track);
 
-        // Try to get audio track from Db.
-        QSqlQuery query = this->db.exec("SELECT id_track, path, filename, key, key_tag FROM TRACK WHERE hash=\"" + at->get_hash() + "\"");
-        if (query.lastError().isValid())
-        {
-            qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
-            result = false;
-        }
-        else if (query.next() == true) // Check if there is a record.
-        {
-            // An audio track with same hash already exists, update it if at least one element changed.
-            if ((query.value(1) != at->get_path()) ||
-                (query.value(2) != at->get_filename()) ||
-                (query.value(3) != at->get_music_key()) ||
-                (query.value(4) != at->get_music_key_tag()))
-            {
-                int existing_id = query.value(0).toInt();
-                query.prepare("UPDATE TRACK SET path = :path, filename = :filename, key = :key, key_tag = :key_tag "
-                              "WHERE id_track = :id_track");
-                query.bindValue(":path",     at->get_path());
-                query.bindValue(":filename", at->get_filename());
-                query.bindValue(":key",      at->get_music_key());
-                query.bindValue(":key_tag",  at->get_music_key_tag());
-                query.bindValue(":id_track", QString::number(existing_id));
-                query.exec();
-
-                if (query.lastError().isValid())
-                {
-                    qCWarning(DS_DB) << "UPDATE track failed: " << query.lastError().text();
-                    result = false;
-                }
-            }
-        }
-        else
-        {
-            // No existing audio track found, insert it in DB.
-            query.prepare("INSERT INTO TRACK (hash, path, filename, key, key_tag) "
-                          "VALUES (:hash, :path, :filename, :key, :key_tag)");
-            query.bindValue(":hash",     at->get_hash());
-            query.bindValue(":path",     at->get_path());
-            query.bindValue(":filename", at->get_filename());
-            query.bindValue(":key",      at->get_music_key());
-            query.bindValue(":key_tag",  at->get_music_key_tag());
-            query.exec();
-
-            if (query.lastError().isValid())
-            {
-                qCWarning(DS_DB) << "INSERT track failed: " << query.lastError().text();
-                result = false;
-            }
-        }
-
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
     else
@@ -303,270 +579,1133 @@ bool Data_persistence::store_audio_track(const QSharedPointer<Audio_track> &at)
     return result;
 }
 
-bool Data_persistence::get_audio_track(QSharedPointer<Audio_track> &io_at)
+bool Data_persistence::queue_audio_track(const Track_metadata &track)
+{
+    // Check input parameter.
+    if (track.hash.size() == 0)
+    {
+        return false;
+    }
+
+    // Queue the track, write the queue if it is full.
+    this->pending_mutex.lock();
+    this->pending_tracks << track;
+    bool is_full = this->pending_tracks.size() >= DB_WRITE_BATCH_SIZE;
+    this->pending_mutex.unlock();
+
+    if (is_full == true)
+    {
+        return this->flush_audio_tracks();
+    }
+
+    return true;
+}
+
+bool Data_persistence::flush_audio_tracks()
+{
+    // Get queued tracks.
+    QList<Track_metadata> tracks;
+    this->pending_mutex.lock();
+    tracks.swap(this->pending_tracks);
+    this->pending_mutex.unlock();
+
+    if (tracks.isEmpty() == true)
+    {
+        return true;
+    }
+    if (this->is_initialized == false)
+    {
+        return false;
+    }
+
+    // Only one writer at a time.
+    this->mutex.lock();
+    bool result = this->upsert_audio_tracks(tracks);
+
+    // Release the writer lock.
+    this->mutex.unlock();
+
+    return result;
+}
+
+bool Data_persistence::upsert_audio_tracks(const QList<Track_metadata> &tracks)
 {
     // Init result.
     bool result = true;
 
-    // Check input parameter.
-    if ((io_at.data() == nullptr) ||
-        (io_at->get_hash().size() == 0))
+    // One prepared statement for all tracks: insert it, or update it if it exists and at least one element changed.
+    // Without upsert (old SQLite): insert it if it does not exist, then update it.
+    this->get_db().transaction();
+    QList<QSqlQuery*> queries;
+    if (this->has_upsert == true)
     {
-        qCWarning(DS_DB) << "can not get audio track: hash not specified.";
-        result = false;
+        queries << &this->get_query("INSERT INTO TRACK (hash, path, filename, key, key_code, key_tag, bpm, first_beat) "
+                                    "VALUES (:hash, :path, :filename, :key, :key_code, :key_tag, :bpm, :first_beat) "
+                                    "ON CONFLICT(hash) DO UPDATE SET path = excluded.path, filename = excluded.filename, "
+                                    "key = excluded.key, key_code = excluded.key_code, key_tag = excluded.key_tag, "
+                                    "bpm = excluded.bpm, first_beat = excluded.first_beat "
+                                    "WHERE path IS NOT excluded.path OR filename IS NOT excluded.filename OR "
+                                    "key IS NOT excluded.key OR key_tag IS NOT excluded.key_tag OR "
+                                    "bpm IS NOT excluded.bpm OR first_beat IS NOT excluded.first_beat");
+    }
+    else
+    {
+        queries << &this->get_query("INSERT OR IGNORE INTO TRACK (hash, path, filename, key, key_code, key_tag, bpm, first_beat) "
+                                    "VALUES (:hash, :path, :filename, :key, :key_code, :key_tag, :bpm, :first_beat)")
+                << &this->get_query("UPDATE TRACK SET path = :path, filename = :filename, key = :key, key_code = :key_code, "
+                                    "key_tag = :key_tag, bpm = :bpm, first_beat = :first_beat WHERE hash = :hash");
+    }
+    foreach (const Track_metadata &track, tracks)
+    {
+        QFileInfo path_info(track.fullpath);
+        int key_code = Utils::get_music_key_code(track.music_key);
+        foreach (QSqlQuery *query, queries)
+        {
+            query->bindValue(":hash",       track.hash);
+            query->bindValue(":path",       track.fullpath.isEmpty() == true ? "" : path_info.absolutePath());
+            query->bindValue(":filename",   path_info.fileName());
+            query->bindValue(":key",        track.music_key);
+            query->bindValue(":key_code",   key_code >= 0 ? QVariant(key_code) : QVariant(QVariant::Int));
+            query->bindValue(":key_tag",    track.music_key_tag);
+            query->bindValue(":bpm",        track.bpm);
+            query->bindValue(":first_beat", track.first_beat);
+            if (query->exec() == false)
+            {
+                qCWarning(DS_DB) << "INSERT/UPDATE track failed: " << query->lastError().text();
+                result = false;
+                break;
+            }
+        }
+        if (result == false)
+        {
+            break;
+        }
+    }
+    foreach (QSqlQuery *query, queries)
+    {
+        query->finish();
+    }
+    if (result == true)
+    {
+        result = this->get_db().commit();
+    }
+    else
+    {
+        this->get_db().rollback();
     }
 
-    // Search the audio track (based on its hash) in DB.
-    if ((result == true) &&
-        (this->is_initialized == true))
+    // Update cached tracks (as they would be read from DB), drop them if they were not written.
+    this->cache_mutex.lock();
+    this->cache_generation++;
+    foreach (const Track_metadata &track, tracks)
     {
-        // Ensure no other thread can access the DB connection.
-        this->mutex.lock();
+        if (result == true)
+        {
+            QFileInfo path_info(track.fullpath);
+            Track_cache_entry *entry = this->get_cache_entry(track.hash);
+            QStringList tags = entry->track.tags;
+            entry->track          = track;
+            entry->track.fullpath = (track.fullpath.isEmpty() == true ? "" : path_info.absolutePath()) + "/" + path_info.fileName();
+            entry->track.tags     = tags;
+            entry->has_track      = true;
+            entry->track_exists   = true;
+        }
+        else
+        {
+            this->cache.remove(track.hash);
+        }
+    }
+    this->cache_mutex.unlock();
 
-        QSqlQuery query = this->db.exec("SELECT key, key_tag, path, filename FROM TRACK WHERE hash=\"" + io_at->get_hash() + "\"");
-        if (query.lastError().isValid())
+    return result;
+}
+
+Track_cache_entry *Data_persistence::get_cache_entry(const QString &hash)
+{
+    Track_cache_entry *entry = this->cache.object(hash);
+    if (entry == nullptr)
+    {
+        entry = new Track_cache_entry;
+        this->cache.insert(hash, entry, 1);
+    }
+
+    return entry;
+}
+
+void Data_persistence::set_cached_track(const QString        &hash,
+                                        const Track_metadata *track,
+                                        const quint64        &generation)
+{
+    // Do not cache data read before a write (it could be outdated).
+    if (generation == this->cache_generation)
+    {
+        Track_cache_entry *entry = this->get_cache_entry(hash);
+        entry->has_track    = true;
+        entry->has_tags     = true;
+        entry->track_exists = (track != nullptr);
+        entry->track        = (track != nullptr) ? *track : Track_cache_entry().track;
+    }
+}
+
+void Data_persistence::invalidate_cache(const QString &hash)
+{
+    this->cache_mutex.lock();
+    this->cache_generation++;
+    this->cache.remove(hash);
+    this->cache_mutex.unlock();
+}
+
+void Data_persistence::clear_cache()
+{
+    this->cache_mutex.lock();
+    this->cache_generation++;
+    this->cache.clear();
+    this->cache_mutex.unlock();
+}
+
+void Data_persistence::invalidate_cached_tags()
+{
+    // Keep main data of tracks, but read again their tags and positions in tracklists.
+    this->cache_mutex.lock();
+    this->cache_generation++;
+    foreach (const QString &hash, this->cache.keys())
+    {
+        Track_cache_entry *entry = this->cache.object(hash);
+        entry->has_tags = false;
+        entry->track.tags.clear();
+        entry->tag_positions.clear();
+    }
+    this->cache_mutex.unlock();
+}
+
+bool Data_persistence::get_audio_track(QSharedPointer<Audio_track> &io_at)
+{
+    // Init result.
+    bool result = true;
+
+    // Check input parameter.
+    if ((io_at.data() == nullptr) ||
+        (io_at->get_hash().size() == 0))
+    {
+        qCWarning(DS_DB) << "can not get audio track: hash not specified.";
+        result = false;
+    }
+
+    // Search the audio track (based on its hash) in DB.
+    if ((result == true) &&
+        (this->is_initialized == true))
+    {
+        // Queued tracks first.
+        this->flush_audio_tracks();
+
+        // Use cached data if any.
+        Track_metadata track;
+        bool           track_exists = false;
+        this->cache_mutex.lock();
+        Track_cache_entry *entry      = this->cache.object(io_at->get_hash());
+        bool               is_cached  = (entry != nullptr) && (entry->has_track == true) && (entry->has_tags == true);
+        quint64            generation = this->cache_generation;
+        if (is_cached == true)
+        {
+            track        = entry->track;
+            track_exists = entry->track_exists;
+        }
+        this->cache_mutex.unlock();
+
+        if (is_cached == false)
+        {
+            QSqlQuery &query = this->get_query("SELECT key, key_tag, path, filename, bpm, first_beat FROM TRACK WHERE hash = :hash");
+            query.bindValue(":hash", io_at->get_hash());
+            query.exec();
+            if (query.lastError().isValid())
+            {
+                qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
+                result = false;
+            }
+            else if (query.next() == true) // Check if there is a record.
+            {
+                // The audio track exists.
+                track.hash          = io_at->get_hash();
+                track.music_key     = query.value(0).toString();
+                track.music_key_tag = query.value(1).toString();
+                track.fullpath      = query.value(2).toString() + "/" + query.value(3).toString();
+                track.bpm           = query.value(4).toFloat();
+                track.first_beat    = query.value(5).toUInt();
+                track_exists        = true;
+            }
+            query.finish();
+
+            // Get the list of tags associated to that track.
+            if ((result == true) &&
+                (this->get_tags_from_track(io_at, track.tags) == true))
+            {
+                this->cache_mutex.lock();
+                this->set_cached_track(io_at->get_hash(), track_exists == true ? &track : nullptr, generation);
+                this->cache_mutex.unlock();
+            }
+        }
+
+        if (track_exists == true)
+        {
+            // The audio track exists, fill the returned object.
+            io_at->set_music_key(track.music_key);
+            io_at->set_music_key_tag(track.music_key_tag);
+            io_at->set_fullpath(track.fullpath);
+            io_at->set_bpm(track.bpm);
+            io_at->set_first_beat(track.first_beat);
+            io_at->set_tags(track.tags);
+        }
+        else if (result == true)
+        {
+            // Audio track not found.
+            result = false;
+            qCDebug(DS_DB) << "audio track not found in DB, hash: " << io_at->get_hash();
+        }
+    }
+
+    return result;
+}
+
+// Numbers of values bound to IN lists: a few sizes only, so a few prepared statements are reused.
+static const int l_in_list_sizes[] = { 1, 16, DB_MAX_BOUND_VALUES };
+
+static int
+l_get_in_list_size(const int &nb_values)
+{
+    // Smallest size which fits all values (or the biggest one).
+    for (int size : l_in_list_sizes)
+    {
+        if (size >= nb_values)
+        {
+            return size;
+        }
+    }
+
+    return DB_MAX_BOUND_VALUES;
+}
+
+bool Data_persistence::get_audio_tracks(const QStringList              &hashes,
+                                        QHash<QString, Track_metadata> &out_tracks)
+{
+    // Init result.
+    bool result = true;
+    out_tracks.clear();
+
+    if (this->is_initialized == true)
+    {
+        // Queued tracks first.
+        this->flush_audio_tracks();
+
+        // Get cached tracks, only other ones are read from DB.
+        QStringList not_cached;
+        this->cache_mutex.lock();
+        quint64 generation = this->cache_generation;
+        foreach (const QString &hash, hashes)
+        {
+            Track_cache_entry *entry = this->cache.object(hash);
+            if ((entry != nullptr) && (entry->has_track == true) && (entry->has_tags == true))
+            {
+                if (entry->track_exists == true)
+                {
+                    out_tracks.insert(hash, entry->track);
+                }
+            }
+            else
+            {
+                not_cached << hash;
+            }
+        }
+        this->cache_mutex.unlock();
+
+        // Read everything in one transaction, by chunks of hashes.
+        if (not_cached.isEmpty() == false)
+        {
+            this->get_db().transaction();
+        }
+        for (int first = 0; (first < not_cached.size()) && (result == true); first += DB_MAX_BOUND_VALUES)
+        {
+            // Bind one of a few numbers of values (missing ones are NULL) to reuse the same prepared statements.
+            int          size = l_get_in_list_size(not_cached.size() - first);
+            QVariantList chunk;
+            for (int i = first; i < first + size; i++)
+            {
+                chunk << (i < not_cached.size() ? QVariant(not_cached[i]) : QVariant(QVariant::String));
+            }
+            QString placeholders = QString("?,").repeated(size);
+            placeholders.chop(1);
+
+            // Main data of tracks.
+            QSqlQuery &query = this->get_query("SELECT hash, key, key_tag, path, filename, bpm, first_beat FROM TRACK "
+                                               "WHERE hash IN (" + placeholders + ")");
+            foreach (const QVariant &hash, chunk)
+            {
+                query.addBindValue(hash);
+            }
+            if (query.exec() == false)
+            {
+                qCWarning(DS_DB) << "SELECT tracks failed: " << query.lastError().text();
+                result = false;
+                break;
+            }
+            while (query.next() == true)
+            {
+                Track_metadata track;
+                track.hash          = query.value(0).toString();
+                track.music_key     = query.value(1).toString();
+                track.music_key_tag = query.value(2).toString();
+                track.fullpath      = query.value(3).toString() + "/" + query.value(4).toString();
+                track.bpm           = query.value(5).toFloat();
+                track.first_beat    = query.value(6).toUInt();
+                out_tracks.insert(query.value(0).toString(), track);
+            }
+            query.finish();
+
+            // Tags of tracks.
+            QSqlQuery &query_tags = this->get_query("SELECT TRACK.hash, TAG.name FROM TAG "
+                                                    "JOIN TRACK_TAG "
+                                                    "ON TAG.id_tag=TRACK_TAG.id_tag "
+                                                    "JOIN TRACK "
+                                                    "ON TRACK_TAG.id_track=TRACK.id_track "
+                                                    "WHERE TRACK.hash IN (" + placeholders + ")");
+            foreach (const QVariant &hash, chunk)
+            {
+                query_tags.addBindValue(hash);
+            }
+            if (query_tags.exec() == false)
+            {
+                qCWarning(DS_DB) << "SELECT tags of tracks failed: " << query_tags.lastError().text();
+                result = false;
+                break;
+            }
+            while (query_tags.next() == true)
+            {
+                QHash<QString, Track_metadata>::iterator track = out_tracks.find(query_tags.value(0).toString());
+                if (track != out_tracks.end())
+                {
+                    track->tags << query_tags.value(1).toString();
+                }
+            }
+            query_tags.finish();
+        }
+        if (not_cached.isEmpty() == false)
+        {
+            this->get_db().commit();
+        }
+
+        // Cache tracks read from DB (also the ones which are not in DB).
+        if (result == true)
+        {
+            this->cache_mutex.lock();
+            foreach (const QString &hash, not_cached)
+            {
+                QHash<QString, Track_metadata>::const_iterator track = out_tracks.constFind(hash);
+                this->set_cached_track(hash, track != out_tracks.constEnd() ? &track.value() : nullptr, generation);
+            }
+            this->cache_mutex.unlock();
+        }
+    }
+    else
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+bool Data_persistence::store_cue_point(const QSharedPointer<Audio_track> &at,
+                                       const unsigned int                &number,
+                                       const unsigned int                &position_msec)
+{
+    // Init result.
+    bool result = true;
+
+    // Check input parameter.
+    if ((at.data() == nullptr) ||
+        (at->get_hash().size() == 0) ||
+        (number >= MAX_NB_CUE_POINTS) ||
+        (position_msec > at->get_length()))
+    {
+        result = false;
+    }
+
+    // Insert or update cue point for the specified audio track (identified by the hash).
+    if ((result == true) &&
+        (this->is_initialized == true))
+    {
+        // Create audio track if not already in DB.
+        if (this->store_audio_track(at) == false)
+        {
+            result = false;
+        }
+        else
+        {
+            // Only one writer at a time.
+            this->mutex.lock();
+
+            // Get audio track id from Db.
+            QSqlQuery &query_at = this->get_query("SELECT id_track FROM TRACK WHERE hash = :hash");
+            query_at.bindValue(":hash", at->get_hash());
+            query_at.exec();
+            if (query_at.lastError().isValid())
+            {
+                qCWarning(DS_DB) << "SELECT track failed: " << query_at.lastError().text();
+                result = false;
+            }
+            else if (query_at.next() == true) // Check if there is a record.
+            {
+                // Audio track found, search for the cue point.
+                QVariant   id_track       = query_at.value(0);
+                QSqlQuery &query_cuepoint = this->get_query("SELECT id_cuepoint, position FROM TRACK_CUE_POINT WHERE id_track = :id_track AND number = :number");
+                query_cuepoint.bindValue(":id_track", id_track);
+                query_cuepoint.bindValue(":number",   number);
+                query_cuepoint.exec();
+                if (query_cuepoint.lastError().isValid())
+                {
+                    qCWarning(DS_DB) << "SELECT cue_point failed: " << query_cuepoint.lastError().text();
+                    result = false;
+                }
+                else if (query_cuepoint.next() == true) // Check if there is a record.
+                {
+                    // The cue point already exists, update it if the position changed.
+                    if (query_cuepoint.value(1) != position_msec)
+                    {
+                        int id_cuepoint = query_cuepoint.value(0).toInt();
+                        query_cuepoint.finish();
+                        QSqlQuery &query_update = this->get_query("UPDATE TRACK_CUE_POINT SET position = :position WHERE id_cuepoint = :id_cuepoint");
+                        query_update.bindValue(":position", position_msec);
+                        query_update.bindValue(":id_cuepoint", id_cuepoint);
+                        query_update.exec();
+
+                        if (query_update.lastError().isValid())
+                        {
+                            qCWarning(DS_DB) << "UPDATE cue point failed: " << query_update.lastError().text();
+                            result = false;
+                        }
+                        query_update.finish();
+                    }
+                }
+                else
+                {
+                    // No existing cue point found, insert it in DB.
+                    query_cuepoint.finish();
+                    QSqlQuery &query_insert = this->get_query("INSERT INTO TRACK_CUE_POINT (id_track, number, position) "
+                                                              "VALUES (:id_track, :number, :position)");
+                    query_insert.bindValue(":id_track", id_track);
+                    query_insert.bindValue(":number",   number);
+                    query_insert.bindValue(":position", position_msec);
+                    query_insert.exec();
+
+                    if (query_insert.lastError().isValid())
+                    {
+                        qCWarning(DS_DB) << "INSERT cue point failed: " << query_insert.lastError().text();
+                        result = false;
+                    }
+                    query_insert.finish();
+                }
+                query_cuepoint.finish();
+            }
+            query_at.finish();
+
+            // Update cached cue point.
+            this->cache_mutex.lock();
+            this->cache_generation++;
+            if (result == true)
+            {
+                this->get_cache_entry(at->get_hash())->cue_points.insert(number, position_msec);
+            }
+            else
+            {
+                this->cache.remove(at->get_hash());
+            }
+            this->cache_mutex.unlock();
+
+            // Release the writer lock.
+            this->mutex.unlock();
+        }
+    }
+    else
+    {
+        // Db not open.
+        qCWarning(DS_DB) << "can not store cue point: db not open";
+        result = false;
+    }
+
+    return result;
+}
+
+bool Data_persistence::get_cue_point(const QSharedPointer<Audio_track> &at,
+                                     const unsigned int                &number,
+                                     unsigned int                      &out_position_msec)
+{
+    // Init result.
+    bool result = true;
+
+    // Check input parameter.
+    if ((at.data() == nullptr) ||
+        (at->get_hash().size() == 0) ||
+        (number >= MAX_NB_CUE_POINTS))
+    {
+        qCWarning(DS_DB) << "can not get cue point: wrong params.";
+        result = false;
+    }
+
+    // Use cached cue point if any.
+    bool is_cached = false;
+    quint64 generation = 0;
+    if (result == true)
+    {
+        this->cache_mutex.lock();
+        Track_cache_entry *entry = this->cache.object(at->get_hash());
+        is_cached  = (entry != nullptr) && (entry->cue_points.contains(number) == true);
+        generation = this->cache_generation;
+        if (is_cached == true)
+        {
+            int position = entry->cue_points.value(number);
+            if (position < 0)
+            {
+                result = false;
+            }
+            else
+            {
+                out_position_msec = position;
+            }
+        }
+        this->cache_mutex.unlock();
+    }
+
+    // Search the audio track (based on its hash) in DB.
+    if ((result == true) &&
+        (is_cached == false) &&
+        (this->is_initialized == true))
+    {
+        int position = -1;
+        QSqlQuery &query = this->get_query("SELECT position FROM TRACK_CUE_POINT "
+                                           "JOIN TRACK ON TRACK.id_track = TRACK_CUE_POINT.id_track "
+                                           "WHERE TRACK.hash = :hash AND TRACK_CUE_POINT.number = :number");
+        query.bindValue(":hash",   at->get_hash());
+        query.bindValue(":number", number);
+        query.exec();
+        bool is_valid = true;
+        if (query.lastError().isValid())
+        {
+            qCWarning(DS_DB) << "SELECT cue point failed: " << query.lastError().text();
+            result   = false;
+            is_valid = false;
+        }
+        else if (query.next() == true) // Check if there is a record.
+        {
+            // The cue point exists, get position.
+            position          = query.value(0).toInt();
+            out_position_msec = position;
+        }
+        else
+        {
+            // Audio track or cue point not found.
+            result = false;
+        }
+        query.finish();
+
+        // Cache it (or the fact that there is no cue point) if nothing was written meanwhile.
+        if (is_valid == true)
+        {
+            this->cache_mutex.lock();
+            if (generation == this->cache_generation)
+            {
+                this->get_cache_entry(at->get_hash())->cue_points.insert(number, position);
+            }
+            this->cache_mutex.unlock();
+        }
+    }
+
+    return result;
+}
+
+bool Data_persistence::delete_cue_point(const QSharedPointer<Audio_track> &at,
+                                        const unsigned int                &number)
+{
+    // Init result.
+    bool result = true;
+
+    // Check input parameter.
+    if ((at.data() == nullptr) ||
+        (at->get_hash().size() == 0) ||
+        (number >= MAX_NB_CUE_POINTS))
+    {
+        qCWarning(DS_DB) << "can not delete cue point: wrong params.";
+        result = false;
+    }
+
+    // Search the audio track (based on its hash) in DB.
+    if ((result == true) &&
+        (this->is_initialized == true))
+    {
+        // Only one writer at a time.
+        this->mutex.lock();
+
+        QSqlQuery &query = this->get_query("SELECT id_track FROM TRACK WHERE hash = :hash");
+        query.bindValue(":hash", at->get_hash());
+        query.exec();
+        if (query.lastError().isValid())
+        {
+            // Can not select audio track in DB.
+            qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
+            result = false;
+        }
+        else if (query.next() == true) // Check if there is a record.
+        {
+            // The audio track exists, look for the specified cue point.
+            QSqlQuery &query_cue_point = this->get_query("DELETE FROM TRACK_CUE_POINT WHERE id_track = :id_track AND number = :number");
+            query_cue_point.bindValue(":id_track", query.value(0));
+            query_cue_point.bindValue(":number",   number);
+            query_cue_point.exec();
+            if (query_cue_point.lastError().isValid())
+            {
+                // Can not delete cue point.
+                qCWarning(DS_DB) << "DELETE cue point failed: " << query_cue_point.lastError().text();
+                result = false;
+            }
+            query_cue_point.finish();
+        }
+        else
+        {
+            // Audio track not found.
+            result = false;
+        }
+        query.finish();
+
+        // Update cached cue point.
+        this->cache_mutex.lock();
+        this->cache_generation++;
+        if (result == true)
+        {
+            this->get_cache_entry(at->get_hash())->cue_points.insert(number, -1);
+        }
+        else
+        {
+            this->cache.remove(at->get_hash());
+        }
+        this->cache_mutex.unlock();
+
+        // Release the writer lock.
+        this->mutex.unlock();
+    }
+
+    return result;
+}
+
+bool Data_persistence::store_analysis(const QString    &hash,
+                                      const QString    &type,
+                                      const QByteArray &data)
+{
+    // Init result.
+    bool result = true;
+
+    // Check input parameter.
+    if ((hash.size() == 0) ||
+        (type.size() == 0))
+    {
+        qCWarning(DS_DB) << "can not store analysis: wrong params.";
+        result = false;
+    }
+
+    // Insert or replace analysis data.
+    if ((result == true) &&
+        (this->is_initialized == true))
+    {
+        // Only one writer at a time.
+        this->mutex.lock();
+
+        QSqlQuery &query = this->get_query("INSERT OR REPLACE INTO TRACK_ANALYSIS (hash, type, data) "
+                                           "VALUES (:hash, :type, :data)");
+        query.bindValue(":hash", hash);
+        query.bindValue(":type", type);
+        query.bindValue(":data", data);
+        query.exec();
+
+        if (query.lastError().isValid())
+        {
+            qCWarning(DS_DB) << "INSERT analysis failed: " << query.lastError().text();
+            result = false;
+        }
+        query.finish();
+
+        // Release the writer lock.
+        this->mutex.unlock();
+    }
+    else
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+bool Data_persistence::get_analysis(const QString &hash,
+                                    const QString &type,
+                                    QByteArray    &out_data)
+{
+    // Init result.
+    bool result = true;
+
+    // Check input parameter.
+    if ((hash.size() == 0) ||
+        (type.size() == 0))
+    {
+        qCWarning(DS_DB) << "can not get analysis: wrong params.";
+        result = false;
+    }
+
+    // Search analysis data of the track.
+    if ((result == true) &&
+        (this->is_initialized == true))
+    {
+        QSqlQuery &query = this->get_query("SELECT data FROM TRACK_ANALYSIS WHERE hash = :hash AND type = :type");
+        query.bindValue(":hash", hash);
+        query.bindValue(":type", type);
+        query.exec();
+
+        if (query.lastError().isValid())
+        {
+            qCWarning(DS_DB) << "SELECT analysis failed: " << query.lastError().text();
+            result = false;
+        }
+        else if (query.next() == true) // Check if there is a record.
+        {
+            out_data = query.value(0).toByteArray();
+        }
+        else
+        {
+            // Analysis data not found.
+            result = false;
+        }
+        query.finish();
+    }
+    else
+    {
+        result = false;
+    }
+
+    return result;
+}
+
+bool Data_persistence::store_file_index(const QList<File_index_entry> &entries)
+{
+    // Init result.
+    bool result = true;
+
+    if (this->is_initialized == true)
+    {
+        // Only one writer at a time.
+        this->mutex.lock();
+
+        // Insert all entries in one transaction (a lot faster than one transaction per entry).
+        this->get_db().transaction();
+        // Without upsert (old SQLite): insert entry if it does not exist, then update it.
+        QList<QSqlQuery*> queries;
+        if (this->has_upsert == true)
+        {
+            queries << &this->get_query("INSERT INTO FILE_INDEX (path, size, mtime, hash) "
+                                        "VALUES (:path, :size, :mtime, :hash) "
+                                        "ON CONFLICT(path) DO UPDATE SET size = excluded.size, mtime = excluded.mtime, hash = excluded.hash");
+        }
+        else
+        {
+            queries << &this->get_query("INSERT OR IGNORE INTO FILE_INDEX (path, size, mtime, hash) "
+                                        "VALUES (:path, :size, :mtime, :hash)")
+                    << &this->get_query("UPDATE FILE_INDEX SET size = :size, mtime = :mtime, hash = :hash WHERE path = :path");
+        }
+        foreach (const File_index_entry &entry, entries)
+        {
+            foreach (QSqlQuery *query, queries)
+            {
+                query->bindValue(":path",  entry.path);
+                query->bindValue(":size",  entry.size);
+                query->bindValue(":mtime", entry.mtime);
+                query->bindValue(":hash",  entry.hash);
+                if (query->exec() == false)
+                {
+                    qCWarning(DS_DB) << "INSERT file index failed: " << query->lastError().text();
+                    result = false;
+                    break;
+                }
+            }
+            if (result == false)
+            {
+                break;
+            }
+        }
+        foreach (QSqlQuery *query, queries)
         {
-            qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
-            result = false;
+            query->finish();
         }
-        else if (query.next() == true) // Check if there is a record.
+        if (result == true)
         {
-            // The audio track exists, fill the returned object.
-            io_at->set_music_key(query.value(0).toString());
-            io_at->set_music_key_tag(query.value(1).toString());
-            io_at->set_fullpath(query.value(2).toString() + "/" + query.value(3).toString());
+            result = this->get_db().commit();
         }
         else
         {
-            // Audio track not found.
-            result = false;
-            qCDebug(DS_DB) << "audio track not found in DB, hash: " << io_at->get_hash();
+            this->get_db().rollback();
         }
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
-
-        // Get the list of tags associated to that track.
-        QStringList tags;
-        if (this->get_tags_from_track(io_at, tags) == true)
-        {
-            io_at->set_tags(tags);
-        }
+    }
+    else
+    {
+        result = false;
     }
 
     return result;
 }
 
-bool Data_persistence::store_cue_point(const QSharedPointer<Audio_track> &at,
-                                       const unsigned int                &number,
-                                       const unsigned int                &position_msec)
+bool Data_persistence::get_file_index(const QString                    &root_path,
+                                      QHash<QString, File_index_entry> &out_index)
 {
     // Init result.
     bool result = true;
+    out_index.clear();
 
     // Check input parameter.
-    if ((at.data() == nullptr) ||
-        (at->get_hash().size() == 0) ||
-        (number >= MAX_NB_CUE_POINTS) ||
-        (position_msec > at->get_length()))
+    if (root_path.size() == 0)
     {
+        qCWarning(DS_DB) << "can not get file index: wrong params.";
         result = false;
     }
 
-    // Insert or update cue point for the specified audio track (identified by the hash).
+    // Get all files under the root path.
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Create audio track if not already in DB.
-        if (this->store_audio_track(at) == false)
+        QString prefix = root_path.endsWith('/') == true ? root_path : root_path + '/';
+
+        QSqlQuery &query = this->get_query("SELECT path, size, mtime, hash FROM FILE_INDEX WHERE substr(path, 1, :length) = :prefix");
+        query.bindValue(":length", prefix.size());
+        query.bindValue(":prefix", prefix);
+        query.exec();
+
+        if (query.lastError().isValid())
         {
+            qCWarning(DS_DB) << "SELECT file index failed: " << query.lastError().text();
             result = false;
         }
         else
         {
-            // Ensure no other thread can access the DB connection.
-            this->mutex.lock();
-
-            // Get audio track id from Db.
-            QSqlQuery query_at = this->db.exec("SELECT id_track FROM TRACK WHERE hash=\"" + at->get_hash() + "\"");
-            if (query_at.lastError().isValid())
-            {
-                qCWarning(DS_DB) << "SELECT track failed: " << query_at.lastError().text();
-                result = false;
-            }
-            else if (query_at.next() == true) // Check if there is a record.
+            while (query.next() == true)
             {
-                // Audio track found, search for the cue point.
-                QSqlQuery query_cuepoint = this->db.exec(
-                          "SELECT id_cuepoint, position FROM TRACK_CUE_POINT WHERE id_track=\"" + query_at.value(0).toString() + "\" AND number=\"" + QString::number(number) + "\"");
-                if (query_cuepoint.lastError().isValid())
-                {
-                    qCWarning(DS_DB) << "SELECT cue_point failed: " << query_cuepoint.lastError().text();
-                    result = false;
-                }
-                else if (query_cuepoint.next() == true) // Check if there is a record.
-                {
-                    // The cue point already exists, update it if the position changed.
-                    if (query_cuepoint.value(1) != position_msec)
-                    {
-                        int id_cuepoint = query_cuepoint.value(0).toInt();
-                        query_cuepoint.prepare("UPDATE TRACK_CUE_POINT SET position = :position WHERE id_cuepoint = :id_cuepoint");
-                        query_cuepoint.bindValue(":position", position_msec);
-                        query_cuepoint.bindValue(":id_cuepoint", id_cuepoint);
-                        query_cuepoint.exec();
-
-                        if (query_cuepoint.lastError().isValid())
-                        {
-                            qCWarning(DS_DB) << "UPDATE cue point failed: " << query_cuepoint.lastError().text();
-                            result = false;
-                        }
-                    }
-                }
-                else
-                {
-                    // No existing cue point found, insert it in DB.
-                    query_cuepoint.prepare("INSERT INTO TRACK_CUE_POINT (id_track, number, position) "
-                                  "VALUES (:id_track, :number, :position)");
-                    query_cuepoint.bindValue(":id_track", query_at.value(0));
-                    query_cuepoint.bindValue(":number",   number);
-                    query_cuepoint.bindValue(":position", position_msec);
-                    query_cuepoint.exec();
-
-                    if (query_cuepoint.lastError().isValid())
-                    {
-                        qCWarning(DS_DB) << "INSERT cue point failed: " << query_cuepoint.lastError().text();
-                        result = false;
-                    }
-                }
+                File_index_entry entry;
+                entry.path  = query.value(0).toString();
+                entry.size  = query.value(1).toLongLong();
+                entry.mtime = query.value(2).toLongLong();
+                entry.hash  = query.value(3).toString();
+                out_index.insert(entry.path, entry);
             }
-
-            // Release the DB connection.
-            this->mutex.unlock();
         }
+        query.finish();
     }
     else
     {
-        // Db not open.
-        qCWarning(DS_DB) << "can not store cue point: db not open";
         result = false;
     }
 
     return result;
 }
 
-bool Data_persistence::get_cue_point(const QSharedPointer<Audio_track> &at,
-                                     const unsigned int                &number,
-                                     unsigned int                      &out_position_msec)
+bool Data_persistence::delete_file_index(const QStringList &paths)
 {
     // Init result.
     bool result = true;
 
-    // Check input parameter.
-    if ((at.data() == nullptr) ||
-        (at->get_hash().size() == 0) ||
-        (number >= MAX_NB_CUE_POINTS))
-    {
-        qCWarning(DS_DB) << "can not get cue point: wrong params.";
-        result = false;
-    }
-
-    // Search the audio track (based on its hash) in DB.
-    if ((result == true) &&
-        (this->is_initialized == true))
+    if (this->is_initialized == true)
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
-        QSqlQuery query = this->db.exec("SELECT id_track FROM TRACK WHERE hash=\"" + at->get_hash() + "\"");
-        if (query.lastError().isValid())
-        {
-            qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
-            result = false;
-        }
-        else if (query.next() == true) // Check if there is a record.
+        // Delete all entries in one transaction.
+        this->get_db().transaction();
+        QSqlQuery &query = this->get_query("DELETE FROM FILE_INDEX WHERE path = :path");
+        foreach (const QString &path, paths)
         {
-            // The audio track exists, look for the specified cue point.
-            QSqlQuery query_cue_point = this->db.exec(
-                        "SELECT position FROM TRACK_CUE_POINT WHERE id_track=\"" + query.value(0).toString() + "\" AND number=\"" + QString::number(number) + "\"");
-            if (query_cue_point.lastError().isValid())
-            {
-                qCWarning(DS_DB) << "SELECT cue point failed: " << query_cue_point.lastError().text();
-                result = false;
-            }
-            else if (query_cue_point.next() == true) // Check if there is a record.
-            {
-                // The cue point exists, get position.
-                out_position_msec = query_cue_point.value(0).toInt();
-            }
-            else
+            query.bindValue(":path", path);
+            if (query.exec() == false)
             {
-                // Cue point not found.
+                qCWarning(DS_DB) << "DELETE file index failed: " << query.lastError().text();
                 result = false;
+                break;
             }
         }
+        query.finish();
+        if (result == true)
+        {
+            result = this->get_db().commit();
+        }
         else
         {
-            // Audio track not found.
-            result = false;
+            this->get_db().rollback();
         }
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
+    else
+    {
+        result = false;
+    }
 
     return result;
 }
 
-bool Data_persistence::delete_cue_point(const QSharedPointer<Audio_track> &at,
-                                        const unsigned int                &number)
+bool Data_persistence::fill_search_result(const QStringList &match_terms,
+                                          const QString     &like_term)
+{
+    QSqlQuery query(this->get_db());
+    if ((query.exec("CREATE TEMP TABLE IF NOT EXISTS SEARCH_RESULT (id_file INTEGER PRIMARY KEY)") == false) ||
+        (query.exec("DELETE FROM temp.SEARCH_RESULT") == false))
+    {
+        qCWarning(DS_DB) << "can not clear search results: " << query.lastError().text();
+        return false;
+    }
+
+    // Terms of at least 3 characters are searched in all columns of the full-text index, otherwise only in file names.
+    if (match_terms.isEmpty() == false)
+    {
+        query.prepare("INSERT INTO temp.SEARCH_RESULT (id_file) SELECT rowid FROM FILE_SEARCH WHERE FILE_SEARCH MATCH :match");
+        query.bindValue(":match", match_terms.join(' '));
+    }
+    else
+    {
+        QString escaped = like_term;
+        escaped.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+        query.prepare("INSERT INTO temp.SEARCH_RESULT (id_file) SELECT rowid FROM FILE_SEARCH WHERE filename LIKE :like ESCAPE '\\'");
+        query.bindValue(":like", "%" + escaped + "%");
+    }
+    if (query.exec() == false)
+    {
+        qCWarning(DS_DB) << "can not search files: " << query.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+bool Data_persistence::search_files(const Search_query &search,
+                                    const QString      &after_path,
+                                    const int          &limit,
+                                    QStringList        &out_paths)
 {
     // Init result.
     bool result = true;
 
-    // Check input parameter.
-    if ((at.data() == nullptr) ||
-        (at->get_hash().size() == 0) ||
-        (number >= MAX_NB_CUE_POINTS))
+    if ((this->is_initialized == false) ||
+        (this->has_search_index == false))
     {
-        qCWarning(DS_DB) << "can not delete cue point: wrong params.";
-        result = false;
+        return false;
     }
 
-    // Search the audio track (based on its hash) in DB.
-    if ((result == true) &&
-        (this->is_initialized == true))
+    // Terms of at least 3 characters are searched in the full-text index (in any order, anywhere in words),
+    // a shorter text (e.g. first typed characters) is only searched in file names.
+    QStringList match_terms;
+    QString     like_term;
+    foreach (const QString &term, search.terms)
     {
-        // Ensure no other thread can access the DB connection.
-        this->mutex.lock();
+        if (term.size() >= 3)
+        {
+            match_terms << "\"" + QString(term).replace("\"", "\"\"") + "\"";
+        }
+        else if (like_term.isEmpty() == true)
+        {
+            like_term = term;
+        }
+    }
+    int  key_code         = Utils::get_music_key_code(search.key);
+    bool has_track_filter = (search.key.isEmpty() == false) || (search.bpm_max > 0.0f) || (search.tag.isEmpty() == false);
 
-        QSqlQuery query = this->db.exec("SELECT id_track FROM TRACK WHERE hash=\"" + at->get_hash() + "\"");
-        if (query.lastError().isValid())
+    // Files matching text terms are searched only once (first page, or other terms than the previous
+    // page) into a temporary table of the connection of this thread, next pages only read it.
+    QString text_filter = "";
+    if (match_terms.isEmpty() == false)
+    {
+        text_filter = "MATCH " + match_terms.join(' ');
+    }
+    else if (like_term.isEmpty() == false)
+    {
+        text_filter = "LIKE " + like_term;
+    }
+    if (text_filter.isEmpty() == false)
+    {
+        this->get_db();
+        if (this->connections.hasLocalData() == false)
         {
-            // Can not select audio track in DB.
-            qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
-            result = false;
+            return false;
         }
-        else if (query.next() == true) // Check if there is a record.
+        Db_connection *connection = this->connections.localData();
+        if ((after_path.isEmpty() == true) || (connection->search_filter != text_filter))
         {
-            // The audio track exists, look for the specified cue point.
-            QSqlQuery query_cue_point = this->db.exec(
-                        "DELETE FROM TRACK_CUE_POINT WHERE id_track=\"" + query.value(0).toString() + "\" AND number=\"" + QString::number(number) + "\"");
-            if (query_cue_point.lastError().isValid())
+            connection->search_filter = "";
+            if (this->fill_search_result(match_terms, like_term) == false)
             {
-                // Can not delete cue point.
-                qCWarning(DS_DB) << "DELETE cue point failed: " << query_cue_point.lastError().text();
-                result = false;
+                return false;
             }
+            connection->search_filter = text_filter;
         }
-        else
+    }
+
+    // Files sorted by path, starting after the last one of the previous page.
+    QString sql = "SELECT F.path FROM FILE_INDEX F ";
+    if (has_track_filter == true)
+    {
+        sql += "JOIN TRACK ON TRACK.hash = F.hash ";
+    }
+    sql += "WHERE F.path > :after ";
+    if (text_filter.isEmpty() == false)
+    {
+        sql += "AND F.id_file IN (SELECT id_file FROM temp.SEARCH_RESULT) ";
+    }
+    if (search.key.isEmpty() == false)
+    {
+        sql += "AND TRACK.key_code = :key_code ";
+    }
+    if (search.bpm_max > 0.0f)
+    {
+        sql += "AND TRACK.bpm BETWEEN :bpm_min AND :bpm_max ";
+    }
+    if (search.tag.isEmpty() == false)
+    {
+        sql += "AND TRACK.id_track IN (SELECT TRACK_TAG.id_track FROM TRACK_TAG "
+               "JOIN TAG ON TAG.id_tag = TRACK_TAG.id_tag WHERE TAG.name = :tag) ";
+    }
+    sql += "ORDER BY F.path LIMIT :limit";
+
+    QSqlQuery &query = this->get_query(sql);
+    query.bindValue(":after", after_path);
+    if (search.key.isEmpty() == false)
+    {
+        query.bindValue(":key_code", key_code);
+    }
+    if (search.bpm_max > 0.0f)
+    {
+        query.bindValue(":bpm_min", search.bpm_min);
+        query.bindValue(":bpm_max", search.bpm_max);
+    }
+    if (search.tag.isEmpty() == false)
+    {
+        query.bindValue(":tag", search.tag);
+    }
+    query.bindValue(":limit", limit);
+    query.exec();
+
+    if (query.lastError().isValid())
+    {
+        qCWarning(DS_DB) << "SELECT search failed: " << query.lastError().text();
+        result = false;
+    }
+    else
+    {
+        while (query.next() == true)
         {
-            // Audio track not found.
-            result = false;
+            out_paths << query.value(0).toString();
         }
-
-        // Release the DB connection.
-        this->mutex.unlock();
     }
+    query.finish();
 
     return result;
 }
@@ -587,11 +1726,13 @@ bool Data_persistence::store_tag(const QString &name)
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
         // Try to get tag from Db.
-        QSqlQuery query = this->db.exec("SELECT id_tag, name FROM TAG WHERE name=\"" + name + "\"");
+        QSqlQuery &query = this->get_query("SELECT id_tag, name FROM TAG WHERE name = :name");
+        query.bindValue(":name", name);
+        query.exec();
         if (query.lastError().isValid())
         {
             qCWarning(DS_DB) << "SELECT tag failed: " << query.lastError().text();
@@ -600,19 +1741,22 @@ bool Data_persistence::store_tag(const QString &name)
         else if (query.next() == false)
         {
             // Tag not found, add it.
-            query.prepare("INSERT INTO TAG (name) "
-                          "VALUES (:name)");
-            query.bindValue(":name", name);
-            query.exec();
+            query.finish();
+            QSqlQuery &query_insert = this->get_query("INSERT INTO TAG (name) "
+                                                      "VALUES (:name)");
+            query_insert.bindValue(":name", name);
+            query_insert.exec();
 
-            if (query.lastError().isValid())
+            if (query_insert.lastError().isValid())
             {
-                qCWarning(DS_DB) << "INSERT tag failed: " << query.lastError().text();
+                qCWarning(DS_DB) << "INSERT tag failed: " << query_insert.lastError().text();
                 result = false;
             }
+            query_insert.finish();
         }
+        query.finish();
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
     else
@@ -641,11 +1785,13 @@ bool Data_persistence::rename_tag(const QString &old_name, const QString &new_na
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
         // Try to get tag from Db.
-        QSqlQuery query = this->db.exec("SELECT id_tag, name FROM TAG WHERE name=\"" + old_name + "\"");
+        QSqlQuery &query = this->get_query("SELECT id_tag, name FROM TAG WHERE name = :name");
+        query.bindValue(":name", old_name);
+        query.exec();
         if (query.lastError().isValid())
         {
             qCWarning(DS_DB) << "SELECT tag failed: " << query.lastError().text();
@@ -655,17 +1801,19 @@ bool Data_persistence::rename_tag(const QString &old_name, const QString &new_na
         {
             // Tag found.
             int existing_id = query.value(0).toInt();
-            query.prepare("UPDATE TAG SET name = :name "
-                          "WHERE id_tag = :id_tag");
-            query.bindValue(":name", new_name);
-            query.bindValue(":id_tag", QString::number(existing_id));
-            query.exec();
-
-            if (query.lastError().isValid())
+            query.finish();
+            QSqlQuery &query_update = this->get_query("UPDATE TAG SET name = :name "
+                                                      "WHERE id_tag = :id_tag");
+            query_update.bindValue(":name", new_name);
+            query_update.bindValue(":id_tag", existing_id);
+            query_update.exec();
+
+            if (query_update.lastError().isValid())
             {
-                qCWarning(DS_DB) << "UPDATE tag failed: " << query.lastError().text();
+                qCWarning(DS_DB) << "UPDATE tag failed: " << query_update.lastError().text();
                 result = false;
             }
+            query_update.finish();
         }
         else
         {
@@ -673,8 +1821,12 @@ bool Data_persistence::rename_tag(const QString &old_name, const QString &new_na
             result = false;
             qCWarning(DS_DB) << "can not found the tag " << old_name;
         }
+        query.finish();
+
+        // Tags of all tracks may have changed.
+        this->invalidate_cached_tags();
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
     else
@@ -702,52 +1854,57 @@ bool Data_persistence::delete_tag(const QString &name)
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
-        QString select_str = "SELECT id_tag FROM TAG WHERE name=\"" + name + "\"";
-        QSqlQuery query = this->db.exec(select_str);
+        QSqlQuery &query = this->get_query("SELECT id_tag FROM TAG WHERE name = :name");
+        query.bindValue(":name", name);
+        query.exec();
         if (query.lastError().isValid())
         {
             // Can not select tag in DB.
             qCWarning(DS_DB) << "SELECT tag failed (" << query.lastError().text() << ") "
-                             << select_str;
+                             << name;
             result = false;
         }
         else if (query.next() == true) // Check if there is a record.
         {
             // Delete all references to this tag for all tracks.
-            QString del_trtag_str = "DELETE FROM TRACK_TAG "
-                                "WHERE id_tag=\"" + query.value(0).toString() + "\"";
-            QSqlQuery query_track_tag = this->db.exec(del_trtag_str);
+            QVariant id_tag = query.value(0);
+            QSqlQuery &query_track_tag = this->get_query("DELETE FROM TRACK_TAG WHERE id_tag = :id_tag");
+            query_track_tag.bindValue(":id_tag", id_tag);
+            query_track_tag.exec();
             if (query_track_tag.lastError().isValid())
             {
                 // Can not delete track/tag.
                 qCWarning(DS_DB) << "DELETE track/tag failed (" << query_track_tag.lastError().text() << ") "
-                                 << del_trtag_str;
+                                 << name;
                 result = false;
             }
             else
             {
                 // All references to the tag has been deleted.
-                qCDebug(DS_DB) << "DELETE track/tag success: " << del_trtag_str;
+                qCDebug(DS_DB) << "DELETE track/tag success: " << name;
 
                 // Now remove the tag itself.
-                QString del_tag_str = "DELETE FROM TAG WHERE id_tag=\"" + query.value(0).toString() + "\"";
-                QSqlQuery query_tag = this->db.exec(del_tag_str);
+                QSqlQuery &query_tag = this->get_query("DELETE FROM TAG WHERE id_tag = :id_tag");
+                query_tag.bindValue(":id_tag", id_tag);
+                query_tag.exec();
                 if (query_tag.lastError().isValid())
                 {
                     // Can not delete tag.
                     qCWarning(DS_DB) << "DELETE tag failed (" << query_tag.lastError().text() << ") "
-                                     << del_tag_str;
+                                     << name;
                     result = false;
                 }
                 else
                 {
                     // The tag has been deleted.
-                    qCDebug(DS_DB) << "DELETE tag success: " << del_tag_str;
+                    qCDebug(DS_DB) << "DELETE tag success: " << name;
                 }
+                query_tag.finish();
             }
+            query_track_tag.finish();
         }
         else
         {
@@ -755,8 +1912,12 @@ bool Data_persistence::delete_tag(const QString &name)
             qCWarning(DS_DB) << "can not delete tag: tag not found";
             result = false;
         }
+        query.finish();
 
-        // Release the DB connection.
+        // Tags of all tracks may have changed.
+        this->invalidate_cached_tags();
+
+        // Release the writer lock.
         this->mutex.unlock();
     }
 
@@ -771,10 +1932,8 @@ bool Data_persistence::get_full_tag_list(QStringList &out_tags)
     // Get all tags.
     if (this->is_initialized == true)
     {
-        // Ensure no other thread can access the DB connection.
-        this->mutex.lock();
-
-        QSqlQuery query = this->db.exec("SELECT name FROM TAG");
+        QSqlQuery &query = this->get_query("SELECT name FROM TAG");
+        query.exec();
         if (query.lastError().isValid())
         {
             // Can not select tag in DB.
@@ -788,9 +1947,7 @@ bool Data_persistence::get_full_tag_list(QStringList &out_tags)
                 out_tags.push_back(query.value(0).toString());
             }
         }
-
-        // Release the DB connection.
-        this->mutex.unlock();
+        query.finish();
     }
 
     return result;
@@ -815,10 +1972,12 @@ bool Data_persistence::add_tag_to_track(const QSharedPointer<Audio_track> &at,
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
-        QSqlQuery query = this->db.exec("SELECT id_track FROM TRACK WHERE hash=\"" + at->get_hash() + "\"");
+        QSqlQuery &query = this->get_query("SELECT id_track FROM TRACK WHERE hash = :hash");
+        query.bindValue(":hash", at->get_hash());
+        query.exec();
         if (query.lastError().isValid())
         {
             qCWarning(DS_DB) << "SELECT track failed: " << query.lastError().text();
@@ -827,7 +1986,9 @@ bool Data_persistence::add_tag_to_track(const QSharedPointer<Audio_track> &at,
         else if (query.next() == true) // Check if there is a record.
         {
             // The audio track exists, let's search the tag.
-            QSqlQuery query_tag = this->db.exec("SELECT id_tag FROM TAG WHERE name=\"" + tag_name + "\"");
+            QSqlQuery &query_tag = this->get_query("SELECT id_tag FROM TAG WHERE name = :name");
+            query_tag.bindValue(":name", tag_name);
+            query_tag.exec();
             if (query_tag.lastError().isValid())
             {
                 qCWarning(DS_DB) << "SELECT tag failed: " << query_tag.lastError().text();
@@ -845,6 +2006,7 @@ bool Data_persistence::add_tag_to_track(const QSharedPointer<Audio_track> &at,
                 qCWarning(DS_DB) << "can not add tag to track: tag not found";
                 result = false;
             }
+            query_tag.finish();
         }
         else
         {
@@ -852,8 +2014,25 @@ bool Data_persistence::add_tag_to_track(const QSharedPointer<Audio_track> &at,
             qCWarning(DS_DB) << "can not add tag to track: track not found";
             result = false;
         }
+        query.finish();
+
+        // Update cached tags of the track.
+        this->cache_mutex.lock();
+        this->cache_generation++;
+        Track_cache_entry *entry = this->cache.object(at->get_hash());
+        if (result == false)
+        {
+            this->cache.remove(at->get_hash());
+        }
+        else if ((entry != nullptr) &&
+                 (entry->has_tags == true) &&
+                 (entry->track.tags.contains(tag_name) == false))
+        {
+            entry->track.tags << tag_name;
+        }
+        this->cache_mutex.unlock();
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
 
@@ -885,7 +2064,10 @@ bool Data_persistence::store_track_tag(const QString &id_track,
         (this->is_initialized == true))
     {
         // Try to get tag/track association  from Db.
-        QSqlQuery query = this->db.exec("SELECT id_track, id_tag FROM TRACK_TAG WHERE id_track=\"" + id_track + "\" AND id_tag=\"" + id_tag + "\"");
+        QSqlQuery &query = this->get_query("SELECT id_track, id_tag FROM TRACK_TAG WHERE id_track = :id_track AND id_tag = :id_tag");
+        query.bindValue(":id_track", id_track);
+        query.bindValue(":id_tag", id_tag);
+        query.exec();
         if (query.lastError().isValid())
         {
             qCWarning(DS_DB) << "SELECT track/tag failed: " << query.lastError().text();
@@ -894,17 +2076,20 @@ bool Data_persistence::store_track_tag(const QString &id_track,
         else if (query.next() == false)
         {
             // Track/tag not found, add it.
-            query.prepare("INSERT INTO TRACK_TAG (id_track, id_tag) VALUES (:id_track, :id_tag)");
-            query.bindValue(":id_track", id_track);
-            query.bindValue(":id_tag", id_tag);
-            query.exec();
+            query.finish();
+            QSqlQuery &query_insert = this->get_query("INSERT INTO TRACK_TAG (id_track, id_tag) VALUES (:id_track, :id_tag)");
+            query_insert.bindValue(":id_track", id_track);
+            query_insert.bindValue(":id_tag", id_tag);
+            query_insert.exec();
 
-            if (query.lastError().isValid())
+            if (query_insert.lastError().isValid())
             {
-                qCWarning(DS_DB) << "INSERT track/tag failed: " << query.lastError().text();
+                qCWarning(DS_DB) << "INSERT track/tag failed: " << query_insert.lastError().text();
                 result = false;
             }
+            query_insert.finish();
         }
+        query.finish();
     }
     else
     {
@@ -934,25 +2119,44 @@ bool Data_persistence::rem_tag_from_track(const QSharedPointer<Audio_track> &at,
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
-        QSqlQuery query = this->db.exec("DELETE FROM TRACK_TAG "
-                                        "WHERE id_track_tag IN "
-                                        "(SELECT id_track_tag FROM TRACK_TAG "
-                                        "JOIN TAG "
-                                        "ON TRACK_TAG.id_tag=TAG.id_tag "
-                                        "JOIN TRACK "
-                                        "ON TRACK_TAG.id_track=TRACK.id_track "
-                                        "WHERE TRACK.hash=\"" + at->get_hash() + "\" AND TAG.name=\"" + tag_name + "\")");
+        QSqlQuery &query = this->get_query("DELETE FROM TRACK_TAG "
+                                           "WHERE id_track_tag IN "
+                                           "(SELECT id_track_tag FROM TRACK_TAG "
+                                           "JOIN TAG "
+                                           "ON TRACK_TAG.id_tag=TAG.id_tag "
+                                           "JOIN TRACK "
+                                           "ON TRACK_TAG.id_track=TRACK.id_track "
+                                           "WHERE TRACK.hash = :hash AND TAG.name = :name)");
+        query.bindValue(":hash", at->get_hash());
+        query.bindValue(":name", tag_name);
+        query.exec();
         if (query.lastError().isValid())
         {
             // Can not delete tag in DB.
             qCWarning(DS_DB) << "DELETE FROM TRACK_TAG failed: " << query.lastError().text();
             result = false;
         }
+        query.finish();
+
+        // Update cached tags of the track.
+        this->cache_mutex.lock();
+        this->cache_generation++;
+        Track_cache_entry *entry = this->cache.object(at->get_hash());
+        if ((result == true) && (entry != nullptr))
+        {
+            entry->track.tags.removeAll(tag_name);
+            entry->tag_positions.insert(tag_name, -1);
+        }
+        else
+        {
+            this->cache.remove(at->get_hash());
+        }
+        this->cache_mutex.unlock();
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
 
@@ -979,19 +2183,36 @@ bool Data_persistence::get_tags_from_track(const QSharedPointer<Audio_track> &at
         result = false;
     }
 
+    // Use cached tags if any.
+    bool is_cached = false;
+    quint64 generation = 0;
+    if (result == true)
+    {
+        this->cache_mutex.lock();
+        Track_cache_entry *entry = this->cache.object(at->get_hash());
+        is_cached  = (entry != nullptr) && (entry->has_tags == true);
+        generation = this->cache_generation;
+        if (is_cached == true)
+        {
+            out_tags << entry->track.tags;
+        }
+        this->cache_mutex.unlock();
+    }
+
     // Get all tags.
     if ((result == true) &&
+        (is_cached == false) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
-        this->mutex.lock();
-
-        QSqlQuery query = this->db.exec("SELECT name FROM TAG "
-                                        "JOIN TRACK_TAG "
-                                        "ON TAG.id_tag=TRACK_TAG.id_tag "
-                                        "JOIN TRACK "
-                                        "ON TRACK_TAG.id_track=TRACK.id_track "
-                                        "WHERE TRACK.hash=\"" + at->get_hash() + "\"");
+        QStringList tags;
+        QSqlQuery &query = this->get_query("SELECT name FROM TAG "
+                                           "JOIN TRACK_TAG "
+                                           "ON TAG.id_tag=TRACK_TAG.id_tag "
+                                           "JOIN TRACK "
+                                           "ON TRACK_TAG.id_track=TRACK.id_track "
+                                           "WHERE TRACK.hash = :hash");
+        query.bindValue(":hash", at->get_hash());
+        query.exec();
         if (query.lastError().isValid())
         {
             // Can not select tag list in DB.
@@ -1003,12 +2224,21 @@ bool Data_persistence::get_tags_from_track(const QSharedPointer<Audio_track> &at
             // Fill result string list.
             while (query.next() == true)
             {
-                out_tags.push_back(query.value(0).toString());
+                tags.push_back(query.value(0).toString());
             }
-        }
+            out_tags << tags;
 
-        // Release the DB connection.
-        this->mutex.unlock();
+            // Cache them if nothing was written meanwhile.
+            this->cache_mutex.lock();
+            if (generation == this->cache_generation)
+            {
+                Track_cache_entry *entry = this->get_cache_entry(at->get_hash());
+                entry->track.tags = tags;
+                entry->has_tags   = true;
+            }
+            this->cache_mutex.unlock();
+        }
+        query.finish();
     }
 
     return result;
@@ -1031,16 +2261,15 @@ bool Data_persistence::get_tracks_from_tag(const QString &tag_name,
     if ((result == true) &&
         (this->is_initialized == true))
     {
-        // Ensure no other thread can access the DB connection.
-        this->mutex.lock();
-
-        QSqlQuery query = this->db.exec("SELECT path, filename FROM TRACK "
-                                        "JOIN TRACK_TAG "
-                                        "ON TRACK.id_track=TRACK_TAG.id_track "
-                                        "JOIN TAG "
-                                        "ON TRACK_TAG.id_tag=TAG.id_tag "
-                                        "WHERE TAG.name=\"" + tag_name + "\" "
-                                        "ORDER BY TRACK_TAG.position");
+        QSqlQuery &query = this->get_query("SELECT path, filename FROM TRACK "
+                                           "JOIN TRACK_TAG "
+                                           "ON TRACK.id_track=TRACK_TAG.id_track "
+                                           "JOIN TAG "
+                                           "ON TRACK_TAG.id_tag=TAG.id_tag "
+                                           "WHERE TAG.name = :name "
+                                           "ORDER BY TRACK_TAG.position");
+        query.bindValue(":name", tag_name);
+        query.exec();
         if (query.lastError().isValid())
         {
             // Can not select track list in DB.
@@ -1055,9 +2284,7 @@ bool Data_persistence::get_tracks_from_tag(const QString &tag_name,
                 out_tracklist.push_back(query.value(0).toString() + "/" + query.value(1).toString());
             }
         }
-
-        // Release the DB connection.
-        this->mutex.unlock();
+        query.finish();
     }
 
     return result;
@@ -1070,11 +2297,12 @@ bool Data_persistence::reorganize_track_pos_in_tag_list() // TODO: do it only fo
 
     if (this->is_initialized == true)
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
         // Get all tag ids.
-        QSqlQuery query_tag_ids = this->db.exec("SELECT id_tag FROM TAG");
+        QSqlQuery &query_tag_ids = this->get_query("SELECT id_tag FROM TAG");
+        query_tag_ids.exec();
         if (query_tag_ids.lastError().isValid())
         {
             // Can not select tag in DB.
@@ -1087,9 +2315,11 @@ bool Data_persistence::reorganize_track_pos_in_tag_list() // TODO: do it only fo
             while (query_tag_ids.next() == true)
             {
                 int pos = 0;
-                QSqlQuery query_tracklist = this->db.exec("SELECT id_track_tag, position FROM TRACK_TAG "
-                                                          "WHERE TRACK_TAG.id_tag=" + query_tag_ids.value(0).toString() + " "
-                                                          "ORDER BY CASE WHEN position IS NULL THEN 1 ELSE 0 END, position");
+                QSqlQuery &query_tracklist = this->get_query("SELECT id_track_tag, position FROM TRACK_TAG "
+                                                             "WHERE TRACK_TAG.id_tag = :id_tag "
+                                                             "ORDER BY CASE WHEN position IS NULL THEN 1 ELSE 0 END, position");
+                query_tracklist.bindValue(":id_tag", query_tag_ids.value(0));
+                query_tracklist.exec();
                 if (query_tracklist.lastError().isValid())
                 {
                     // Can not select tag in DB.
@@ -1100,13 +2330,12 @@ bool Data_persistence::reorganize_track_pos_in_tag_list() // TODO: do it only fo
                 {
                     // For each tag_track association (which are ordered), overwrite the position starting from 0.
                     // tag_track associations with no position are append at the end.
-                    QSqlQuery query_update_tracklist(this->db);
+                    QSqlQuery &query_update_tracklist = this->get_query("UPDATE TRACK_TAG SET position = :position "
+                                                                        "WHERE id_track_tag = :id_track_tag");
                     while (query_tracklist.next() == true)
                     {
-                        query_update_tracklist.prepare("UPDATE TRACK_TAG SET position = :position "
-                                                       "WHERE id_track_tag = :id_track_tag");
-                        query_update_tracklist.bindValue(":position", QString::number(pos));
-                        query_update_tracklist.bindValue(":id_track_tag", query_tracklist.value(0).toString());
+                        query_update_tracklist.bindValue(":position", pos);
+                        query_update_tracklist.bindValue(":id_track_tag", query_tracklist.value(0));
                         query_update_tracklist.exec();
 
                         if (query_update_tracklist.lastError().isValid())
@@ -1117,11 +2346,23 @@ bool Data_persistence::reorganize_track_pos_in_tag_list() // TODO: do it only fo
 
                         pos++;
                     }
+                    query_update_tracklist.finish();
                 }
+                query_tracklist.finish();
             }
         }
+        query_tag_ids.finish();
+
+        // Positions of tracks in all tracklists may have changed.
+        this->cache_mutex.lock();
+        this->cache_generation++;
+        foreach (const QString &hash, this->cache.keys())
+        {
+            this->cache.object(hash)->tag_positions.clear();
+        }
+        this->cache_mutex.unlock();
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
 
@@ -1133,15 +2374,27 @@ int Data_persistence::get_track_pos_in_tag_list(const QSharedPointer<Audio_track
 {
     int pos = -1;
 
-    if (this->is_initialized == true)
+    // Use cached position if any.
+    this->cache_mutex.lock();
+    Track_cache_entry *entry      = this->cache.object(at->get_hash());
+    bool               is_cached  = (entry != nullptr) && (entry->tag_positions.contains(tag_name) == true);
+    quint64            generation = this->cache_generation;
+    if (is_cached == true)
     {
-        // Ensure no other thread can access the DB connection.
-        this->mutex.lock();
+        pos = entry->tag_positions.value(tag_name);
+    }
+    this->cache_mutex.unlock();
 
-        QSqlQuery query = this->db.exec("SELECT TRACK_TAG.position FROM TRACK_TAG "
-                                        "JOIN TRACK ON TRACK.id_track=TRACK_TAG.id_track "
-                                        "JOIN TAG ON TAG.id_tag=TRACK_TAG.id_tag "
-                                        "WHERE TRACK.hash=\"" + at->get_hash() + "\" AND TAG.name=\"" + tag_name + "\"");
+    if ((is_cached == false) &&
+        (this->is_initialized == true))
+    {
+        QSqlQuery &query = this->get_query("SELECT TRACK_TAG.position FROM TRACK_TAG "
+                                           "JOIN TRACK ON TRACK.id_track=TRACK_TAG.id_track "
+                                           "JOIN TAG ON TAG.id_tag=TRACK_TAG.id_tag "
+                                           "WHERE TRACK.hash = :hash AND TAG.name = :name");
+        query.bindValue(":hash", at->get_hash());
+        query.bindValue(":name", tag_name);
+        query.exec();
         if (query.lastError().isValid())
         {
             // Can not select position in DB.
@@ -1154,10 +2407,16 @@ int Data_persistence::get_track_pos_in_tag_list(const QSharedPointer<Audio_track
                 // Get position of track in the tracklist of the specified tag.
                 pos = query.value(0).toInt();
             }
-        }
 
-        // Release the DB connection.
-        this->mutex.unlock();
+            // Cache it if nothing was written meanwhile.
+            this->cache_mutex.lock();
+            if (generation == this->cache_generation)
+            {
+                this->get_cache_entry(at->get_hash())->tag_positions.insert(tag_name, pos);
+            }
+            this->cache_mutex.unlock();
+        }
+        query.finish();
     }
 
     return pos;
@@ -1172,16 +2431,15 @@ bool Data_persistence::set_track_position_in_tag_list(const QString &tag_name,
 
     if (this->is_initialized == true)
     {
-        // Ensure no other thread can access the DB connection.
+        // Only one writer at a time.
         this->mutex.lock();
 
-        QSqlQuery query_update_pos(this->db);
-        query_update_pos.prepare("UPDATE TRACK_TAG SET position = :position "
-                                 "WHERE id_track_tag = (SELECT TRACK_TAG.id_track_tag FROM TRACK_TAG "
-                                                        "JOIN TRACK ON TRACK.id_track = TRACK_TAG.id_track "
-                                                        "JOIN TAG ON TAG.id_tag = TRACK_TAG.id_tag "
-                                                        "WHERE TRACK.hash = :hash AND TAG.name = :tag)");
-        query_update_pos.bindValue(":position", QString::number(position));
+        QSqlQuery &query_update_pos = this->get_query("UPDATE TRACK_TAG SET position = :position "
+                                                      "WHERE id_track_tag = (SELECT TRACK_TAG.id_track_tag FROM TRACK_TAG "
+                                                                             "JOIN TRACK ON TRACK.id_track = TRACK_TAG.id_track "
+                                                                             "JOIN TAG ON TAG.id_tag = TRACK_TAG.id_tag "
+                                                                             "WHERE TRACK.hash = :hash AND TAG.name = :tag)");
+        query_update_pos.bindValue(":position", position);
         query_update_pos.bindValue(":hash", at->get_hash());
         query_update_pos.bindValue(":tag", tag_name);
         query_update_pos.exec();
@@ -1190,8 +2448,23 @@ bool Data_persistence::set_track_position_in_tag_list(const QString &tag_name,
             qCWarning(DS_DB) << "UPDATE position failed: " << query_update_pos.lastError().text();
             result = false;
         }
+        query_update_pos.finish();
+
+        // Update cached position.
+        this->cache_mutex.lock();
+        this->cache_generation++;
+        Track_cache_entry *entry = this->cache.object(at->get_hash());
+        if ((result == true) && (entry != nullptr))
+        {
+            entry->tag_positions.insert(tag_name, position);
+        }
+        else
+        {
+            this->cache.remove(at->get_hash());
+        }
+        this->cache_mutex.unlock();
 
-        // Release the DB connection.
+        // Release the writer lock.
         this->mutex.unlock();
     }
 
@@ -39,10 +39,14 @@
 #include <QScopedPointer>
 #include <QSharedPointer>
 #include <QLocale>
+#include <QThreadStorage>
+#include <QHash>
 
 #include "tracks/audio_track.h"
-#include "tracks/audio_file_decoding_process.h"
+#include "tracks/audio_file_analysis_decoding_process.h"
 #include "tracks/audio_track_key_process.h"
+#include "tracks/audio_track_bpm_process.h"
+#include "tracks/audio_track_overview.h"
 #include "app/application_settings.h"
 #include "app/application_logging.h"
 #include "singleton.h"
@@ -110,21 +114,51 @@ QString Utils::file_read_all_text(const QString &path)
 
 }
 
+// One analysis decoder per thread, so its buffers are reused from one file to the next.
+static QThreadStorage<QSharedPointer<Audio_file_analysis_decoding_process>> analysis_decoders;
+
+static QSharedPointer<Audio_file_analysis_decoding_process> get_analysis_decoder()
+{
+    if (analysis_decoders.hasLocalData() == false)
+    {
+        analysis_decoders.setLocalData(QSharedPointer<Audio_file_analysis_decoding_process>(new Audio_file_analysis_decoding_process()));
+    }
+
+    return analysis_decoders.localData();
+}
+
+// Overview needs the full track, it uses its own decoder (also one per thread).
+static QThreadStorage<QSharedPointer<Audio_file_analysis_decoding_process>> overview_decoders;
+
+static QSharedPointer<Audio_file_analysis_decoding_process> get_overview_decoder()
+{
+    if (overview_decoders.hasLocalData() == false)
+    {
+        overview_decoders.setLocalData(QSharedPointer<Audio_file_analysis_decoding_process>(
+                                           new Audio_file_analysis_decoding_process(ANALYSIS_SAMPLE_RATE, 0)));
+    }
+
+    return overview_decoders.localData();
+}
+
 QString Utils::get_file_music_key(const QString &path)
 {
     // Init result.
     QString result = "";
 
-    // Decode the audio track.
-    QSharedPointer<Audio_track>                 at(new Audio_track(10, 44100)); // Force 44100 to calculate music key.
-    QScopedPointer<Audio_file_decoding_process> dec(new Audio_file_decoding_process(at, false));
-    dec->run(path, "", "");
+    // Decode a light version (mono, low sample rate) of the audio track.
+    QSharedPointer<Audio_file_analysis_decoding_process> dec = get_analysis_decoder();
+    if (dec->run(path) == false)
+    {
+        qCWarning(DS_FILE) << "cannot decode " << path;
+        return result;
+    }
 
     // Compute the music key.
-    QScopedPointer<Audio_track_key_process> key_proc(new Audio_track_key_process(at));
+    QScopedPointer<Audio_track_key_process> key_proc(new Audio_track_key_process(dec));
     if (key_proc->run() == true)
     {
-        result = at->get_music_key();
+        result = key_proc->get_music_key();
     }
     else
     {
@@ -135,149 +169,189 @@ QString Utils::get_file_music_key(const QString &path)
     return result;
 }
 
-QString Utils::convert_music_key_to_clock_number(const QString &key)
+bool Utils::analyse_audio_file(const QString &path,
+                               QString       &music_key,
+                               float         &bpm,
+                               unsigned int  &first_beat)
 {
-    QMap<QString, QString> key_map; // Map music key to clock number.
-    key_map.insert("AM",  "11B");
-    key_map.insert("Am",  "08A");
-    key_map.insert("BbM", "06B");
-    key_map.insert("Bbm", "03A");
-    key_map.insert("BM",  "01B");
-    key_map.insert("Bm",  "10A");
-    key_map.insert("CM",  "08B");
-    key_map.insert("Cm",  "05A");
-    key_map.insert("DbM", "03B");
-    key_map.insert("Dbm", "12A");
-    key_map.insert("DM",  "10B");
-    key_map.insert("Dm",  "07A");
-    key_map.insert("EbM", "05B");
-    key_map.insert("Ebm", "02A");
-    key_map.insert("EM",  "12B");
-    key_map.insert("Em",  "09A");
-    key_map.insert("FM",  "07B");
-    key_map.insert("Fm",  "04A");
-    key_map.insert("GbM", "02B");
-    key_map.insert("Gbm", "11A");
-    key_map.insert("GM",  "09B");
-    key_map.insert("Gm",  "06A");
-    key_map.insert("AbM", "04B");
-    key_map.insert("Abm", "01A");
+    // Init result.
+    bool result = true;
+    music_key  = "";
+    bpm        = 0.0;
+    first_beat = 0;
+
+    // Decode a light version (mono, low sample rate) of the audio track, shared by all analysis.
+    QSharedPointer<Audio_file_analysis_decoding_process> dec = get_analysis_decoder();
+    if (dec->run(path) == false)
+    {
+        qCWarning(DS_FILE) << "cannot decode " << path;
+        return false;
+    }
 
-    return key_map.value(key, "");
-}
+    // Compute the music key.
+    QScopedPointer<Audio_track_key_process> key_proc(new Audio_track_key_process(dec));
+    if (key_proc->run() == true)
+    {
+        music_key = key_proc->get_music_key();
+    }
+    else
+    {
+        qCWarning(DS_FILE) << "cannot get music key for " << path;
+        result = false;
+    }
+
+    // Compute tempo and beat grid.
+    QScopedPointer<Audio_track_bpm_process> bpm_proc(new Audio_track_bpm_process(dec));
+    if (bpm_proc->run() == true)
+    {
+        bpm        = bpm_proc->get_bpm();
+        first_beat = bpm_proc->get_first_beat();
+    }
+    else
+    {
+        qCWarning(DS_FILE) << "cannot get bpm for " << path;
+        result = false;
+    }
 
-QList<QString> Utils::minor_keys;
-QList<QString> Utils::major_keys;
+    // Return result.
+    return result;
+}
 
-void Utils::setup_keys()
+bool Utils::get_file_overview(const QString &path,
+                              QByteArray    &out_data)
 {
-    minor_keys.append("01A");
-    minor_keys.append("02A");
-    minor_keys.append("03A");
-    minor_keys.append("04A");
-    minor_keys.append("05A");
-    minor_keys.append("06A");
-    minor_keys.append("07A");
-    minor_keys.append("08A");
-    minor_keys.append("09A");
-    minor_keys.append("10A");
-    minor_keys.append("11A");
-    minor_keys.append("12A");
-
-    major_keys.append("01B");
-    major_keys.append("02B");
-    major_keys.append("03B");
-    major_keys.append("04B");
-    major_keys.append("05B");
-    major_keys.append("06B");
-    major_keys.append("07B");
-    major_keys.append("08B");
-    major_keys.append("09B");
-    major_keys.append("10B");
-    major_keys.append("11B");
-    major_keys.append("12B");
+    // Decode a light version (mono, low sample rate) of the full audio track.
+    QSharedPointer<Audio_file_analysis_decoding_process> dec = get_overview_decoder();
+    if (dec->run(path) == false)
+    {
+        qCWarning(DS_FILE) << "cannot decode " << path;
+        return false;
+    }
+
+    // Summarize it, it is serialized independently of the sample rate.
+    Audio_track_overview overview(dec->get_nb_samples());
+    overview.compute(dec->get_short_samples(), dec->get_nb_samples(), 1);
+
+    return overview.to_byte_array(dec->get_sample_rate(), out_data);
 }
 
-void Utils::get_next_music_keys(const QString &key,
-                                QString &next_key,
-                                QString &prev_key,
-                                QString &next_major_key)
+QString Utils::convert_music_key_to_clock_number(const QString &key)
 {
-    QString         result = "";
-    QList<QString> *keys   = nullptr;
+    // Map music key to clock number (built only once).
+    static const QHash<QString, QString> key_map = {
+        {"AM",  "11B"}, {"Am",  "08A"},
+        {"BbM", "06B"}, {"Bbm", "03A"},
+        {"BM",  "01B"}, {"Bm",  "10A"},
+        {"CM",  "08B"}, {"Cm",  "05A"},
+        {"DbM", "03B"}, {"Dbm", "12A"},
+        {"DM",  "10B"}, {"Dm",  "07A"},
+        {"EbM", "05B"}, {"Ebm", "02A"},
+        {"EM",  "12B"}, {"Em",  "09A"},
+        {"FM",  "07B"}, {"Fm",  "04A"},
+        {"GbM", "02B"}, {"Gbm", "11A"},
+        {"GM",  "09B"}, {"Gm",  "06A"},
+        {"AbM", "04B"}, {"Abm", "01A"}
+    };
 
-    // Init minor/major key list if not already done.
-    if (minor_keys.size() == 0)
+    return key_map.value(key, "");
+}
+
+int Utils::get_music_key_code(const QString &key)
+{
+    // Clock number is 2 digits (01 to 12) followed by A (minor) or B (major).
+    if (key.length() != 3)
+    {
+        return -1;
+    }
+    bool is_number = false;
+    int  number    = key.left(2).toInt(&is_number);
+    if ((is_number == false) || (number < 1) || (number > 12))
     {
-        Utils::setup_keys();
+        return -1;
+    }
+    if (key[2] == 'A')
+    {
+        return number - 1;
+    }
+    else if (key[2] == 'B')
+    {
+        return number - 1 + 12;
     }
 
-    // Init returned keys.
-    next_key       = "";
-    prev_key       = "";
-    next_major_key = "";
+    return -1;
+}
 
-    if (key.length() >= 2)
+QString Utils::get_music_key_from_code(const int &code)
+{
+    if ((code < 0) || (code >= NB_MUSIC_KEYS))
     {
-        int index = 0;
+        return "";
+    }
 
-        // Try to find music key in minor keys.
-        index = minor_keys.indexOf(key);
+    return QString("%1%2").arg(code % 12 + 1, 2, 10, QChar('0')).arg(code < 12 ? 'A' : 'B');
+}
 
-        if (index == -1)
-        {
-            // Key not found, try to find music key in major keys.
-            index = major_keys.indexOf(key);
+void Utils::get_next_music_key_masks(const int &code,
+                                     quint32   &next_keys,
+                                     quint32   &next_major_keys)
+{
+    // Compatible keys of all keys (computed only once).
+    struct Key_masks
+    {
+        quint32 next[NB_MUSIC_KEYS];
+        quint32 next_major[NB_MUSIC_KEYS];
 
-            if (index == -1)
-            {
-                qCWarning(DS_MUSICKEY) << "cannot find next key of " << key;
-            }
-            else
+        Key_masks()
+        {
+            for (int key = 0; key < NB_MUSIC_KEYS; key++)
             {
-                // Key is major.
-                keys = &major_keys;
+                // Next and previous keys are in the same minor/major circle, opposite key has the same number.
+                int circle            = key - (key % 12);
+                this->next[key]       = (1u << (circle + (key + 1) % 12)) | (1u << (circle + (key + 11) % 12));
+                this->next_major[key] = 1u << ((key + 12) % NB_MUSIC_KEYS);
             }
         }
-        else
-        {
-            // Key is minor.
-            keys = &minor_keys;
-        }
+    };
+    static const Key_masks masks;
 
-        if (keys != nullptr)
-        {
-            // Get the next key from minor or major list.
-            if ((index + 1) > (keys->size() - 1))
-            {
-                next_key = keys->first(); // key is the last one, so the next one is the first in the list.
-            }
-            else
-            {
-                next_key = keys->at(index + 1);
-            }
+    if ((code < 0) || (code >= NB_MUSIC_KEYS))
+    {
+        next_keys       = 0;
+        next_major_keys = 0;
+    }
+    else
+    {
+        next_keys       = masks.next[code];
+        next_major_keys = masks.next_major[code];
+    }
+}
 
-            // Get the previous key from minor or major list.
-            if ((index - 1) < 0)
-            {
-                prev_key = keys->last(); // key is the first one, so the previous one is the last in the list.
-            }
-            else
-            {
-                prev_key = keys->at(index - 1);
-            }
+void Utils::get_next_music_keys(const QString &key,
+                                QString &next_key,
+                                QString &prev_key,
+                                QString &next_major_key)
+{
+    // Init returned keys.
+    next_key       = "";
+    prev_key       = "";
+    next_major_key = "";
 
-            // Get the opposite (minor/major) key.
-            if (keys == &minor_keys)
-            {
-                next_major_key = major_keys.at(index);
-            }
-            else
-            {
-                next_major_key = minor_keys.at(index);
-            }
+    int code = Utils::get_music_key_code(key);
+    if (code == -1)
+    {
+        if (key.length() >= 2)
+        {
+            qCWarning(DS_MUSICKEY) << "cannot find next key of " << key;
         }
     }
+    else
+    {
+        // Next and previous keys in the same minor/major circle, then opposite key.
+        int circle     = code - (code % 12);
+        next_key       = Utils::get_music_key_from_code(circle + (code + 1) % 12);
+        prev_key       = Utils::get_music_key_from_code(circle + (code + 11) % 12);
+        next_major_key = Utils::get_music_key_from_code((code + 12) % NB_MUSIC_KEYS);
+    }
 
     return;
 }
@@ -0,0 +1,213 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Benchmark                       */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QThread>
+#include <QFile>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <cmath>
+
+#include "singleton.h"
+#include "app/application_settings.h"
+#include "audiodev/file_audio_io.h"
+#include "tracks/audio_collection_model.h"
+#include "tracks/data_persistence.h"
+#include "audio_collection_benchmark.h"
+
+using namespace std;
+
+#define DATA_DIR              "./test/data/"
+#define DATA_TRACK_1          "track_1.mp3"
+#define DATA_TRACK_2          "track_2.mp3"
+#define BENCH_NB_FILES        24      // Files of the synthetic library (half WAV, half MP3).
+#define BENCH_WAV_DURATION    10      // Duration of synthetic WAV files (sec).
+#define BENCH_SAMPLE_RATE     44100
+#define BENCH_TWO_PI          6.2831853f
+#define ID3V1_TAG_SIZE        128
+
+Audio_collection_Benchmark::Audio_collection_Benchmark()
+{
+    this->max_thread_count = 0;
+    this->full_refresh     = false;
+}
+
+bool Audio_collection_Benchmark::generate_library(const QString &path, const int &seed)
+{
+    QRandomGenerator random(seed);
+    QVector<short signed int> samples(BENCH_WAV_DURATION * BENCH_SAMPLE_RATE * 2);
+    for (int i = 0; i < BENCH_NB_FILES; i++)
+    {
+        QString file_path = QString("%1/%2_%3").arg(path).arg(seed).arg(i, 3, 10, QChar('0'));
+        if (i % 2 == 0)
+        {
+            // WAV: chord of 3 random notes, so each file has its own content (and hash).
+            float freqs[3];
+            for (int n = 0; n < 3; n++)
+            {
+                freqs[n] = 110.0f * pow(2.0f, (float)random.bounded(36) / 12.0f);
+            }
+            for (int f = 0; f < BENCH_WAV_DURATION * BENCH_SAMPLE_RATE; f++)
+            {
+                float t      = (float)f / BENCH_SAMPLE_RATE;
+                float sample = (sin(BENCH_TWO_PI * freqs[0] * t) +
+                                sin(BENCH_TWO_PI * freqs[1] * t) +
+                                sin(BENCH_TWO_PI * freqs[2] * t)) / 3.0f;
+                samples[f * 2]     = (short signed int)(sample * SHRT_MAX * 0.8f);
+                samples[f * 2 + 1] = samples[f * 2];
+            }
+            if (File_audio_io::write_wav_file(file_path + ".wav", samples.constData(), BENCH_WAV_DURATION * BENCH_SAMPLE_RATE, BENCH_SAMPLE_RATE) == false)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // MP3: copy of a test track with a unique ID3v1 tag (changes its size, so its hash).
+            QByteArray tag(ID3V1_TAG_SIZE, '\0');
+            tag.replace(0, 3, "TAG");
+            QByteArray title = QString("bench %1 %2").arg(seed).arg(i).toLatin1().left(30);
+            tag.replace(3, title.size(), title);
+            tag.replace(ID3V1_TAG_SIZE - 1, 1, QByteArray(1, (char)0xFF));
+            QByteArray data = this->mp3_files[(i / 2) % this->mp3_files.size()];
+            data.append(QByteArray(2 * ((seed % 1024) * BENCH_NB_FILES + i + 1), '\0')); // Padding, so the middle of each copy (hashed data) is different.
+            data.append(tag);
+
+            QFile file(file_path + ".mp3");
+            if ((file.open(QIODevice::WriteOnly) == false) || (file.write(data) != data.size()))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void Audio_collection_Benchmark::initTestCase()
+{
+    QStringList tracks = { DATA_TRACK_1, DATA_TRACK_2 };
+    foreach (QString track, tracks)
+    {
+        QFile file(QString(DATA_DIR) + track);
+        QVERIFY2(file.open(QIODevice::ReadOnly) == true, "read test track");
+        this->mp3_files << file.readAll();
+    }
+
+    // Analyse all files, not only the ones with missing data.
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    this->full_refresh     = settings->get_audio_collection_full_refresh();
+    this->max_thread_count = QThreadPool::globalInstance()->maxThreadCount();
+    settings->set_audio_collection_full_refresh(true);
+
+    // Generated tracks go to an empty DB (benchmark build uses its own test DB file).
+    QVERIFY2(Singleton<Data_persistence>::get_instance().reset_db() == true, "DB reset");
+}
+
+void Audio_collection_Benchmark::cleanupTestCase()
+{
+    Singleton<Application_settings>::get_instance().set_audio_collection_full_refresh(this->full_refresh);
+    QThreadPool::globalInstance()->setMaxThreadCount(this->max_thread_count);
+
+    // Do not leave generated tracks and file index for next runs.
+    QVERIFY2(Singleton<Data_persistence>::get_instance().reset_db() == true, "DB reset");
+}
+
+void Audio_collection_Benchmark::benchmarkScanAndAnalyse_data()
+{
+    QTest::addColumn<int>("nb_threads");
+
+    QList<int> nb_threads = { 1, 2, 4 };
+    if (nb_threads.contains(QThread::idealThreadCount()) == false)
+    {
+        nb_threads << QThread::idealThreadCount();
+    }
+    foreach (int nb, nb_threads)
+    {
+        QTest::newRow(qPrintable(QString("%1 threads").arg(nb))) << nb;
+    }
+}
+
+/**
+ * Benchmark:
+ *   Audio_collection_model::set_root_path()              (scan and hash)
+ *   Audio_collection_model::concurrent_read_collection_from_db()
+ *   Audio_collection_model::concurrent_analyse_audio_collection()  (key and tempo)
+ *   Audio_collection_model::write_collection_to_db()
+ *
+ * A new library is generated for each row (seeded by time), so files are new
+ * for the file index and the DB. Result is the time per file of the whole pipeline,
+ * files/second of each step are printed next to it.
+ */
+void Audio_collection_Benchmark::benchmarkScanAndAnalyse()
+{
+    QFETCH(int, nb_threads);
+
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid() == true, "temporary library directory");
+    int seed = (int)(QDateTime::currentMSecsSinceEpoch() / 1000) + nb_threads;
+    QVERIFY2(this->generate_library(dir.path(), seed) == true, "generate library");
+    QThreadPool::globalInstance()->setMaxThreadCount(nb_threads);
+
+    Audio_collection_model model;
+    QElapsedTimer          timer;
+    qint64                 step_ns[4];
+
+    timer.start();
+    model.set_root_path(dir.path());
+    step_ns[0] = timer.nsecsElapsed();
+    QVERIFY2(model.get_nb_items() == BENCH_NB_FILES, "all files scanned");
+
+    timer.start();
+    model.concurrent_read_collection_from_db();
+    model.concurrent_watcher_read->waitForFinished();
+    step_ns[1] = timer.nsecsElapsed();
+
+    timer.start();
+    model.concurrent_analyse_audio_collection();
+    model.concurrent_watcher_analyze->waitForFinished();
+    step_ns[2] = timer.nsecsElapsed();
+
+    timer.start();
+    model.write_collection_to_db();
+    step_ns[3] = timer.nsecsElapsed();
+
+    // Report.
+    const char *step_names[4] = { "scan+hash", "db read", "analysis", "db write" };
+    qint64 total_ns = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        qInfo().nospace() << step_names[i] << ": " << (BENCH_NB_FILES * 1e9 / qMax(step_ns[i], (qint64)1)) << " files/s";
+        total_ns += step_ns[i];
+    }
+    qInfo().nospace() << "total: " << (BENCH_NB_FILES * 1e9 / total_ns) << " files/s";
+    QTest::setBenchmarkResult((qreal)total_ns / BENCH_NB_FILES, QTest::WalltimeNanoseconds);
+}
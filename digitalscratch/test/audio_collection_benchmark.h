@@ -0,0 +1,55 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Benchmark                       */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QObject>
+#include <QtTest>
+#include <QByteArray>
+#include <QList>
+
+class Audio_collection_Benchmark : public QObject
+{
+    Q_OBJECT
+
+ private:
+    QList<QByteArray> mp3_files;          // Content of test MP3 files, copied to the synthetic library.
+    int               max_thread_count;   // Initial size of the global thread pool.
+    bool              full_refresh;       // Initial setting of the audio collection analysis.
+
+ public:
+    Audio_collection_Benchmark();
+
+ private:
+    bool generate_library(const QString &path, const int &seed);
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkScanAndAnalyse_data();
+    void benchmarkScanAndAnalyse();
+};
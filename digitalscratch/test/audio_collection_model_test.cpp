@@ -0,0 +1,183 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Test                            */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include "audio_collection_model_test.h"
+#include "tracks/audio_collection_model.h"
+#include "tracks/data_persistence.h"
+#include "app/application_settings.h"
+#include "singleton.h"
+
+#define DATA_DIR     "./test/data/"
+#define DATA_TRACK_1 "track_1.mp3"
+#define DATA_TRACK_2 "track_2.mp3"
+#define DATA_TRACK_3 "track_éèà@ù&_3.mp3"
+
+#define CHANGES_TIMEOUT_MS 30000 // Changes are applied after DIRECTORY_CHANGES_DELAY_MS and analysis of new files.
+
+static bool l_is_file_shown(Audio_collection_model &model, const QString &file_name)
+{
+    for (int row = 0; row < model.rowCount(); row++)
+    {
+        if (model.data(model.index(row, COLUMN_FILE_NAME), Qt::DisplayRole).toString() == file_name)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+Audio_collection_model_Test::Audio_collection_model_Test()
+{
+}
+
+void Audio_collection_model_Test::initTestCase()
+{
+}
+
+void Audio_collection_model_Test::cleanupTestCase()
+{
+}
+
+void Audio_collection_model_Test::testCaseAnalyseOnlyOnce()
+{
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    bool full_refresh = settings->get_audio_collection_full_refresh();
+    settings->set_audio_collection_full_refresh(false);
+
+    // A file which can not be decoded: no key and no tempo.
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid() == true, "temporary dir");
+    QString path = dir.path() + "/not_audio.mp3";
+    QFile file(path);
+    QVERIFY2(file.open(QIODevice::WriteOnly) == true, "create file");
+    file.write("not an audio file");
+    file.close();
+
+    // First analysis marks the track as analysed.
+    Audio_collection_item item("hash", path);
+    item.compute_audio_characteristics();
+    QCOMPARE(item.get_data(COLUMN_BPM).toFloat(), (float)BPM_NOT_DETECTED);
+    QCOMPARE(item.get_data(COLUMN_KEY).toString(), QString(""));
+
+    // Next refresh does not analyse it again (the key set here would be erased).
+    item.set_data(COLUMN_KEY, "01A");
+    item.compute_audio_characteristics();
+    QCOMPARE(item.get_data(COLUMN_KEY).toString(), QString("01A"));
+
+    // Unless a full refresh is asked.
+    settings->set_audio_collection_full_refresh(true);
+    item.compute_audio_characteristics();
+    QCOMPARE(item.get_data(COLUMN_KEY).toString(), QString(""));
+    QCOMPARE(item.get_data(COLUMN_BPM).toFloat(), (float)BPM_NOT_DETECTED);
+
+    settings->set_audio_collection_full_refresh(full_refresh);
+}
+
+void Audio_collection_model_Test::testCaseDirectoryChanges()
+{
+    // Collection of 2 files.
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid() == true, "temporary dir");
+    QString root = QDir(dir.path()).absolutePath();
+    QVERIFY2(QFile::copy(QString(DATA_DIR) + DATA_TRACK_1, root + "/" + DATA_TRACK_1) == true, "copy track 1");
+    QVERIFY2(QFile::copy(QString(DATA_DIR) + DATA_TRACK_2, root + "/" + DATA_TRACK_2) == true, "copy track 2");
+
+    Audio_collection_model model;
+    model.set_root_path(root);
+    QCOMPARE(model.get_nb_items(), 2);
+    QCOMPARE(model.rowCount(), 2);
+    QTest::qWait(100); // Directories are watched from the event loop.
+
+    // Add a file: a row is added for it, and it is in the file index.
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QHash<QString, File_index_entry> index;
+    QString new_file = root + "/new_track.mp3";
+    QVERIFY2(QFile::copy(QString(DATA_DIR) + DATA_TRACK_3, new_file) == true, "add a file");
+    QTRY_COMPARE_WITH_TIMEOUT(model.get_nb_items(), 3, CHANGES_TIMEOUT_MS);
+    QCOMPARE(model.rowCount(), 3);
+    QVERIFY2(l_is_file_shown(model, "new_track.mp3") == true, "row of new file");
+    QVERIFY2(data_persist->get_file_index(root, index) == true, "get file index");
+    QVERIFY2(index.contains(new_file) == true,                  "new file is indexed");
+    QVERIFY2(index[new_file].hash == Utils::get_file_hash(new_file), "hash of new file");
+
+    // Remove a file: its row and its file index entry are removed, other ones are kept.
+    model.stop_concurrent_analyse_audio_collection();
+    QVERIFY2(QFile::remove(root + "/" + DATA_TRACK_1) == true, "remove a file");
+    QTRY_COMPARE_WITH_TIMEOUT(model.get_nb_items(), 2, CHANGES_TIMEOUT_MS);
+    QCOMPARE(model.rowCount(), 2);
+    QVERIFY2(l_is_file_shown(model, DATA_TRACK_1)    == false, "no row of removed file");
+    QVERIFY2(l_is_file_shown(model, DATA_TRACK_2)    == true,  "row of unchanged file");
+    QVERIFY2(l_is_file_shown(model, "new_track.mp3") == true,  "row of added file");
+    QVERIFY2(data_persist->get_file_index(root, index) == true,        "get file index again");
+    QVERIFY2(index.contains(root + "/" + DATA_TRACK_1) == false,       "removed file is not indexed");
+    QVERIFY2(index.contains(new_file) == true,                         "added file is still indexed");
+
+    model.stop_concurrent_analyse_audio_collection();
+}
+
+void Audio_collection_model_Test::testCaseFetchMore()
+{
+    // Collection of a bit more than one batch of rows (files do not need to be decodable).
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid() == true, "temporary dir");
+    int nb_files = FETCH_ROWS_BATCH_SIZE + 10;
+    for (int i = 0; i < nb_files; i++)
+    {
+        QFile file(QString("%1/%2.mp3").arg(dir.path()).arg(i, 4, 10, QChar('0')));
+        QVERIFY2(file.open(QIODevice::WriteOnly) == true, "create file");
+        file.write(QByteArray::number(i));
+        file.close();
+    }
+
+    // All items exist, but only the first batch of rows is shown.
+    Audio_collection_model model;
+    model.set_root_path(dir.path());
+    QCOMPARE(model.get_nb_items(), nb_files);
+    QCOMPARE(model.rowCount(), FETCH_ROWS_BATCH_SIZE);
+    QVERIFY2(model.canFetchMore(QModelIndex()) == true, "more rows to fetch");
+    QVERIFY2(model.canFetchMore(model.index(0, 0)) == false, "files have no rows to fetch");
+
+    // Next batch shows remaining rows.
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), nb_files);
+    QVERIFY2(model.canFetchMore(QModelIndex()) == false, "no more rows to fetch");
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), nb_files);
+
+    // All rows are shown at once before sorting or filtering them.
+    model.set_root_path(dir.path());
+    QCOMPARE(model.rowCount(), FETCH_ROWS_BATCH_SIZE);
+    model.fetch_all_rows();
+    QCOMPARE(model.rowCount(), nb_files);
+    QVERIFY2(model.canFetchMore(QModelIndex()) == false, "all rows fetched");
+}
@@ -0,0 +1,46 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Test                            */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QObject>
+#include <QtTest>
+
+class Audio_collection_model_Test : public QObject
+{
+    Q_OBJECT
+
+public:
+    Audio_collection_model_Test();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testCaseAnalyseOnlyOnce();
+    void testCaseDirectoryChanges();
+    void testCaseFetchMore();
+};
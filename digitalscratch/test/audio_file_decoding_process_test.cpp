@@ -31,11 +31,13 @@
 #include "audio_file_decoding_process_test.h"
 #include "tracks/audio_track.h"
 #include "tracks/audio_file_decoding_process.h"
+#include "tracks/audio_file_analysis_decoding_process.h"
 #include "utils.h"
 
 #define DATA_DIR     "./test/data/"
 #define DATA_TRACK_1 "track_1.mp3"
 #define DATA_TRACK_2 "b_comp_-_p_dust.mp3"
+#define DATA_TRACK_3 "scratchlivecontrol-vinylrip-33rpm+0.mp3"
 
 Audio_file_decoding_process_Test::Audio_file_decoding_process_Test()
 {
@@ -82,3 +84,21 @@ void Audio_file_decoding_process_Test::testCaseRun()
     QVERIFY2(decoder.run(file_info_2.absoluteFilePath(), "", "") == true,  "decode normal sized mp3");
 }
 
+void Audio_file_decoding_process_Test::testCaseRunAnalysis()
+{
+    // Decode full track (default settings but the track is too short to be split).
+    Audio_file_analysis_decoding_process decoder;
+    QVERIFY2(decoder.run("") == false,                              "bad file path");
+    QVERIFY2(decoder.get_nb_samples() == 0,                         "no samples");
+    QFileInfo file_info = QFileInfo(QString(DATA_DIR) + QString(DATA_TRACK_1));
+    QVERIFY2(decoder.run(file_info.absoluteFilePath()) == true,     "decode small mp3");
+    QVERIFY2(decoder.get_sample_rate() == ANALYSIS_SAMPLE_RATE,     "sample rate");
+    QVERIFY2(decoder.get_nb_samples() > ANALYSIS_SAMPLE_RATE * 10,  "nb samples of small mp3");
+
+    // Decode only 2 parts of 5 seconds.
+    Audio_file_analysis_decoding_process decoder_2(ANALYSIS_SAMPLE_RATE, 2, 5);
+    QFileInfo file_info_2 = QFileInfo(QString(DATA_DIR) + QString(DATA_TRACK_3));
+    QVERIFY2(decoder_2.run(file_info_2.absoluteFilePath()) == true, "decode 2 parts");
+    QVERIFY2(decoder_2.get_nb_samples() == 2 * 5 * ANALYSIS_SAMPLE_RATE, "nb samples of 2 parts");
+    QVERIFY2(decoder_2.get_short_samples() != nullptr,               "integer samples");
+}
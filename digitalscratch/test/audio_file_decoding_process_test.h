@@ -43,4 +43,5 @@ private Q_SLOTS:
 
     void testCaseCreate();
     void testCaseRun();
+    void testCaseRunAnalysis();
 };
@@ -28,6 +28,7 @@
 
 #include <QString>
 #include <QtTest>
+#include <climits>
 #include "audio_track_test.h"
 #include "tracks/audio_track.h"
 #include "tracks/audio_file_decoding_process.h"
@@ -115,3 +116,68 @@ void Audio_track_Test::testCaseSetPath()
     delete at;
 }
 
+void Audio_track_Test::testCaseOverview()
+{
+    // A track without samples does not have any overview.
+    Audio_track *at_no_samples = new Audio_track(44100);
+    QVERIFY2(at_no_samples->get_overview() == nullptr, "no overview");
+    delete at_no_samples;
+
+    // Fill a track with a low signal and a peak at the end.
+    QSharedPointer<Audio_track> at(new Audio_track(1, 44100));
+    short signed int *samples = at->get_samples();
+    unsigned int nb_frames = 10000;
+    for (unsigned int i = 0; i < nb_frames * 2; i++)
+    {
+        samples[i] = (i % 2 == 0) ? 100 : -100;
+    }
+    samples[nb_frames * 2 - 2] = 30000;
+    samples[nb_frames * 2 - 1] = -30000;
+    at->set_end_of_samples(nb_frames * 2);
+
+    // Compute and check all levels.
+    Audio_track_overview *overview = at->get_overview();
+    QVERIFY2(overview != nullptr, "overview exists");
+    overview->compute(at->get_samples(), nb_frames);
+    for (unsigned short int l = 0; l < OVERVIEW_NB_LEVELS; l++)
+    {
+        unsigned int nb_bins = overview->get_nb_bins(l);
+        QVERIFY2(nb_bins == (nb_frames + overview->get_bin_size(l) - 1) / overview->get_bin_size(l), "nb bins");
+        QVERIFY2(overview->get_bins(l)[0].min == -100,         "min of first bin");
+        QVERIFY2(overview->get_bins(l)[0].max == 100,          "max of first bin");
+        QVERIFY2(overview->get_bins(l)[0].rms == 100,          "rms of first bin");
+        QVERIFY2(overview->get_bins(l)[nb_bins - 1].min == -30000, "peak is kept (min)");
+        QVERIFY2(overview->get_bins(l)[nb_bins - 1].max == 30000,  "peak is kept (max)");
+    }
+
+    // Level selection depends on the number of frames per pixel.
+    QVERIFY2(overview->get_level(1) == 0,                                   "most detailed level");
+    QVERIFY2(overview->get_level(OVERVIEW_BASE_BIN_SIZE * OVERVIEW_LEVEL_FACTOR) == 1, "second level");
+    QVERIFY2(overview->get_level(UINT_MAX) == OVERVIEW_NB_LEVELS - 1,       "coarsest level");
+
+    // Serialize (8 bits values) and restore.
+    QByteArray data;
+    QVERIFY2(overview->to_byte_array(44100, data) == true, "serialize overview");
+    QVERIFY2(data.size() < (int)(nb_frames * sizeof(short signed int)), "serialized overview is small");
+    Audio_track_overview restored(at->get_max_nb_samples() / 2);
+    QVERIFY2(restored.from_byte_array(QByteArray("not an overview"), 44100) == false, "do not restore bad data");
+    QVERIFY2(restored.from_byte_array(data, 44100) == true,  "restore overview");
+    for (unsigned short int l = 0; l < OVERVIEW_NB_LEVELS; l++)
+    {
+        unsigned int nb_bins = restored.get_nb_bins(l);
+        QVERIFY2(nb_bins == overview->get_nb_bins(l),                                 "restored nb bins");
+        QVERIFY2(qAbs(restored.get_bins(l)[0].max - overview->get_bins(l)[0].max) < 256, "restored first bin");
+        QVERIFY2(restored.get_bins(l)[nb_bins - 1].min <= -30000 &&
+                 restored.get_bins(l)[nb_bins - 1].min > -30000 - 256,                "restored peak of last bin");
+    }
+
+    // Serialized overview does not depend on the sample rate.
+    QVERIFY2(restored.from_byte_array(data, 11025) == true, "restore overview for another sample rate");
+    QVERIFY2(restored.get_nb_bins(0) == (nb_frames / 4 + OVERVIEW_BASE_BIN_SIZE - 1) / OVERVIEW_BASE_BIN_SIZE,
+             "nb bins for another sample rate");
+
+    // Reset.
+    at->reset();
+    QVERIFY2(overview->get_nb_bins(0) == 0, "overview is reset");
+    QVERIFY2(overview->to_byte_array(44100, data) == false, "nothing to serialize");
+}
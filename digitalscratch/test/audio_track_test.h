@@ -44,4 +44,5 @@ private Q_SLOTS:
     void testCaseCreate();
     void testCaseFillSamples();
     void testCaseSetPath();
+    void testCaseOverview();
 };
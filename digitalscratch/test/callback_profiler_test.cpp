@@ -0,0 +1,81 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Test                            */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+
+#include "player/callback_profiler.h"
+#include "callback_profiler_test.h"
+
+Callback_profiler_Test::Callback_profiler_Test()
+{
+}
+
+void Callback_profiler_Test::initTestCase()
+{
+}
+
+void Callback_profiler_Test::cleanupTestCase()
+{
+    // Cleanup.
+}
+
+void Callback_profiler_Test::testCaseProfiler()
+{
+    // Buckets are contiguous and contain their values.
+    for (quint64 ns = 1; ns < 100000; ns += 7)
+    {
+        int bucket = Timing_histogram::get_bucket(ns);
+        QVERIFY2(ns < Timing_histogram::get_bucket_upper_bound(bucket), "value below upper bound of its bucket");
+        QVERIFY2((bucket == 0) || (ns >= Timing_histogram::get_bucket_upper_bound(bucket - 1)), "value above previous bucket");
+    }
+
+    // 98 periods of 10us, 2 periods of 1ms.
+    Timing_histogram histogram;
+    for (int i = 0; i < 98; i++)
+    {
+        histogram.add(10000);
+    }
+    histogram.add(1000000);
+    histogram.add(1000000);
+    Timing_stats stats = histogram.get_stats();
+    QVERIFY2(stats.count == 100, "number of timings");
+    QVERIFY2((stats.p50_ns > 10000) && (stats.p50_ns <= 12000), "p50 of timings");
+    QVERIFY2(stats.p99_ns == 1000000, "p99 of timings (bucket bound limited to max)");
+    QVERIFY2(stats.max_ns == 1000000, "max of timings");
+
+    // Reset is applied by the real-time side at the next period.
+    Callback_profiler profiler;
+    profiler.start_period();
+    profiler.add_timing(0, Profiler_stage::PLAYBACK, 5000);
+    profiler.end_period(64);
+    QVERIFY2(profiler.get_period_stats().count == 1, "one period");
+    QVERIFY2(profiler.get_stage_stats(0, Profiler_stage::PLAYBACK).max_ns == 5000, "playback timing");
+    profiler.reset();
+    profiler.start_period();
+    QVERIFY2(profiler.get_period_stats().count == 0, "profiler reset");
+}
@@ -0,0 +1,130 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Benchmark                       */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QAtomicInt>
+
+#include "singleton.h"
+#include "tracks/data_persistence.h"
+#include "data_persistence_benchmark.h"
+
+#define BENCH_NB_TRACKS   4000
+#define BENCH_CHUNK_SIZE  100
+
+// Read a chunk of tracks from DB, in a thread of the pool.
+class Read_tracks_task : public QRunnable
+{
+ public:
+    Read_tracks_task(const QStringList &hashes, QAtomicInt *nb_tracks_read) :
+        hashes(hashes), nb_tracks_read(nb_tracks_read) {}
+
+    void run()
+    {
+        QHash<QString, Track_metadata> tracks;
+        if (Singleton<Data_persistence>::get_instance().get_audio_tracks(this->hashes, tracks) == true)
+        {
+            this->nb_tracks_read->fetchAndAddRelaxed(tracks.size());
+        }
+    }
+
+ private:
+    QStringList  hashes;
+    QAtomicInt  *nb_tracks_read;
+};
+
+Data_persistence_Benchmark::Data_persistence_Benchmark()
+{
+}
+
+void Data_persistence_Benchmark::initTestCase()
+{
+    // Start from an empty DB (benchmark build uses its own test DB file).
+    QVERIFY2(Singleton<Data_persistence>::get_instance().reset_db() == true, "DB reset");
+}
+
+void Data_persistence_Benchmark::cleanupTestCase()
+{
+    // Do not leave generated tracks for next runs.
+    QVERIFY2(Singleton<Data_persistence>::get_instance().reset_db() == true, "DB reset");
+}
+
+void Data_persistence_Benchmark::benchmarkConcurrentRead_data()
+{
+    QTest::addColumn<int>("nb_threads");
+
+    QTest::newRow("1 thread")  << 1;
+    QTest::newRow("2 threads") << 2;
+    QTest::newRow("4 threads") << 4;
+    QTest::newRow("8 threads") << 8;
+}
+
+void Data_persistence_Benchmark::benchmarkConcurrentRead()
+{
+    //
+    // Read the collection by chunks of tracks from a pool of threads (each one has its own DB connection).
+    // Read throughput should scale with the number of threads.
+    //
+    QFETCH(int, nb_threads);
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+
+    // Collection to read (same tracks for each row, they are only updated).
+    QStringList hashes;
+    Track_metadata track;
+    track.music_key  = "A1";
+    track.first_beat = 0;
+    for (int i = 0; i < BENCH_NB_TRACKS; i++)
+    {
+        track.hash     = QString("bench_%1").arg(i);
+        track.fullpath = QString("/tmp/bench/track_%1.mp3").arg(i);
+        track.bpm      = 120.0;
+        data_persist->queue_audio_track(track);
+        hashes << track.hash;
+    }
+    QVERIFY2(data_persist->flush_audio_tracks() == true, "write collection");
+
+    // Measure reads from DB, not from the cache.
+    data_persist->clear_cache();
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(nb_threads);
+    QAtomicInt nb_tracks_read(0);
+
+    QBENCHMARK
+    {
+        nb_tracks_read = 0;
+        for (int first = 0; first < hashes.size(); first += BENCH_CHUNK_SIZE)
+        {
+            pool.start(new Read_tracks_task(hashes.mid(first, BENCH_CHUNK_SIZE), &nb_tracks_read));
+        }
+        pool.waitForDone();
+    }
+
+    QVERIFY2(nb_tracks_read.load() == BENCH_NB_TRACKS, "all tracks read");
+}
@@ -33,6 +33,7 @@
 #include "utils.h"
 #include "tracks/audio_file_decoding_process.h"
 #include "tracks/data_persistence.h"
+#include "tracks/audio_collection_scanner.h"
 
 #define DATA_DIR     "./test/data/"
 #define DATA_TRACK_1 "track_1.mp3"
@@ -45,13 +46,11 @@ Data_persistence_Test::Data_persistence_Test()
 
 void Data_persistence_Test::initTestCase()
 {
-    // Remove database file.
-    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/digitalscratch.sqlite");
-
     // Get/create a data persistence static instance.
     Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
 
-    // Init DB.
+    // Start from an empty DB, whatever other tests did before (connections of all threads are opened again).
+    QVERIFY2(data_persist->reset_db() == true, "DB reset");
     QVERIFY2(data_persist->is_initialized == true, "DB initialized");
 }
 
@@ -93,6 +92,8 @@ void Data_persistence_Test::testCaseGetAudioTrack()
     at->set_fullpath(fullpath);
     at->set_hash(Utils::get_file_hash(fullpath));
     at->set_music_key("A1");
+    at->set_bpm(127.5);
+    at->set_first_beat(320);
     QVERIFY2(data_persist->store_audio_track(at) == true, "audio track store");
 
     // Get this audio track.
@@ -102,6 +103,8 @@ void Data_persistence_Test::testCaseGetAudioTrack()
     QVERIFY2(at_from_db->get_path()      == at->get_path(),      "path from DB");
     QVERIFY2(at_from_db->get_filename()  == at->get_filename(),  "filename from DB");
     QVERIFY2(at_from_db->get_music_key() == at->get_music_key(), "key from DB");
+    QVERIFY2(at_from_db->get_bpm()        == at->get_bpm(),        "bpm from DB");
+    QVERIFY2(at_from_db->get_first_beat() == at->get_first_beat(), "first beat from DB");
 
     // Get not exising audio track.
     at_from_db->reset();
@@ -112,6 +115,131 @@ void Data_persistence_Test::testCaseGetAudioTrack()
     QVERIFY2(at_from_db->get_music_key() == "", "no key from DB");
 }
 
+void Data_persistence_Test::testCaseGetAudioTracks()
+{
+    // Insert 2 test audio tracks, one of them is tagged.
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QSharedPointer<Audio_track> at1(new Audio_track(44100));
+    at1->set_fullpath(QString(DATA_DIR) + QString(DATA_TRACK_1));
+    at1->set_hash(Utils::get_file_hash(at1->get_fullpath()));
+    at1->set_music_key("A1");
+    at1->set_bpm(127.5);
+    at1->set_first_beat(320);
+    QVERIFY2(data_persist->store_audio_track(at1) == true, "audio track 1 store");
+    QSharedPointer<Audio_track> at2(new Audio_track(44100));
+    at2->set_fullpath(QString(DATA_DIR) + QString(DATA_TRACK_2));
+    at2->set_hash(Utils::get_file_hash(at2->get_fullpath()));
+    at2->set_music_key("A2");
+    QVERIFY2(data_persist->store_audio_track(at2) == true, "audio track 2 store");
+    QVERIFY2(data_persist->store_tag("bulk") == true,            "store tag");
+    QVERIFY2(data_persist->add_tag_to_track(at2, "bulk") == true, "tag audio track 2");
+
+    // Get both tracks (and a not existing one) in one call.
+    QHash<QString, Track_metadata> tracks;
+    QStringList hashes;
+    hashes << at1->get_hash() << "1234567890" << at2->get_hash();
+    QVERIFY2(data_persist->get_audio_tracks(hashes, tracks) == true, "get audio tracks");
+    QVERIFY2(tracks.size() == 2,                                   "nb tracks found");
+    QVERIFY2(tracks.contains("1234567890") == false,               "not existing track not found");
+    QVERIFY2(tracks[at1->get_hash()].music_key  == "A1",            "key of track 1");
+    QVERIFY2(tracks[at1->get_hash()].bpm        == 127.5f,          "bpm of track 1");
+    QVERIFY2(tracks[at1->get_hash()].first_beat == 320,             "first beat of track 1");
+    QVERIFY2(tracks[at1->get_hash()].fullpath   == at1->get_fullpath(), "path of track 1");
+    QVERIFY2(tracks[at2->get_hash()].music_key  == "A2",            "key of track 2");
+    QVERIFY2(tracks[at2->get_hash()].tags.contains("bulk") == true, "tag of track 2");
+
+    // Nothing to get.
+    QVERIFY2(data_persist->get_audio_tracks(QStringList(), tracks) == true && tracks.size() == 0, "get no audio tracks");
+    data_persist->delete_tag("bulk");
+}
+
+void Data_persistence_Test::testCaseQueueAudioTracks()
+{
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QHash<QString, Track_metadata> tracks;
+    QStringList hashes;
+
+    // Track without hash is not queued.
+    Track_metadata track;
+    track.bpm        = 0.0;
+    track.first_beat = 0;
+    QVERIFY2(data_persist->queue_audio_track(track) == false, "queue track without hash");
+
+    // Queue more tracks than a batch.
+    for (int i = 0; i < DB_WRITE_BATCH_SIZE + 10; i++)
+    {
+        track.hash      = QString("queued_%1").arg(i);
+        track.fullpath  = QString("/tmp/queued/track_%1.mp3").arg(i);
+        track.music_key = "B2";
+        track.bpm       = 100.0 + i;
+        QVERIFY2(data_persist->queue_audio_track(track) == true, "queue track");
+        hashes << track.hash;
+    }
+
+    // Queued tracks are written before reading them.
+    QVERIFY2(data_persist->get_audio_tracks(hashes, tracks) == true,      "get queued tracks");
+    QVERIFY2(tracks.size() == DB_WRITE_BATCH_SIZE + 10,                   "all queued tracks written");
+    QVERIFY2(tracks["queued_3"].bpm      == 103.0f,                       "bpm of a queued track");
+    QVERIFY2(tracks["queued_3"].fullpath == "/tmp/queued/track_3.mp3",    "path of a queued track");
+
+    // Update a queued track.
+    track.hash      = "queued_3";
+    track.fullpath  = "/tmp/queued/track_3.mp3";
+    track.music_key = "C3";
+    QVERIFY2(data_persist->queue_audio_track(track) == true, "queue updated track");
+    QVERIFY2(data_persist->flush_audio_tracks() == true,     "write queued tracks");
+    QVERIFY2(data_persist->get_audio_tracks(QStringList("queued_3"), tracks) == true && tracks["queued_3"].music_key == "C3", "updated track");
+    QVERIFY2(data_persist->flush_audio_tracks() == true,     "nothing to write");
+}
+
+void Data_persistence_Test::testCaseWriteWithoutUpsert()
+{
+    // Same writes as with an SQLite version older than 3.24 (insert then update).
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    bool has_upsert = data_persist->set_has_upsert(false);
+
+    // Insert a track, tag it, then update it: tag is kept.
+    QHash<QString, Track_metadata> tracks;
+    Track_metadata track;
+    track.hash       = "no_upsert";
+    track.fullpath   = "/tmp/no_upsert/track.mp3";
+    track.music_key  = "01A";
+    track.bpm        = 120.0;
+    track.first_beat = 10;
+    QVERIFY2(data_persist->queue_audio_track(track) == true,                       "queue new track");
+    QVERIFY2(data_persist->flush_audio_tracks() == true,                           "insert track");
+    QSharedPointer<Audio_track> at(new Audio_track(44100));
+    at->set_hash(track.hash);
+    QVERIFY2(data_persist->store_tag("no_upsert") == true,                         "store tag");
+    QVERIFY2(data_persist->add_tag_to_track(at, "no_upsert") == true,              "tag track");
+    track.music_key = "02B";
+    track.bpm       = 124.0;
+    QVERIFY2(data_persist->queue_audio_track(track) == true,                       "queue updated track");
+    QVERIFY2(data_persist->flush_audio_tracks() == true,                           "update track");
+    data_persist->clear_cache();
+    QVERIFY2(data_persist->get_audio_tracks(QStringList(track.hash), tracks) == true, "get track");
+    QVERIFY2(tracks[track.hash].music_key == "02B",                                "updated key");
+    QVERIFY2(tracks[track.hash].bpm == 124.0f,                                     "updated bpm");
+    QVERIFY2(tracks[track.hash].tags.contains("no_upsert") == true,                "tag is kept");
+    data_persist->delete_tag("no_upsert");
+
+    // Insert then update an entry of the file index.
+    QHash<QString, File_index_entry> index;
+    File_index_entry entry;
+    entry.path  = "/tmp/ds_no_upsert/track.mp3";
+    entry.size  = 1;
+    entry.mtime = 2;
+    entry.hash  = "no_upsert_1";
+    QVERIFY2(data_persist->store_file_index(QList<File_index_entry>() << entry) == true, "insert file index");
+    entry.hash  = "no_upsert_2";
+    QVERIFY2(data_persist->store_file_index(QList<File_index_entry>() << entry) == true, "update file index");
+    QVERIFY2(data_persist->get_file_index("/tmp/ds_no_upsert", index) == true,            "get file index");
+    QVERIFY2((index.size() == 1) && (index[entry.path].hash == "no_upsert_2"),           "file index entry updated");
+    QVERIFY2(data_persist->delete_file_index(QStringList(entry.path)) == true,            "delete file index");
+
+    data_persist->set_has_upsert(has_upsert);
+}
+
 void Data_persistence_Test::testCaseStoreAndGetATCharge()
 {
     //
@@ -253,6 +381,16 @@ void Data_persistence_Test::testCasePersistTag()
     data_persist->get_full_tag_list(tags);
     QVERIFY2(tags.size() == 0, "nb tags = 0");
 
+    // Tag name with quotes.
+    QVERIFY2(data_persist->store_tag("it's a \"tag\"") == true, "store tag with quotes");
+    QVERIFY2(data_persist->store_tag("it's a \"tag\"") == true, "store existing tag with quotes");
+    data_persist->get_full_tag_list(tags);
+    QVERIFY2(tags.size() == 1 && tags[0] == "it's a \"tag\"", "tag with quotes");
+    QVERIFY2(data_persist->delete_tag("it's a \"tag\"") == true, "delete tag with quotes");
+    tags.clear();
+    data_persist->get_full_tag_list(tags);
+    QVERIFY2(tags.size() == 0, "nb tags = 0");
+
     // Store again 2 tags.
     QVERIFY2(data_persist->store_tag("house") == true, "store new tag house");
     QVERIFY2(data_persist->store_tag("techno") == true, "store new tag techno");
@@ -326,3 +464,231 @@ void Data_persistence_Test::testCasePersistTag()
     QVERIFY2(tracklist[1] == QFileInfo(QString(DATA_DIR) + QString(DATA_TRACK_2)).absoluteFilePath(), "tracklist[0] = track_2.mp3");
 }
 
+void Data_persistence_Test::testCaseCache()
+{
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+
+    // Precondition: a track with a cue point and a tag.
+    QSharedPointer<Audio_track> at(new Audio_track(15, 44100));
+    Audio_file_decoding_process decoder(at, false);
+    QString fullpath = QString(DATA_DIR) + QString(DATA_TRACK_2);
+    decoder.run(fullpath, Utils::get_file_hash(fullpath), "B2");
+    QVERIFY2(data_persist->store_audio_track(at)          == true, "store audio track");
+    QVERIFY2(data_persist->store_cue_point(at, 0, 2000)   == true, "store cue point");
+    QVERIFY2(data_persist->store_tag("cached_tag")        == true, "store tag");
+    QVERIFY2(data_persist->add_tag_to_track(at, "cached_tag") == true, "add tag to track");
+
+    // Written data is read back from the cache, then from DB once the cache is cleared.
+    for (int i = 0; i < 2; i++)
+    {
+        QSharedPointer<Audio_track> at_read(new Audio_track(15, 44100));
+        at_read->set_hash(at->get_hash());
+        QVERIFY2(data_persist->get_audio_track(at_read) == true,  "get track");
+        QVERIFY2(at_read->get_music_key() == "B2",                "key");
+        QVERIFY2(at_read->get_filename()  == at->get_filename(),  "file name");
+        QVERIFY2(at_read->get_tags().contains("cached_tag") == true, "tag");
+
+        unsigned int position = 0;
+        QVERIFY2(data_persist->get_cue_point(at, 0, position) == true && position == 2000, "cue point");
+        QVERIFY2(data_persist->get_cue_point(at, 1, position) == false,                    "no cue point");
+
+        data_persist->clear_cache();
+    }
+
+    // Renaming a tag changes tags of cached tracks.
+    QStringList tags;
+    QVERIFY2(data_persist->get_tags_from_track(at, tags) == true,        "get tags");
+    QVERIFY2(data_persist->rename_tag("cached_tag", "cached_tag_2") == true, "rename tag");
+    tags.clear();
+    QVERIFY2(data_persist->get_tags_from_track(at, tags) == true,        "get renamed tags");
+    QVERIFY2(tags.contains("cached_tag_2") == true && tags.contains("cached_tag") == false, "renamed tag");
+
+    // Removed tag and cue point are not cached anymore.
+    QVERIFY2(data_persist->rem_tag_from_track(at, "cached_tag_2") == true, "remove tag from track");
+    QVERIFY2(data_persist->delete_cue_point(at, 0) == true,               "delete cue point");
+    tags.clear();
+    unsigned int position = 0;
+    QVERIFY2(data_persist->get_tags_from_track(at, tags) == true && tags.isEmpty() == true, "no tags");
+    QVERIFY2(data_persist->get_cue_point(at, 0, position) == false,                        "cue point deleted");
+
+    // Explicit invalidation of a track.
+    data_persist->invalidate_cache(at->get_hash());
+    QVERIFY2(data_persist->get_tags_from_track(at, tags) == true && tags.isEmpty() == true, "no tags after invalidation");
+    QVERIFY2(data_persist->delete_tag("cached_tag_2") == true, "delete tag");
+}
+
+void Data_persistence_Test::testCaseStoreAndGetAnalysis()
+{
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QString    hash = Utils::get_file_hash(QString(DATA_DIR) + QString(DATA_TRACK_1));
+    QByteArray data(1000, 'a');
+    QByteArray data_from_db;
+
+    // Bad parameters.
+    QVERIFY2(data_persist->store_analysis("", ANALYSIS_WAVEFORM_OVERVIEW, data) == false, "store analysis without hash");
+    QVERIFY2(data_persist->get_analysis(hash, "", data_from_db) == false,               "get analysis without type");
+
+    // Not existing analysis.
+    QVERIFY2(data_persist->get_analysis("1234567890", ANALYSIS_WAVEFORM_OVERVIEW, data_from_db) == false, "analysis not found");
+
+    // Store and get analysis.
+    QVERIFY2(data_persist->store_analysis(hash, ANALYSIS_WAVEFORM_OVERVIEW, data) == true,        "store analysis");
+    QVERIFY2(data_persist->get_analysis(hash, ANALYSIS_WAVEFORM_OVERVIEW, data_from_db) == true,  "get analysis");
+    QVERIFY2(data_from_db == data,                                                                 "analysis data from DB");
+
+    // Replace analysis.
+    data.fill('b', 2000);
+    QVERIFY2(data_persist->store_analysis(hash, ANALYSIS_WAVEFORM_OVERVIEW, data) == true,        "replace analysis");
+    QVERIFY2(data_persist->get_analysis(hash, ANALYSIS_WAVEFORM_OVERVIEW, data_from_db) == true,  "get replaced analysis");
+    QVERIFY2(data_from_db == data,                                                                 "replaced analysis data from DB");
+}
+
+void Data_persistence_Test::testCaseFileIndex()
+{
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    QString root = QDir(DATA_DIR).absolutePath();
+    QHash<QString, File_index_entry> index;
+
+    // Store, get and delete entries of the file index.
+    File_index_entry entry;
+    entry.path  = "/tmp/ds_file_index/track.mp3";
+    entry.size  = 1234;
+    entry.mtime = 5678;
+    entry.hash  = "1234567890";
+    QVERIFY2(data_persist->store_file_index(QList<File_index_entry>() << entry) == true, "store file index");
+    QVERIFY2(data_persist->get_file_index("/tmp/ds_file_index", index) == true,           "get file index");
+    QVERIFY2(index.size() == 1,                                                          "nb entries in file index");
+    QVERIFY2(index[entry.path].hash == "1234567890" &&
+             index[entry.path].size == 1234 &&
+             index[entry.path].mtime == 5678,                                            "file index entry");
+    QVERIFY2(data_persist->get_file_index("/tmp/ds_file", index) == true && index.size() == 0, "no partial directory name match");
+
+    // Analysis of the file is removed with the last file having its hash.
+    QByteArray data(10, 'a');
+    File_index_entry copy = entry;
+    copy.path = "/tmp/ds_file_index/copy_of_track.mp3";
+    QVERIFY2(data_persist->store_file_index(QList<File_index_entry>() << copy) == true,   "store file index of a copy");
+    QVERIFY2(data_persist->store_analysis(entry.hash, ANALYSIS_WAVEFORM_OVERVIEW, data) == true, "store analysis of indexed file");
+    QVERIFY2(data_persist->delete_file_index(QStringList(copy.path)) == true,             "delete file index of the copy");
+    QVERIFY2(data_persist->get_analysis(entry.hash, ANALYSIS_WAVEFORM_OVERVIEW, data) == true,  "analysis kept for remaining file");
+    QVERIFY2(data_persist->delete_file_index(QStringList(entry.path)) == true,            "delete file index");
+    QVERIFY2(data_persist->get_file_index("/tmp/ds_file_index", index) == true && index.size() == 0, "file index is empty");
+    QVERIFY2(data_persist->get_analysis(entry.hash, ANALYSIS_WAVEFORM_OVERVIEW, data) == false, "analysis removed with file");
+
+    // Forget test files possibly indexed by other tests.
+    QVERIFY2(data_persist->get_file_index(root, index) == true,       "get file index of test data");
+    QVERIFY2(data_persist->delete_file_index(index.keys()) == true,   "clear file index of test data");
+
+    // First scan hashes all files, second one gets hash from the index.
+    Audio_collection_scanner scanner;
+    QList<File_index_entry>  files;
+    QVERIFY2(scanner.scan_directory(root, files) == true,  "first scan");
+    QVERIFY2(files.size() == 5,                            "nb files found");
+    QVERIFY2(scanner.get_nb_hashed_files() == 5,           "all files hashed");
+    QVERIFY2(scanner.scan_directory(root, files) == true,  "second scan");
+    QVERIFY2(files.size() == 5,                            "nb files found again");
+    QVERIFY2(scanner.get_nb_hashed_files() == 0,           "no file hashed again");
+    foreach (const File_index_entry &file, files)
+    {
+        QVERIFY2(file.hash == Utils::get_file_hash(file.path), "hash from file index");
+    }
+
+    // Scan only the directory itself.
+    QVERIFY2(scanner.scan_directory(root, files, false) == true, "not recursive scan");
+    QVERIFY2(files.size() == 5,                                  "nb files found in directory");
+    QVERIFY2(scanner.get_sub_directories().size() == 0,          "no sub directories");
+    QVERIFY2(scanner.get_nb_hashed_files() == 0,                 "no file hashed by not recursive scan");
+
+    // Scan a list of files.
+    QVERIFY2(scanner.scan_files(QStringList() << root + "/" + DATA_TRACK_1 << root + "/not_existing.mp3", files) == true, "scan files");
+    QVERIFY2(files.size() == 1,                  "only existing audio files");
+    QVERIFY2(scanner.get_nb_hashed_files() == 0, "hash of scanned file from index");
+
+    // Not existing directory.
+    QVERIFY2(scanner.scan_directory("/not/existing/dir", files) == false, "scan not existing directory");
+}
+
+void Data_persistence_Test::testCaseSearchFiles()
+{
+    Data_persistence *data_persist = &Singleton<Data_persistence>::get_instance();
+    if (data_persist->has_search_index == false)
+    {
+        QSKIP("SQLite FTS5 (trigram) not available");
+    }
+
+    // Indexed files, 2 of them are analyzed tracks, 1 is tagged.
+    QList<File_index_entry> entries;
+    File_index_entry entry;
+    entry.size  = 1;
+    entry.mtime = 1;
+    entry.path = "/tmp/ds_search/Artist One - Deep Song.mp3";  entry.hash = "search_1"; entries << entry;
+    entry.path = "/tmp/ds_search/Artist Two - Acid Song.mp3";  entry.hash = "search_2"; entries << entry;
+    entry.path = "/tmp/ds_search/other/Unknown.flac";          entry.hash = "search_3"; entries << entry;
+    QVERIFY2(data_persist->store_file_index(entries) == true, "store file index");
+    Track_metadata track;
+    track.first_beat = 0;
+    track.hash = "search_1"; track.fullpath = entries[0].path; track.music_key = "08A"; track.bpm = 124.0; data_persist->queue_audio_track(track);
+    track.hash = "search_2"; track.fullpath = entries[1].path; track.music_key = "09B"; track.bpm = 130.0; data_persist->queue_audio_track(track);
+    QVERIFY2(data_persist->flush_audio_tracks() == true, "store tracks");
+    QSharedPointer<Audio_track> at(new Audio_track(44100));
+    at->set_hash("search_2");
+    QVERIFY2(data_persist->store_tag("search_tag") == true && data_persist->add_tag_to_track(at, "search_tag") == true, "tag track");
+
+    // Substring and token search (any order, not case sensitive).
+    Search_query search;
+    QStringList  paths;
+    search.terms = QStringList() << "song";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths.size() == 2, "substring");
+    paths.clear();
+
+    // Page by page (next pages read the results of the first one).
+    QVERIFY2(data_persist->search_files(search, "", 1, paths) == true && paths == QStringList(entries[0].path),  "first page");
+    paths.clear();
+    QVERIFY2(data_persist->search_files(search, entries[0].path, 1, paths) == true && paths == QStringList(entries[1].path), "second page");
+    paths.clear();
+    QVERIFY2(data_persist->search_files(search, entries[1].path, 1, paths) == true && paths.isEmpty() == true, "last page");
+    search.terms = QStringList() << "deep";
+    QVERIFY2(data_persist->search_files(search, "/tmp", 1, paths) == true && paths == QStringList(entries[0].path), "other terms on next page");
+    paths.clear();
+    search.terms = QStringList() << "acid" << "artist";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[1].path), "tokens");
+    paths.clear();
+    search.terms = QStringList() << "other";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[2].path), "directory");
+    paths.clear();
+    search.terms = QStringList() << "Un";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[2].path), "short text");
+
+    // Facets.
+    paths.clear();
+    search.terms.clear();
+    search.key = "08A";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[0].path), "key");
+    paths.clear();
+    search.key.clear();
+    search.bpm_min = 128.0;
+    search.bpm_max = 132.0;
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[1].path), "bpm range");
+    paths.clear();
+    search.bpm_max = 0.0;
+    search.tag = "search_tag";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[1].path), "tag");
+
+    // Index follows tags and files.
+    paths.clear();
+    search.tag.clear();
+    search.terms = QStringList() << "search_tag";
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths == QStringList(entries[1].path), "tag as text");
+    paths.clear();
+    QVERIFY2(data_persist->delete_tag("search_tag") == true, "delete tag");
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths.isEmpty() == true, "deleted tag");
+
+    // Pages of results.
+    paths.clear();
+    search.terms = QStringList() << "ds_search";
+    QVERIFY2(data_persist->search_files(search, "", 2, paths) == true && paths.size() == 2, "first page");
+    QVERIFY2(data_persist->search_files(search, paths.last(), 2, paths) == true && paths.size() == 3, "second page");
+    QVERIFY2(data_persist->delete_file_index(QStringList() << entries[0].path << entries[1].path << entries[2].path) == true, "delete files");
+    paths.clear();
+    QVERIFY2(data_persist->search_files(search, "", 100, paths) == true && paths.isEmpty() == true, "deleted files");
+}
@@ -42,7 +42,14 @@ class Data_persistence_Test : public QObject
 
     void testCaseStoreAudioTrack();
     void testCaseGetAudioTrack();
+    void testCaseGetAudioTracks();
+    void testCaseQueueAudioTracks();
+    void testCaseWriteWithoutUpsert();
     void testCaseStoreAndGetATCharge();
     void testCaseStoreAndGetCuePoint();
     void testCasePersistTag();
+    void testCaseCache();
+    void testCaseStoreAndGetAnalysis();
+    void testCaseFileIndex();
+    void testCaseSearchFiles();
 };
@@ -0,0 +1,267 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Test                            */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+
+#include "app/application_const.h"
+#include "player/playback_parameters.h"
+#include "player/deck_playback_process.h"
+#include "tracks/audio_file_decoding_process.h"
+#include "deck_command_queue_test.h"
+
+#define DATA_DIR              "./test/data/"
+#define DATA_TRACK_2          "track_2.mp3"
+#define NB_WRITERS            4
+#define NB_COMMANDS_BY_WRITER 10000
+#define RUNNER_NB_FRAMES      512
+
+class Command_writer : public QThread
+{
+ private:
+    Deck_command_queue *queue;
+    unsigned int        writer_index;
+
+ public:
+    Command_writer(Deck_command_queue *queue, const unsigned int &writer_index)
+    {
+        this->queue        = queue;
+        this->writer_index = writer_index;
+    }
+
+ protected:
+    void run() override
+    {
+        // Encode writer and command number in the value, retry while the queue is full.
+        Deck_command command;
+        command.type  = Deck_command_type::JUMP;
+        command.state = false;
+        for (unsigned int i = 0; i < NB_COMMANDS_BY_WRITER; )
+        {
+            command.value = this->writer_index * NB_COMMANDS_BY_WRITER + i;
+            if (this->queue->push(command) == true)
+            {
+                i++;
+            }
+            else
+            {
+                QThread::yieldCurrentThread();
+            }
+        }
+    }
+};
+
+// Play a deck like the sound card does, until it is stopped.
+class Deck_runner : public QThread
+{
+ private:
+    Deck_playback_process *playback;
+
+ public:
+    QAtomicInt running;
+
+    Deck_runner(Deck_playback_process *playback)
+    {
+        this->playback = playback;
+        this->running  = 1;
+    }
+
+ protected:
+    void run() override
+    {
+        QVector<float> buf_1(RUNNER_NB_FRAMES);
+        QVector<float> buf_2(RUNNER_NB_FRAMES);
+        while (this->running.load() == 1)
+        {
+            this->playback->run(buf_1.data(), buf_2.data(), RUNNER_NB_FRAMES);
+            QThread::usleep(1000);
+        }
+    }
+};
+
+Deck_command_queue_Test::Deck_command_queue_Test()
+{
+}
+
+void Deck_command_queue_Test::initTestCase()
+{
+}
+
+void Deck_command_queue_Test::cleanupTestCase()
+{
+}
+
+void Deck_command_queue_Test::testCasePushPop()
+{
+    Deck_command_queue queue;
+    Deck_command       command;
+
+    // Empty queue.
+    QVERIFY2(queue.pop(command) == false, "pop empty queue");
+
+    // Commands are read in the same order they were written, several times around the queue.
+    for (unsigned int i = 0; i < DECK_COMMAND_QUEUE_SIZE * 3; i++)
+    {
+        command.type  = Deck_command_type::SAMPLER_STATE;
+        command.value = i;
+        command.state = (i % 2 == 0);
+        QVERIFY2(queue.push(command) == true, "push");
+        QVERIFY2(queue.push(command) == true, "push again");
+
+        for (int j = 0; j < 2; j++)
+        {
+            Deck_command result;
+            QVERIFY2(queue.pop(result) == true, "pop");
+            QCOMPARE(result.type == Deck_command_type::SAMPLER_STATE, true);
+            QCOMPARE(result.value, i);
+            QCOMPARE(result.state, (i % 2 == 0));
+        }
+    }
+    QVERIFY2(queue.pop(command) == false, "queue is empty again");
+}
+
+void Deck_command_queue_Test::testCaseFull()
+{
+    Deck_command_queue queue;
+    Deck_command       command;
+    command.type  = Deck_command_type::STOP;
+    command.state = false;
+
+    // Fill the queue.
+    for (unsigned int i = 0; i < DECK_COMMAND_QUEUE_SIZE; i++)
+    {
+        command.value = i;
+        QVERIFY2(queue.push(command) == true, "push until full");
+    }
+    QVERIFY2(queue.push(command) == false, "push in full queue");
+
+    // Reading one command makes room for another one.
+    QVERIFY2(queue.pop(command) == true, "pop from full queue");
+    QCOMPARE(command.value, 0u);
+    QVERIFY2(queue.push(command) == true, "push after pop");
+    QVERIFY2(queue.push(command) == false, "full again");
+}
+
+void Deck_command_queue_Test::testCaseConcurrentWriters()
+{
+    Deck_command_queue queue;
+
+    // Several threads write at the same time.
+    QList<Command_writer*> writers;
+    for (unsigned int i = 0; i < NB_WRITERS; i++)
+    {
+        writers << new Command_writer(&queue, i);
+        writers[i]->start();
+    }
+
+    // Read everything: no command lost, order kept for each writer.
+    QVector<int>  last_values(NB_WRITERS, -1);
+    int           nb_read  = 0;
+    bool          in_order = true;
+    Deck_command  command;
+    QElapsedTimer timer;
+    timer.start();
+    while ((nb_read < NB_WRITERS * NB_COMMANDS_BY_WRITER) && (timer.elapsed() < 30000))
+    {
+        if (queue.pop(command) == true)
+        {
+            int writer = command.value / NB_COMMANDS_BY_WRITER;
+            int value  = command.value % NB_COMMANDS_BY_WRITER;
+            if ((writer >= NB_WRITERS) || (value != last_values[writer] + 1))
+            {
+                in_order = false;
+                break;
+            }
+            last_values[writer] = value;
+            nb_read++;
+        }
+        else
+        {
+            QThread::yieldCurrentThread();
+        }
+    }
+
+    // Writers may still wait for room in the queue if reading stopped early.
+    bool writers_running = (nb_read < NB_WRITERS * NB_COMMANDS_BY_WRITER);
+    while (writers_running == true)
+    {
+        queue.pop(command);
+        writers_running = false;
+        for (int i = 0; i < NB_WRITERS; i++)
+        {
+            writers_running |= writers[i]->isRunning();
+        }
+    }
+    bool all_done = true;
+    for (int i = 0; i < NB_WRITERS; i++)
+    {
+        all_done &= writers[i]->wait(30000);
+        delete writers[i];
+    }
+    QVERIFY2(all_done == true, "writers are done");
+    QVERIFY2(in_order == true, "commands are read in the order of each writer");
+    QCOMPARE(nb_read, NB_WRITERS * NB_COMMANDS_BY_WRITER);
+    QVERIFY2(queue.pop(command) == false, "nothing left");
+}
+
+void Deck_command_queue_Test::testCaseDelSampler()
+{
+    // Deck with a loaded sampler.
+    QSharedPointer<Playback_parameters> param(new Playback_parameters);
+    QSharedPointer<Audio_track> track(new Audio_track(MAX_MINUTES_TRACK, 44100));
+    QSharedPointer<Audio_track> sampler(new Audio_track(MAX_MINUTES_SAMPLER, 44100));
+    Audio_file_decoding_process decoder(sampler, false);
+    QVERIFY2(decoder.run(QString(DATA_DIR) + QString(DATA_TRACK_2), "", "") == true, "decode sampler");
+    QList<QSharedPointer<Audio_track>> samplers = {sampler};
+    Deck_playback_process playback(track, samplers, param);
+    QVERIFY2(playback.set_sampler_state(0, true) == true, "play sampler");
+
+    // Without real-time thread (sound card stopped), queued commands are applied by the caller.
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY2(playback.del_sampler(0) == true, "remove sampler track without real-time thread");
+    QVERIFY2(timer.elapsed() < DECK_COMMAND_SYNC_TIMEOUT_MS, "no wait for a real-time thread");
+    QVERIFY2(playback.get_sampler_state(0) == false, "sampler stopped");
+    QVERIFY2(playback.is_sampler_loaded(0) == false, "sampler track removed");
+
+    // With a real-time thread, the track is removed after the sampler is stopped by this thread.
+    QVERIFY2(decoder.run(QString(DATA_DIR) + QString(DATA_TRACK_2), "", "") == true, "decode sampler again");
+    QVERIFY2(playback.set_sampler_state(0, true) == true, "play sampler again");
+    Deck_runner runner(&playback);
+    playback.set_realtime_running(true);
+    runner.start();
+    bool deleted = playback.del_sampler(0);
+    runner.running = 0;
+    QVERIFY2(runner.wait(30000) == true, "real-time thread stopped");
+    playback.set_realtime_running(false);
+    QVERIFY2(deleted == true, "remove sampler track");
+    QVERIFY2(playback.get_sampler_state(0) == false, "sampler stopped by real-time thread");
+    QVERIFY2(playback.is_sampler_loaded(0) == false, "sampler track removed");
+}
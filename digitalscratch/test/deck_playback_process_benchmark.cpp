@@ -0,0 +1,191 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Benchmark                       */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QElapsedTimer>
+#include <cmath>
+
+#include "app/application_const.h"
+#include "player/playback_parameters.h"
+#include "player/deck_playback_process.h"
+#include "player/callback_profiler.h"
+#include "tracks/audio_file_decoding_process.h"
+#include "deck_playback_process_benchmark.h"
+
+using namespace std;
+
+#define DATA_DIR           "./test/data/"
+#define DATA_TRACK_1       "track_1.mp3"
+#define DATA_TRACK_2       "track_2.mp3"
+#define BENCH_SAMPLE_RATE  44100
+#define BENCH_DURATION_SEC 20   // Duration of audio produced for each measure.
+#define BENCH_TWO_PI       6.2831853f
+
+static float get_speed(const Speed_curve &curve, const float &time_sec)
+{
+    switch (curve)
+    {
+        case Speed_curve::RAMP:
+        {
+            // Triangle 0 -> 2 -> 0 in 4 seconds.
+            float phase = fmod(time_sec, 4.0f) / 2.0f;
+            return 2.0f * (1.0f - fabs(phase - 1.0f));
+        }
+        case Speed_curve::SCRATCH:
+            return 2.5f * sin(BENCH_TWO_PI * 3.0f * time_sec);
+        case Speed_curve::NEAR_ZERO:
+            return 0.01f + 0.005f * sin(BENCH_TWO_PI * 0.5f * time_sec);
+        default:
+            return 1.0f;
+    }
+}
+
+Deck_playback_process_Benchmark::Deck_playback_process_Benchmark()
+{
+}
+
+void Deck_playback_process_Benchmark::initTestCase()
+{
+    // Decode tracks once, they are shared by all measures.
+    this->track = QSharedPointer<Audio_track>(new Audio_track(MAX_MINUTES_TRACK, BENCH_SAMPLE_RATE));
+    Audio_file_decoding_process track_decoder(this->track, false);
+    QVERIFY2(track_decoder.run(QString(DATA_DIR) + QString(DATA_TRACK_1), "", "") == true, "decode track");
+
+    this->sampler = QSharedPointer<Audio_track>(new Audio_track(MAX_MINUTES_SAMPLER, BENCH_SAMPLE_RATE));
+    Audio_file_decoding_process sampler_decoder(this->sampler, false);
+    QVERIFY2(sampler_decoder.run(QString(DATA_DIR) + QString(DATA_TRACK_2), "", "") == true, "decode sampler");
+}
+
+void Deck_playback_process_Benchmark::cleanupTestCase()
+{
+}
+
+void Deck_playback_process_Benchmark::benchmarkRun_data()
+{
+    QTest::addColumn<int>("curve");
+    QTest::addColumn<int>("buffer_size");
+    QTest::addColumn<int>("nb_samplers");
+
+    const char *curve_names[static_cast<int>(Speed_curve::NB_CURVES)] = { "constant", "ramp", "scratch", "near_zero" };
+    const int   buffer_sizes[] = { 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const int   nb_samplers[]  = { 0, 2, 4 };
+
+    for (int curve = 0; curve < static_cast<int>(Speed_curve::NB_CURVES); curve++)
+    {
+        for (int buffer_size : buffer_sizes)
+        {
+            for (int nb : nb_samplers)
+            {
+                QString name = QString("%1/%2 frames/%3 samplers").arg(curve_names[curve])
+                                                                  .arg(buffer_size)
+                                                                  .arg(nb);
+                QTest::newRow(qPrintable(name)) << curve << buffer_size << nb;
+            }
+        }
+    }
+}
+
+/**
+ * Benchmark:
+ *   Deck_playback_process::run()
+ *
+ * Result is the mean time of a period in ns, distribution and worst case are
+ * printed next to it and compared to the duration of the period.
+ */
+void Deck_playback_process_Benchmark::benchmarkRun()
+{
+    QFETCH(int, curve);
+    QFETCH(int, buffer_size);
+    QFETCH(int, nb_samplers);
+
+    // One deck playing the track, with all samplers playing.
+    QSharedPointer<Playback_parameters> param(new Playback_parameters);
+    QList<QSharedPointer<Audio_track>> at_samplers;
+    for (int i = 0; i < nb_samplers; i++)
+    {
+        at_samplers << this->sampler;
+    }
+    Deck_playback_process playback(this->track, at_samplers, param);
+    param->set_volume(1.0f);
+    QVERIFY2(playback.reset() == true, "reset playback");
+
+    // Stay in the middle of the track, so every curve can go back and forth.
+    float track_ratio = (float)this->track->get_end_of_samples() / (float)this->track->get_max_nb_samples();
+    playback.jump_to_position(track_ratio / 2.0f);
+
+    // Out of the measure: apply queued reset and jump, and make sure the track is really played (not silence).
+    QVector<float> buf_1(buffer_size);
+    QVector<float> buf_2(buffer_size);
+    param->set_speed(1.0f);
+    QVERIFY2(playback.run(buf_1.data(), buf_2.data(), buffer_size) == true, "run playback once");
+    float max_level = 0.0f;
+    for (int i = 0; i < buffer_size; i++)
+    {
+        max_level = qMax(max_level, qMax(qAbs(buf_1[i]), qAbs(buf_2[i])));
+    }
+    QVERIFY2(max_level > 0.0f, "track is played (not silence)");
+
+    Timing_histogram histogram;
+    QElapsedTimer    timer;
+    quint64          total_ns   = 0;
+    int              nb_periods = (BENCH_DURATION_SEC * BENCH_SAMPLE_RATE) / buffer_size;
+    bool             result     = true;
+    for (int n = 0; n < nb_periods; n++)
+    {
+        // Out of the measure: set speed, restart samplers and rewind track (apply these queued commands now).
+        param->set_speed(get_speed(static_cast<Speed_curve>(curve), (float)(n * buffer_size) / BENCH_SAMPLE_RATE));
+        for (unsigned short int i = 0; i < nb_samplers; i++)
+        {
+            if (playback.get_sampler_state(i) == false)
+            {
+                playback.set_sampler_state(i, true);
+            }
+        }
+        float position = playback.get_position();
+        if ((position < track_ratio * 0.1f) || (position > track_ratio * 0.9f))
+        {
+            playback.jump_to_position(track_ratio / 2.0f);
+        }
+        playback.apply_commands();
+
+        timer.start();
+        result &= playback.run(buf_1.data(), buf_2.data(), buffer_size);
+        quint64 ns = timer.nsecsElapsed();
+
+        histogram.add(ns);
+        total_ns += ns;
+    }
+    QVERIFY2(result == true, "run playback");
+
+    // Report.
+    Timing_stats stats     = histogram.get_stats();
+    quint64      period_ns = (quint64)buffer_size * 1000000000 / BENCH_SAMPLE_RATE;
+    qInfo().nospace() << "p50=" << stats.p50_ns << "ns p99=" << stats.p99_ns << "ns max=" << stats.max_ns << "ns"
+                      << " (worst case = " << (100 * stats.max_ns / period_ns) << "% of a " << period_ns / 1000 << "us period)";
+    QTest::setBenchmarkResult((qreal)total_ns / nb_periods, QTest::WalltimeNanoseconds);
+}
@@ -0,0 +1,61 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Benchmark                       */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QObject>
+#include <QtTest>
+#include <QSharedPointer>
+
+#include "tracks/audio_track.h"
+
+enum class Speed_curve
+{
+    CONSTANT,  // Normal speed.
+    RAMP,      // From 0 to 2 and back (start/stop, pitch bend).
+    SCRATCH,   // Fast back and forth.
+    NEAR_ZERO, // Very slow, worst case for the resampler input size.
+    NB_CURVES
+};
+
+class Deck_playback_process_Benchmark : public QObject
+{
+    Q_OBJECT
+
+ private:
+    QSharedPointer<Audio_track> track;
+    QSharedPointer<Audio_track> sampler;
+
+ public:
+    Deck_playback_process_Benchmark();
+
+ private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkRun_data();
+    void benchmarkRun();
+};
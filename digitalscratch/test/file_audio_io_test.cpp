@@ -0,0 +1,164 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Test                            */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include <digital_scratch.h>
+#include "singleton.h"
+#include "app/application_settings.h"
+#include "player/playback_parameters.h"
+#include "player/deck_playback_process.h"
+#include "player/control_and_playback_process.h"
+#include "control/timecode_control_process.h"
+#include "control/manual_control_process.h"
+#include "audiodev/audio_io_control_rules.h"
+#include "audiodev/file_audio_io.h"
+#include "tracks/audio_file_decoding_process.h"
+#include "file_audio_io_test.h"
+
+#define DATA_DIR     "./test/data/"
+#define DATA_TRACK_1 "b_comp_-_p_dust.mp3"
+#define TIMECODE_1   "scratchlivecontrol-vinylrip-33rpm+0.mp3"
+#define FILE_IO_NB_FRAMES 512
+
+static bool run_with_files(const QString &in_path, const QString &out_path, quint64 &out_nb_frames, float &out_speed)
+{
+    // Full stack of one deck, timecode and playback through WAV files.
+    Application_settings *settings = &Singleton<Application_settings>::get_instance();
+    settings->set_sample_rate(44100);
+    settings->set_vinyl_type(0, SERATO);
+    settings->set_nb_decks(1);
+
+    QSharedPointer<Playback_parameters> play_param(new Playback_parameters);
+    QSharedPointer<Timecode_control_process> tcode_control(new Timecode_control_process(play_param,
+                                                                                        settings->get_vinyl_type(0),
+                                                                                        settings->get_sample_rate()));
+    QList<QSharedPointer<Timecode_control_process>> tcode_controls = {tcode_control};
+    QSharedPointer<Manual_control_process> manual_control(new Manual_control_process(play_param));
+    QList<QSharedPointer<Manual_control_process>> manual_controls = {manual_control};
+
+    QSharedPointer<Audio_track> at(new Audio_track(MAX_MINUTES_TRACK, settings->get_sample_rate()));
+    Audio_file_decoding_process decoder(at, false);
+    if (decoder.run(QString(DATA_DIR) + QString(DATA_TRACK_1), "", "") == false)
+    {
+        return false;
+    }
+    QSharedPointer<Audio_track> at_s(new Audio_track(MAX_MINUTES_SAMPLER, settings->get_sample_rate()));
+    QList<QSharedPointer<Audio_track>> at_sampler = {at_s};
+    QSharedPointer<Deck_playback_process> at_playback(new Deck_playback_process(at, at_sampler, play_param));
+    QList<QSharedPointer<Deck_playback_process>> at_playbacks = {at_playback};
+
+    // Start playing the track from the beginning (as done by the GUI when a track is loaded).
+    if (at_playback->reset() == false)
+    {
+        return false;
+    }
+
+    QSharedPointer<File_audio_io> files(new File_audio_io(settings->get_nb_decks() * 2, {in_path}, {out_path}, FILE_IO_NB_FRAMES));
+    QSharedPointer<Audio_IO_control_rules> sound_card = files;
+    QSharedPointer<Control_and_playback_process> capture_and_play(new Control_and_playback_process(tcode_controls,
+                                                                                                  manual_controls,
+                                                                                                  at_playbacks,
+                                                                                                  sound_card,
+                                                                                                  settings->get_nb_decks()));
+    capture_and_play->set_process_mode(ProcessMode::TIMECODE, 0);
+
+    // Process the whole input file.
+    bool result   = sound_card->start((void*)capture_and_play.data());
+    out_nb_frames = files->get_nb_processed_frames();
+    out_speed     = play_param->get_speed();
+
+    return result;
+}
+
+static float l_get_max_level(const QByteArray &wav_data)
+{
+    // Written WAV files contain interleaved 32 bits float samples after the header.
+    const float *samples    = reinterpret_cast<const float*>(wav_data.constData() + WAV_HEADER_SIZE);
+    int          nb_samples = (wav_data.size() - WAV_HEADER_SIZE) / sizeof(float);
+    float        max_level  = 0.0f;
+    for (int i = 0; i < nb_samples; i++)
+    {
+        max_level = qMax(max_level, qAbs(samples[i]));
+    }
+
+    return max_level;
+}
+
+File_audio_io_Test::File_audio_io_Test()
+{
+}
+
+void File_audio_io_Test::initTestCase()
+{
+}
+
+void File_audio_io_Test::cleanupTestCase()
+{
+    // Cleanup.
+}
+
+void File_audio_io_Test::testCaseRunWithFiles()
+{
+    // Write 10 sec of timecode to a WAV file.
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid() == true, "temporary directory");
+    QSharedPointer<Audio_track> timecode(new Audio_track(15, 44100));
+    Audio_file_decoding_process decoder(timecode, false);
+    QVERIFY2(decoder.run(QString(DATA_DIR) + QString(TIMECODE_1), "", "") == true, "decode timecode");
+    quint64 nb_frames = qMin(static_cast<quint64>(10 * 44100), static_cast<quint64>(timecode->get_end_of_samples() / 2));
+    QString input_path = dir.filePath("timecode.wav");
+    QVERIFY2(File_audio_io::write_wav_file(input_path, timecode->get_samples(), nb_frames, 44100) == true, "write timecode file");
+
+    // Process it twice without any sound card.
+    quint64 nb_processed_1 = 0;
+    quint64 nb_processed_2 = 0;
+    float   speed_1        = 0.0f;
+    float   speed_2        = 0.0f;
+    QVERIFY2(run_with_files(input_path, dir.filePath("out_1.wav"), nb_processed_1, speed_1) == true, "process timecode file");
+    QVERIFY2(run_with_files(input_path, dir.filePath("out_2.wav"), nb_processed_2, speed_2) == true, "process timecode file again");
+
+    // All frames are played.
+    QVERIFY2(nb_processed_1 == nb_frames, "all frames processed");
+    QVERIFY2(nb_processed_2 == nb_frames, "all frames processed again");
+    QFile out_1(dir.filePath("out_1.wav"));
+    QFile out_2(dir.filePath("out_2.wav"));
+    QVERIFY2((out_1.open(QIODevice::ReadOnly) == true) && (out_2.open(QIODevice::ReadOnly) == true), "open output files");
+    QVERIFY2(out_1.size() == static_cast<qint64>(WAV_HEADER_SIZE + nb_frames * 2 * sizeof(float)), "size of output file");
+    QByteArray data_1 = out_1.readAll();
+    QByteArray data_2 = out_2.readAll();
+
+    // Timecode is a 33 rpm record without pitch change: the track is played at normal speed.
+    QVERIFY2(qAbs(speed_1 - 1.0f) < 0.05f, "detected speed");
+    QVERIFY2(qAbs(speed_2 - 1.0f) < 0.05f, "detected speed again");
+    QVERIFY2(l_get_max_level(data_1) > 0.01f, "track is played (not silence)");
+
+    // The result is always the same.
+    QVERIFY2(data_1 == data_2, "deterministic output");
+}
@@ -0,0 +1,60 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     Digital Scratch Player Benchmark                       */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include "deck_playback_process_benchmark.h"
+#include "audio_collection_benchmark.h"
+#include "data_persistence_benchmark.h"
+
+int main(int argc, char** argv)
+{
+    // Necessary to have an event loop needed by some benchmarks.
+    QCoreApplication app(argc, argv);
+
+   // Logging settings.
+   qSetMessagePattern("[%{type}] | %{category} | %{function}@%{line} | %{message}");
+   QLoggingCategory::setFilterRules(QStringLiteral("*.debug=false\n \
+                                                   *.warning=false\n \
+                                                   *.critical=false\n"));
+
+   // Run with "-csv" to get results which can be compared between builds.
+   int status = 0;
+   {
+      Deck_playback_process_Benchmark tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
+   {
+      Audio_collection_Benchmark tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
+   {
+      Data_persistence_Benchmark tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
+
+   return status;
+}
@@ -34,6 +34,10 @@
 #include "playlist_persistence_test.h"
 #include "audio_device_access_rules_test.h"
 #include "control_and_playback_process_test.h"
+#include "deck_command_queue_test.h"
+#include "audio_collection_model_test.h"
+#include "file_audio_io_test.h"
+#include "callback_profiler_test.h"
 
 int main(int argc, char** argv)
 {
@@ -67,6 +71,22 @@ int main(int argc, char** argv)
       Playlist_persistence_Test tc;
       status |= QTest::qExec(&tc, argc, argv);
    }
+   {
+      Deck_command_queue_Test tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
+   {
+      Audio_collection_model_Test tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
+   {
+      File_audio_io_Test tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
+   {
+      Callback_profiler_Test tc;
+      status |= QTest::qExec(&tc, argc, argv);
+   }
 #ifdef ENABLE_TEST_DEVICE
    #if 0 // FIXME: not supported for the moment.
    {
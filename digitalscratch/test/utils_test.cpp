@@ -30,14 +30,23 @@
 #include <iostream>
 #include <QtConcurrentMap>
 #include <QStandardPaths>
+#include <QTemporaryDir>
+#include <cmath>
 
 #include "utils_test.h"
+#include "audiodev/file_audio_io.h"
 
 #define DATA_DIR     "./test/data/"
 #define DATA_TRACK_1 "track_1.mp3"
 #define DATA_TRACK_2 "track_2.mp3"
 #define DATA_TRACK_3 "track_éèà@ù&_3.mp3"
 
+#define CLICK_SAMPLE_RATE  44100
+#define CLICK_DURATION_SEC 30
+#define CLICK_BPM          126.0
+#define CLICK_OFFSET_MSEC  200.0
+#define CLICK_LENGTH_MSEC  20.0
+
 Utils_Test::Utils_Test()
 {
 }
@@ -142,6 +151,55 @@ void Utils_Test::testCaseGetFileMusicKey()
     QVERIFY2(keys[2] == "09A", qPrintable(QString(DATA_TRACK_1) + QString(" key: ") + QString(keys[2])));
 }
 
+void Utils_Test::testCaseAnalyseAudioFile()
+{
+    QString      key        = "";
+    float        bpm        = 0.0;
+    unsigned int first_beat = 0;
+
+    // Bad file.
+    QVERIFY2(Utils::analyse_audio_file("", key, bpm, first_beat) == false, "analyse bad file");
+
+    // Key and tempo come from the same decoded data.
+    QVERIFY2(Utils::analyse_audio_file(QString(DATA_DIR) + QString(DATA_TRACK_1), key, bpm, first_beat) == true, "analyse track 1");
+    QVERIFY2(key == "01A",                  qPrintable(QString(DATA_TRACK_1) + QString(" key: ") + key));
+    QVERIFY2((bpm >= 60.0) && (bpm <= 200.0), qPrintable(QString(DATA_TRACK_1) + QString(" bpm: ") + QString::number(bpm)));
+    QVERIFY2(first_beat < 60000.0 / bpm,    "first beat is in the first beat period");
+}
+
+void Utils_Test::testCaseAnalyseClickTrack()
+{
+    // Synthesize a click track at a known tempo, first click after a known offset.
+    quint64        nb_frames = CLICK_SAMPLE_RATE * CLICK_DURATION_SEC;
+    QVector<short> samples(nb_frames * 2, 0);
+    float          period    = 60.0 * CLICK_SAMPLE_RATE / CLICK_BPM;
+    int            length    = CLICK_LENGTH_MSEC * CLICK_SAMPLE_RATE / 1000.0;
+    for (float start = CLICK_OFFSET_MSEC * CLICK_SAMPLE_RATE / 1000.0; start + length < nb_frames; start += period)
+    {
+        // Short decaying 1 kHz burst.
+        for (int i = 0; i < length; i++)
+        {
+            float t     = (float)i / CLICK_SAMPLE_RATE;
+            short value = 25000.0 * exp(-t / 0.005) * sin(2.0 * M_PI * 1000.0 * t);
+            samples[((quint64)start + i) * 2]     = value;
+            samples[((quint64)start + i) * 2 + 1] = value;
+        }
+    }
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid() == true, "temporary dir");
+    QString path = dir.path() + "/click.wav";
+    QVERIFY2(File_audio_io::write_wav_file(path, samples.constData(), nb_frames, CLICK_SAMPLE_RATE) == true, "write click track");
+
+    // Clicks have no music key, only check tempo and beat grid.
+    QString      key        = "";
+    float        bpm        = 0.0;
+    unsigned int first_beat = 0;
+    Utils::analyse_audio_file(path, key, bpm, first_beat);
+    QVERIFY2(qAbs(bpm - CLICK_BPM) <= 1.0, qPrintable(QString("click track bpm: ") + QString::number(bpm)));
+    QVERIFY2(qAbs((float)first_beat - CLICK_OFFSET_MSEC) <= 30.0,
+             qPrintable(QString("click track first beat: ") + QString::number(first_beat)));
+}
+
 void Utils_Test::testCaseGetNextMusicKeys()
 {
     QString next  = "";
@@ -158,3 +216,32 @@ void Utils_Test::testCaseGetNextMusicKeys()
     QVERIFY2(prev  == "11B", "12B prev key");
     QVERIFY2(oppos == "12A", "12B oppos key");
 }
+
+void Utils_Test::testCaseMusicKeyCodes()
+{
+    // Key codes.
+    QVERIFY2(Utils::get_music_key_code("01A") == 0,  "01A code");
+    QVERIFY2(Utils::get_music_key_code("12A") == 11, "12A code");
+    QVERIFY2(Utils::get_music_key_code("01B") == 12, "01B code");
+    QVERIFY2(Utils::get_music_key_code("12B") == 23, "12B code");
+    QVERIFY2(Utils::get_music_key_code("")    == -1, "empty key");
+    QVERIFY2(Utils::get_music_key_code("13A") == -1, "wrong key number");
+    QVERIFY2(Utils::get_music_key_code("01C") == -1, "wrong key mode");
+    for (int code = 0; code < NB_MUSIC_KEYS; code++)
+    {
+        QVERIFY2(Utils::get_music_key_code(Utils::get_music_key_from_code(code)) == code, "code to key to code");
+    }
+    QVERIFY2(Utils::get_music_key_from_code(24) == "", "wrong code");
+
+    // Compatible keys.
+    quint32 next       = 0;
+    quint32 next_major = 0;
+    Utils::get_next_music_key_masks(Utils::get_music_key_code("01A"), next, next_major);
+    QVERIFY2(next       == ((1u << 1) | (1u << 11)), "01A next keys: 02A and 12A");
+    QVERIFY2(next_major == (1u << 12),               "01A oppos key: 01B");
+    Utils::get_next_music_key_masks(Utils::get_music_key_code("12B"), next, next_major);
+    QVERIFY2(next       == ((1u << 12) | (1u << 22)), "12B next keys: 01B and 11B");
+    QVERIFY2(next_major == (1u << 11),                "12B oppos key: 12A");
+    Utils::get_next_music_key_masks(-1, next, next_major);
+    QVERIFY2((next == 0) && (next_major == 0), "no compatible keys of unknown key");
+}
@@ -46,5 +46,8 @@ private Q_SLOTS:
     void testCaseGetFileHash();
     void testCaseGetFileHashCharge();
     void testCaseGetFileMusicKey();
+    void testCaseAnalyseAudioFile();
+    void testCaseAnalyseClickTrack();
     void testCaseGetNextMusicKeys();
+    void testCaseMusicKeyCodes();
 };
@@ -10,6 +10,12 @@ CONFIG(test) {
     CONFIG   += console
     CONFIG   -= app_bundle
 }
+else:CONFIG(benchmark) {
+    QT       += testlib
+    TARGET    = libdigitalscratch-benchmark
+    CONFIG   += console release
+    CONFIG   -= app_bundle debug
+}
 else {
     QT -= gui
 
@@ -38,6 +44,7 @@ SOURCES += \
     src/mixvibes_vinyl.cpp \
     src/log.cpp \
     src/iir_filter.cpp \
+    src/adaptive_speed_filter.cpp \
     src/inst_freq_extractor.cpp \
     src/timecoded_signal_process.cpp \
     src/timecoded_vinyl.cpp \
@@ -49,6 +56,7 @@ HEADERS += \
     src/include/mixvibes_vinyl.h \
     src/include/log.h \
     src/include/iir_filter.h \
+    src/include/adaptive_speed_filter.h \
     src/include/inst_freq_extrator.h \
     src/include/timecoded_signal_process.h \
     src/include/timecoded_vinyl.h \
@@ -66,6 +74,16 @@ CONFIG(test) {
                test/timecoded_signal_process_test.h \
                test/digital_scratch_test.h
 }
+else:CONFIG(benchmark) {
+    INCLUDEPATH += test
+
+    SOURCES += test/main_benchmark.cpp \
+               test/test_utils.cpp \
+               test/timecode_benchmark.cpp
+
+    HEADERS += test/test_utils.h \
+               test/timecode_benchmark.h
+}
 
 OTHER_FILES += \
     AUTHORS \
@@ -99,7 +117,7 @@ OTHER_FILES += \
 
 ############################
 # Copy dll and .h for windows build
-CONFIG(test) {
+CONFIG(test)|CONFIG(benchmark) {
 }
 else {
     win32 {
@@ -117,7 +135,7 @@ else {
     }
 }
 
-CONFIG(test) {
+CONFIG(test)|CONFIG(benchmark) {
     win32 {
         DESTDIR_WIN = $${DESTDIR}
         CONFIG(debug, debug|release) {
@@ -0,0 +1,74 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*               libdigitalscratch: the Digital Scratch engine.               */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------( adaptive_speed_filter.cpp )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*      Adaptive_speed_filter class : smooth the instantaneous frequency      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <adaptive_speed_filter.h>
+#include <qmath.h>
+#include <QtGlobal>
+
+using namespace std;
+
+Adaptive_speed_filter::Adaptive_speed_filter(double carrier_freq)
+{
+    this->reset();
+    this->set_carrier_freq(carrier_freq);
+}
+
+Adaptive_speed_filter::~Adaptive_speed_filter()
+{
+    return;
+}
+
+void Adaptive_speed_filter::set_carrier_freq(double carrier_freq)
+{
+    this->inv_carrier_freq = 1.0 / qMax(carrier_freq, 1.0);
+}
+
+void Adaptive_speed_filter::reset()
+{
+    this->fast = 0.0;
+    this->slow = 0.0;
+}
+
+double Adaptive_speed_filter::compute(const double &sample)
+{
+    // Remove most of the jitter of the instantaneous frequency.
+    this->fast += SPEED_FILTER_ALPHA_FAST * (sample - this->fast);
+
+    // Relative deviation between fast and slow estimations gives the weight of the fast time constant.
+    double deviation = qAbs(this->fast - this->slow) * this->inv_carrier_freq - SPEED_FILTER_DEAD_ZONE;
+    double weight    = qBound(0.0, deviation / SPEED_FILTER_DEVIATION, 1.0);
+    double alpha     = SPEED_FILTER_ALPHA_STEADY + (SPEED_FILTER_ALPHA_FAST - SPEED_FILTER_ALPHA_STEADY) * weight;
+
+    this->slow += alpha * (this->fast - this->slow);
+
+    return this->slow;
+}
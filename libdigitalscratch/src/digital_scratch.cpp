@@ -196,6 +196,31 @@ dscratch_status_t dscratch_get_volume(dscratch_handle_t  handle,
     return DSCRATCH_SUCCESS;
 }
 
+dscratch_status_t dscratch_get_signal_quality(dscratch_handle_t          handle,
+                                              dscratch_signal_quality_t *out_quality)
+{
+    // Get handle.
+    dscratch_handle_t_struct *handle_typed;
+    if (l_get_typed_handle(handle, &handle_typed) == false)
+    {
+        return DSCRATCH_ERROR;
+    }
+
+    if (out_quality == nullptr)
+    {
+        qCCritical(DSLIB_API) << "out_quality is null.";
+        return DSCRATCH_ERROR;
+    }
+
+    // Get quality of the last analyzed buffer.
+    out_quality->amplitude            = handle_typed->dscratch->get_signal_amplitude();
+    out_quality->quality              = handle_typed->dscratch->get_signal_quality();
+    out_quality->direction_confidence = handle_typed->dscratch->get_direction_confidence();
+    out_quality->inst_freq            = handle_typed->dscratch->get_filtered_freq();
+
+    return DSCRATCH_SUCCESS;
+}
+
 dscratch_status_t dscratch_display_turntable(dscratch_handle_t handle)
 {
     dscratch_vinyls_t vinyl;
@@ -230,6 +255,41 @@ dscratch_status_t dscratch_display_turntable(dscratch_handle_t handle)
     return DSCRATCH_SUCCESS;
 }
 
+dscratch_status_t dscratch_start_vinyl_detection(dscratch_handle_t handle)
+{
+    // Get handle.
+    dscratch_handle_t_struct *handle_typed;
+    if (l_get_typed_handle(handle, &handle_typed) == false)
+    {
+        return DSCRATCH_ERROR;
+    }
+
+    // Vinyl type and RPM will be changed during the next calls of dscratch_process_captured_timecoded_signal().
+    handle_typed->dscratch->start_vinyl_detection();
+
+    return DSCRATCH_SUCCESS;
+}
+
+dscratch_status_t dscratch_is_detecting_vinyl(dscratch_handle_t  handle,
+                                              bool              *out_detecting)
+{
+    // Get handle.
+    dscratch_handle_t_struct *handle_typed;
+    if (l_get_typed_handle(handle, &handle_typed) == false)
+    {
+        return DSCRATCH_ERROR;
+    }
+
+    if (out_detecting == nullptr)
+    {
+        qCCritical(DSLIB_API) << "out_detecting is null.";
+        return DSCRATCH_ERROR;
+    }
+    *out_detecting = handle_typed->dscratch->is_detecting_vinyl();
+
+    return DSCRATCH_SUCCESS;
+}
+
 const char *dscratch_get_version()
 {
     return STR(VERSION);
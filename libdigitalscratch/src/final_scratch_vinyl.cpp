@@ -79,3 +79,15 @@ float Final_scratch_vinyl::get_volume_from_freq(const float freq)
 
     return volume;
 }
+
+float Final_scratch_vinyl::get_sinusoidal_freq()
+{
+    if (this->get_rpm() == RPM_33)
+    {
+        return FINAL_SCRATCH_SINUSOIDAL_FREQ;
+    }
+    else
+    {
+        return FINAL_SCRATCH_SINUSOIDAL_FREQ_45RPM;
+    }
+}
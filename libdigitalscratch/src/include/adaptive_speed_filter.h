@@ -0,0 +1,66 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*               libdigitalscratch: the Digital Scratch engine.               */
+/*                                                                            */
+/*                                                                            */
+/*------------------------------------------------( adaptive_speed_filter.h )-*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*------------------------------------------------------------( Description )-*/
+/*                                                                            */
+/*      Adaptive_speed_filter class : smooth the instantaneous frequency      */
+/*                                                                            */
+/*============================================================================*/
+
+#pragma once
+
+// Smoothing of a steady signal, same as the previous fixed IIR filter ({1.0, -0.998}, {0.001, 0.001}).
+#define SPEED_FILTER_ALPHA_STEADY 0.002
+
+// Smoothing while the frequency changes fast (~20 samples, 0.5 ms @ 44.1 kHz).
+#define SPEED_FILTER_ALPHA_FAST   0.05
+
+// Deviation (part of the carrier frequency) ignored as jitter, and the one using
+// the fast smoothing only.
+#define SPEED_FILTER_DEAD_ZONE    0.03
+#define SPEED_FILTER_DEVIATION    0.10
+
+/**
+ * One-pole low pass filter with a time constant depending on the change of the
+ * frequency: a fast prefilter tracks the input, the output follows it slowly
+ * when they are close (steady platter) and quickly when they are not (scratch).
+ */
+class Adaptive_speed_filter
+{
+ private:
+        double fast;              // Lightly smoothed input.
+        double slow;              // Output.
+        double inv_carrier_freq;  // 1 / frequency of the timecode at normal speed.
+
+ public:
+        Adaptive_speed_filter(double carrier_freq);
+        virtual ~Adaptive_speed_filter();
+
+ public:
+    void   set_carrier_freq(double carrier_freq);
+    double compute(const double &sample);
+    void   reset();
+};
@@ -71,6 +71,15 @@ enum dscratch_vinyl_rpm_t
 // Handle used by API functions to identify the turntable.
 typedef void* dscratch_handle_t;
 
+// Quality of the timecoded signal of the last analyzed buffer.
+struct dscratch_signal_quality_t
+{
+    float amplitude;             // RMS amplitude of the left/right signal (0.0 = no signal).
+    float quality;               // Phase coherence of the carrier (0.0 = noise, 1.0 = clean signal).
+    float direction_confidence;  // Part of signal (by module) agreeing on the direction (0.0 = unknown, 1.0 = sure).
+    float inst_freq;             // Filtered instantaneous frequency (Hz), negative if playing backward.
+};
+
 /**
  * Create a new turntable.
  *
@@ -140,6 +149,20 @@ DLLIMPORT dscratch_status_t dscratch_get_speed(dscratch_handle_t  handle,
 DLLIMPORT dscratch_status_t dscratch_get_volume(dscratch_handle_t  handle,
                                                 float             *volume);
 
+/**
+ * Returns the quality of the signal captured from vinyl on turntable
+ * (only relevant if dscratch_process_captured_timecoded_signal() was called).
+ * It is computed during the analysis, so it is cheap to call it every period
+ * (e.g. to display a quality meter or to detect a dirty needle).
+ *
+ * @param handle is used to identify the turntable.
+ * @param out_quality will be filled with the quality of the last analyzed buffer.
+ *
+ * @return DSCRATCH_SUCCESS if all is OK.
+ */
+DLLIMPORT dscratch_status_t dscratch_get_signal_quality(dscratch_handle_t          handle,
+                                                        dscratch_signal_quality_t *out_quality);
+
 /**
  * Get DigitalScratch version.
  *
@@ -226,6 +249,31 @@ DLLIMPORT dscratch_status_t dscratch_get_rpm(dscratch_handle_t     handle,
  */
 DLLIMPORT dscratch_vinyl_rpm_t dscratch_get_default_rpm();
 
+/**
+ * Start the automatic detection of the vinyl type and RPM of a turntable.
+ * The frequency of the timecode is measured during the next second of stable
+ * playback (pitch at 0%), then the nearest known vinyl type and RPM are used.
+ * Detection stops by itself, it costs nothing once the vinyl is detected.
+ *
+ * @param handle is used to identify the turntable.
+ *
+ * @return DSCRATCH_SUCCESS if all is OK.
+ */
+DLLIMPORT dscratch_status_t dscratch_start_vinyl_detection(dscratch_handle_t handle);
+
+/**
+ * Check if the detection of the vinyl type and RPM is still running.
+ * Once it is finished, use dscratch_get_turntable_vinyl_type() and
+ * dscratch_get_rpm() to get the detected values.
+ *
+ * @param handle is used to identify the turntable.
+ * @param out_detecting is set to true while the vinyl is not detected.
+ *
+ * @return DSCRATCH_SUCCESS if all is OK.
+ */
+DLLIMPORT dscratch_status_t dscratch_is_detecting_vinyl(dscratch_handle_t  handle,
+                                                        bool              *out_detecting);
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,4 +57,5 @@ class Final_scratch_vinyl : public Timecoded_vinyl
     public:
         float get_speed_from_freq(const float freq);
         float get_volume_from_freq(const float freq);
+        float get_sinusoidal_freq();
 };
@@ -51,5 +51,6 @@ class Inst_freq_extractor
  public:
     void compute(double x0, double y0);
     double getCurrentInstModule();
+    double getCurrentInstModuleSquared();
     double getCurrentInstFreq();
 };
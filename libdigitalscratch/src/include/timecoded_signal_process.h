@@ -34,26 +34,48 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <QVector>
 
 #include "timecoded_vinyl.h"
 #include "final_scratch_vinyl.h"
 #include "serato_vinyl.h"
 #include "mixvibes_vinyl.h"
-#include "iir_filter.h"
+#include "adaptive_speed_filter.h"
 #include "inst_freq_extrator.h"
 
+// Automatic detection of vinyl type and RPM.
+#define VINYL_DETECT_MIN_QUALITY    0.9f    // Minimum signal quality and direction confidence of a stable buffer.
+#define VINYL_DETECT_MAX_DRIFT      0.01f   // Maximum relative change of frequency between 2 stable buffers.
+#define VINYL_DETECT_MAX_DEVIATION  0.015f  // Maximum relative distance to a known carrier (i.e. pitch fader at 0%).
+
 class Timecoded_signal_process
 {
     private:
-        Timecoded_vinyl *vinyl;
+        Timecoded_vinyl *vinyls[NB_DSCRATCH_VINYLS]; // All supported vinyls, created once (changing vinyl does not allocate).
+        Timecoded_vinyl *vinyl;                      // Vinyl currently used.
         float            speed;
         float            volume;
 
         // Frequency and amplitude analysis.
-        IIR_filter          speed_IIR;
-        Inst_freq_extractor freq_inst;
-        double              filtered_freq_inst;
+        Adaptive_speed_filter speed_filter;
+        Inst_freq_extractor   freq_inst;
+        double                filtered_freq_inst;
+
+        // Signal quality of the last buffer.
+        double                prev_sample_1;
+        double                prev_sample_2;
+        float                 signal_amplitude;
+        float                 signal_quality;
+        float                 direction_confidence;
+
+        // Vinyl detection.
+        unsigned int          sample_rate;
+        std::atomic<bool>     detection_requested;   // Set by start_vinyl_detection() from any thread, consumed by run().
+        std::atomic<bool>     detecting_vinyl;       // Only changed by run().
+        double                detect_freq_sum;       // Sum of frequencies of stable samples.
+        unsigned int          detect_nb_samples;     // Number of consecutive stable samples.
+        float                 detect_prev_freq;
 
     public:
         Timecoded_signal_process(dscratch_vinyls_t coded_vinyl_type,
@@ -71,8 +93,16 @@ class Timecoded_signal_process
 
         float get_speed();
         float get_volume();
+        float get_signal_amplitude();
+        float get_signal_quality();
+        float get_direction_confidence();
+        float get_filtered_freq();
+
+        void start_vinyl_detection();
+        bool is_detecting_vinyl();
 
     private:
         bool init(dscratch_vinyls_t coded_vinyl_type);
         void clean();
+        void detect_vinyl(const int &nb_samples);
 };
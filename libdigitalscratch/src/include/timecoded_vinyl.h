@@ -59,4 +59,5 @@ class Timecoded_vinyl
 
     virtual float get_speed_from_freq(const float freq) = 0;
     virtual float get_volume_from_freq(const float freq) = 0;
+    virtual float get_sinusoidal_freq() = 0; // Frequency of the timecode at normal speed (depends on RPM).
 };
@@ -74,6 +74,11 @@ double Inst_freq_extractor::getCurrentInstModule()
     return qSqrt(this->currentInstModuleSquared);
 }
 
+double Inst_freq_extractor::getCurrentInstModuleSquared()
+{
+    return this->currentInstModuleSquared;
+}
+
 double Inst_freq_extractor::getCurrentInstFreq()
 {
     return this->currentInstFreq;
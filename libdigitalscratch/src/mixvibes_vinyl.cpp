@@ -79,3 +79,15 @@ float Mixvibes_vinyl::get_volume_from_freq(const float freq)
 
     return volume;
 }
+
+float Mixvibes_vinyl::get_sinusoidal_freq()
+{
+    if (this->get_rpm() == RPM_33)
+    {
+        return MIXVIBES_SINUSOIDAL_FREQ;
+    }
+    else
+    {
+        return MIXVIBES_SINUSOIDAL_FREQ_45RPM;
+    }
+}
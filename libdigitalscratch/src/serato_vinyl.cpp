@@ -81,3 +81,15 @@ float Serato_vinyl::get_volume_from_freq(const float freq)
 //cout << "volume = " << volume << endl;
     return volume;
 }
+
+float Serato_vinyl::get_sinusoidal_freq()
+{
+    if (this->get_rpm() == RPM_33)
+    {
+        return SERATO_VINYL_SINUSOIDAL_FREQ;
+    }
+    else
+    {
+        return SERATO_VINYL_SINUSOIDAL_FREQ_45RPM;
+    }
+}
@@ -34,6 +34,7 @@
 #include <cstdio>
 #include <string>
 #include <iterator>
+#include <qmath.h>
 
 using namespace std;
 
@@ -42,36 +43,43 @@ using namespace std;
 #include "timecoded_signal_process.h"
 
 Timecoded_signal_process::Timecoded_signal_process(dscratch_vinyls_t coded_vinyl_type,
-                                                   unsigned int      sample_rate) : speed_IIR({1.0, -0.998}, {0.001, 0.001}),
+                                                   unsigned int      sample_rate) : speed_filter(0.0),
                                                                                     freq_inst(sample_rate),
-                                                                                    filtered_freq_inst(0.0)
+                                                                                    filtered_freq_inst(0.0),
+                                                                                    prev_sample_1(0.0),
+                                                                                    prev_sample_2(0.0),
+                                                                                    signal_amplitude(0.0),
+                                                                                    signal_quality(0.0),
+                                                                                    direction_confidence(0.0),
+                                                                                    sample_rate(sample_rate),
+                                                                                    detection_requested(false),
+                                                                                    detecting_vinyl(false),
+                                                                                    detect_freq_sum(0.0),
+                                                                                    detect_nb_samples(0),
+                                                                                    detect_prev_freq(0.0)
 {
+    // Create all vinyls, so the vinyl can be changed by the signal processing itself.
+    this->vinyls[FINAL_SCRATCH] = new Final_scratch_vinyl();
+    this->vinyls[SERATO]        = new Serato_vinyl();
+    this->vinyls[MIXVIBES]      = new Mixvibes_vinyl();
+    this->vinyl                 = nullptr;
+
     // Init.
     this->init(coded_vinyl_type);
 }
 
 bool Timecoded_signal_process::init(dscratch_vinyls_t coded_vinyl_type)
 {
-    this->vinyl = nullptr;
-    switch(coded_vinyl_type)
+    if ((static_cast<int>(coded_vinyl_type) < 0) || (coded_vinyl_type >= NB_DSCRATCH_VINYLS))
     {
-        case FINAL_SCRATCH :
-            this->vinyl = new Final_scratch_vinyl();
-            break;
-
-        case SERATO :
-            this->vinyl = new Serato_vinyl();
-            break;
-
-        case MIXVIBES :
-            this->vinyl = new Mixvibes_vinyl();
-            break;
-
-        default :
-            qCCritical(DSLIB_CONTROLLER) << "Cannot create Digital_scratch object with NULL vinyl.";
-            return false;
+        qCCritical(DSLIB_CONTROLLER) << "Cannot create Digital_scratch object with NULL vinyl.";
+        return false;
     }
 
+    // Use the vinyl as a new one.
+    this->vinyl = this->vinyls[coded_vinyl_type];
+    this->vinyl->set_rpm(DEFAULT_RPM);
+
     return true;
 }
 
@@ -83,9 +91,9 @@ Timecoded_signal_process::~Timecoded_signal_process()
 
 void Timecoded_signal_process::clean()
 {
-    if (this->vinyl != NULL)
+    for (int i = 0; i < NB_DSCRATCH_VINYLS; i++)
     {
-        delete this->vinyl;
+        delete this->vinyls[i];
     }
 }
 
@@ -102,6 +110,19 @@ bool Timecoded_signal_process::run(const QVector<float> &input_samples_1,
     // The goal of this method is to analyze input datas and calculate speed and volume.
     qCDebug(DSLIB_ANALYZEVINYL) << "Extracting frequency and amplitude from recorded samples...";
 
+    // Time constant of the speed filter depends on the deviation from the carrier frequency (RPM may have changed).
+    this->speed_filter.set_carrier_freq(this->vinyl->get_sinusoidal_freq());
+
+    // Signal quality accumulators: energy of the complex sample, lag-1 correlation
+    // (rotation between 2 samples) and direction of each sample weighted by its module,
+    // so silence or DC (no rotation) does not vote for any direction.
+    double energy         = 0.0;
+    double prev_energy    = 0.0;
+    double correlation_re = 0.0;
+    double correlation_im = 0.0;
+    double direction      = 0.0;
+    double total_module   = 0.0;
+
     // Processing loop: One sample per iteration.
     for (int i = 0; i < input_samples_1.size(); i++)
     {
@@ -113,7 +134,44 @@ bool Timecoded_signal_process::run(const QVector<float> &input_samples_1,
         this->freq_inst.compute(right_sample, left_sample);
 
         // Filter the instantaneous frequency
-        this->filtered_freq_inst = this->speed_IIR.compute(this->freq_inst.getCurrentInstFreq());
+        this->filtered_freq_inst = this->speed_filter.compute(this->freq_inst.getCurrentInstFreq());
+
+        // Accumulate signal quality data.
+        energy         += left_sample * left_sample + right_sample * right_sample;
+        prev_energy    += this->freq_inst.getCurrentInstModuleSquared(); // Module of the previous sample.
+        correlation_re += right_sample * this->prev_sample_2 + left_sample * this->prev_sample_1;
+        correlation_im += left_sample * this->prev_sample_2 - right_sample * this->prev_sample_1;
+        double module   = this->freq_inst.getCurrentInstModule();
+        double freq     = this->freq_inst.getCurrentInstFreq();
+        direction      += (freq > 0.0) ? module : ((freq < 0.0) ? -module : 0.0);
+        total_module   += module;
+        this->prev_sample_1 = left_sample;
+        this->prev_sample_2 = right_sample;
+    }
+
+    // Signal quality: a clean carrier rotates by the same angle between 2 samples
+    // (correlation close to the energy), noise does not.
+    double nb_samples          = input_samples_1.size();
+    this->signal_amplitude     = qSqrt(energy / nb_samples);
+    this->signal_quality       = qSqrt(correlation_re * correlation_re + correlation_im * correlation_im)
+                                 / qMax(qSqrt(energy * prev_energy), 1e-12);
+    this->signal_quality       = qMin(this->signal_quality, 1.0f);
+    this->direction_confidence = (total_module > 0.0) ? qAbs(direction) / total_module : 0.0;
+
+    // Start a detection requested by another thread (detection data is only used here).
+    if (this->detection_requested == true)
+    {
+        this->detect_freq_sum     = 0.0;
+        this->detect_nb_samples   = 0;
+        this->detect_prev_freq    = 0.0;
+        this->detecting_vinyl     = true;
+        this->detection_requested = false;
+    }
+
+    // Find vinyl type and RPM (only until they are found).
+    if (this->detecting_vinyl == true)
+    {
+        this->detect_vinyl(input_samples_1.size());
     }
 
     this->speed  = this->vinyl->get_speed_from_freq(filtered_freq_inst);
@@ -122,6 +180,95 @@ bool Timecoded_signal_process::run(const QVector<float> &input_samples_1,
     return true;
 }
 
+void Timecoded_signal_process::start_vinyl_detection()
+{
+    // Detection is started by the next run().
+    this->detection_requested = true;
+}
+
+bool Timecoded_signal_process::is_detecting_vinyl()
+{
+    return (this->detection_requested == true) || (this->detecting_vinyl == true);
+}
+
+void Timecoded_signal_process::detect_vinyl(const int &nb_samples)
+{
+    // Known carriers (Final Scratch uses the same frequency at 33 and 45 rpm).
+    static const struct
+    {
+        dscratch_vinyls_t    vinyl_type;
+        dscratch_vinyl_rpm_t rpm;
+        float                freq;
+    } carriers[] =
+    {
+        { FINAL_SCRATCH, RPM_33, FINAL_SCRATCH_SINUSOIDAL_FREQ },
+        { SERATO,        RPM_33, SERATO_VINYL_SINUSOIDAL_FREQ },
+        { SERATO,        RPM_45, SERATO_VINYL_SINUSOIDAL_FREQ_45RPM },
+        { MIXVIBES,      RPM_33, MIXVIBES_SINUSOIDAL_FREQ },
+        { MIXVIBES,      RPM_45, MIXVIBES_SINUSOIDAL_FREQ_45RPM }
+    };
+
+    // Only use buffers of stable playback, start again if it is not stable.
+    float freq   = qAbs(this->filtered_freq_inst);
+    bool  stable = (this->signal_quality       > VINYL_DETECT_MIN_QUALITY) &&
+                   (this->direction_confidence > VINYL_DETECT_MIN_QUALITY) &&
+                   (this->detect_prev_freq     > 0.0) &&
+                   (qAbs(freq - this->detect_prev_freq) < VINYL_DETECT_MAX_DRIFT * this->detect_prev_freq);
+    this->detect_prev_freq = freq;
+    if (stable == false)
+    {
+        this->detect_freq_sum   = 0.0;
+        this->detect_nb_samples = 0;
+        return;
+    }
+    this->detect_freq_sum   += freq * nb_samples;
+    this->detect_nb_samples += nb_samples;
+    if (this->detect_nb_samples < this->sample_rate)
+    {
+        return; // Wait for 1 second of stable playback.
+    }
+
+    // Get the nearest carrier, as measured by Inst_freq_extractor (it underestimates high frequencies).
+    float mean_freq     = this->detect_freq_sum / this->detect_nb_samples;
+    int   nearest       = -1;
+    float nearest_freq  = 0.0;
+    for (unsigned int i = 0; i < sizeof(carriers) / sizeof(carriers[0]); i++)
+    {
+        float measured_freq = this->sample_rate / (2.0 * M_PI) * qSin(2.0 * M_PI * carriers[i].freq / this->sample_rate);
+        if ((nearest == -1) || (qAbs(mean_freq - measured_freq) < qAbs(mean_freq - nearest_freq)))
+        {
+            nearest      = i;
+            nearest_freq = measured_freq;
+        }
+    }
+    this->detect_freq_sum   = 0.0;
+    this->detect_nb_samples = 0;
+    if (qAbs(mean_freq - nearest_freq) > VINYL_DETECT_MAX_DEVIATION * nearest_freq)
+    {
+        qCDebug(DSLIB_CONTROLLER) << "Unknown timecode frequency:" << mean_freq << "Hz, pitch is maybe not at 0%.";
+        return;
+    }
+
+    // Use detected vinyl (only change it if the type changed).
+    dscratch_vinyl_rpm_t prev_rpm = this->vinyl->get_rpm();
+    if (this->vinyl != this->vinyls[carriers[nearest].vinyl_type])
+    {
+        this->change_coded_vinyl(carriers[nearest].vinyl_type);
+    }
+    if (carriers[nearest].vinyl_type == FINAL_SCRATCH)
+    {
+        this->vinyl->set_rpm(prev_rpm); // Can not be detected.
+    }
+    else
+    {
+        this->vinyl->set_rpm(carriers[nearest].rpm);
+    }
+    this->speed_filter.set_carrier_freq(this->vinyl->get_sinusoidal_freq());
+    this->detecting_vinyl = false;
+    qCDebug(DSLIB_CONTROLLER) << "Detected timecode frequency:" << mean_freq << "Hz, vinyl type:" << carriers[nearest].vinyl_type
+                              << ", rpm:" << this->vinyl->get_rpm();
+}
+
 Timecoded_vinyl* Timecoded_signal_process::get_coded_vinyl()
 {
     return this->vinyl;
@@ -129,10 +276,7 @@ Timecoded_vinyl* Timecoded_signal_process::get_coded_vinyl()
 
 bool Timecoded_signal_process::change_coded_vinyl(dscratch_vinyls_t coded_vinyl_type)
 {
-    // First clean all in Digital_scratch object.
-    this->clean();
-
-    // Then create a new coded vinyl.
+    // Only switch to another preallocated vinyl (no allocation, it can be called by run()).
     return this->init(coded_vinyl_type);
 }
 
@@ -145,3 +289,23 @@ float Timecoded_signal_process::get_volume()
 {
     return this->volume;
 }
+
+float Timecoded_signal_process::get_signal_amplitude()
+{
+    return this->signal_amplitude;
+}
+
+float Timecoded_signal_process::get_signal_quality()
+{
+    return this->signal_quality;
+}
+
+float Timecoded_signal_process::get_direction_confidence()
+{
+    return this->direction_confidence;
+}
+
+float Timecoded_signal_process::get_filtered_freq()
+{
+    return this->filtered_freq_inst;
+}
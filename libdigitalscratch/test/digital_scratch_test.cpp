@@ -27,6 +27,7 @@
 /*============================================================================*/
 
 #include <QtTest>
+#include <qmath.h>
 #include <string>
 #include <fstream>
 #include <iostream>
@@ -34,6 +35,8 @@
 
 #include "test_utils.h"
 #include <digital_scratch_test.h>
+#include <serato_vinyl.h>
+#include <mixvibes_vinyl.h>
 
 DigitalScratch_Test::DigitalScratch_Test()
 {
@@ -154,6 +157,147 @@ void DigitalScratch_Test::testCase_dscratch_analyze_timecode_serato_noises()
     l_dscratch_analyze_timecode(SERATO, TIMECODE_SERATO_33RPM_NOISES);
 }
 
+/**
+ * Test:
+ *   dscratch_get_signal_quality()
+ */
+void DigitalScratch_Test::testCase_dscratch_get_signal_quality()
+{
+    dscratch_handle_t         handle = nullptr;
+    dscratch_signal_quality_t quality;
+    QVector<float>            left(4096);
+    QVector<float>            right(4096);
+
+    QVERIFY2(dscratch_create_turntable(SERATO, 44100, &handle) == DSCRATCH_SUCCESS, "create turntable");
+    QVERIFY2(dscratch_get_signal_quality(handle, nullptr) == DSCRATCH_ERROR, "null output");
+
+    // Clean 1kHz carrier (left is 90 degrees ahead of right): forward.
+    for (int i = 0; i < left.size(); i++)
+    {
+        left[i]  = 0.5 * qSin(2.0 * M_PI * 1000.0 * i / 44100.0);
+        right[i] = 0.5 * qCos(2.0 * M_PI * 1000.0 * i / 44100.0);
+    }
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &left[0], &right[0], left.size()) == DSCRATCH_SUCCESS, "analyze carrier");
+    QVERIFY2(dscratch_get_signal_quality(handle, &quality) == DSCRATCH_SUCCESS, "get quality of carrier");
+    QVERIFY2(qAbs(quality.amplitude - 0.5) < 0.01, qPrintable("amplitude = " + QString::number(quality.amplitude)));
+    QVERIFY2(quality.quality > 0.99, qPrintable("quality = " + QString::number(quality.quality)));
+    QVERIFY2(quality.direction_confidence > 0.99, "sure of direction");
+    QVERIFY2(quality.inst_freq > 0.0, "forward");
+
+    // Same carrier with swapped channels: backward.
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &right[0], &left[0], left.size()) == DSCRATCH_SUCCESS, "analyze reversed carrier");
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &right[0], &left[0], left.size()) == DSCRATCH_SUCCESS, "analyze reversed carrier");
+    QVERIFY2(dscratch_get_signal_quality(handle, &quality) == DSCRATCH_SUCCESS, "get quality of reversed carrier");
+    QVERIFY2(quality.quality > 0.99, "quality of reversed carrier");
+    QVERIFY2(quality.inst_freq < 0.0, "backward");
+
+    // White noise: no coherence.
+    qsrand(1);
+    for (int i = 0; i < left.size(); i++)
+    {
+        left[i]  = (float)qrand() / RAND_MAX - 0.5;
+        right[i] = (float)qrand() / RAND_MAX - 0.5;
+    }
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &left[0], &right[0], left.size()) == DSCRATCH_SUCCESS, "analyze noise");
+    QVERIFY2(dscratch_get_signal_quality(handle, &quality) == DSCRATCH_SUCCESS, "get quality of noise");
+    QVERIFY2(quality.amplitude > 0.1, "noise amplitude");
+    QVERIFY2(quality.quality < 0.2, qPrintable("noise quality = " + QString::number(quality.quality)));
+
+    // Silence.
+    left.fill(0.0);
+    right.fill(0.0);
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &left[0], &right[0], left.size()) == DSCRATCH_SUCCESS, "analyze silence");
+    QVERIFY2(dscratch_get_signal_quality(handle, &quality) == DSCRATCH_SUCCESS, "get quality of silence");
+    QVERIFY2(quality.amplitude == 0.0, "no amplitude");
+    QVERIFY2(quality.quality == 0.0, "no quality");
+    QVERIFY2(quality.direction_confidence == 0.0, "unknown direction of silence");
+
+    // DC: no rotation, so no direction (first samples still see the step from silence).
+    left.fill(0.3);
+    right.fill(0.3);
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &left[0], &right[0], left.size()) == DSCRATCH_SUCCESS, "analyze DC");
+    QVERIFY2(dscratch_process_captured_timecoded_signal(handle, &left[0], &right[0], left.size()) == DSCRATCH_SUCCESS, "analyze DC again");
+    QVERIFY2(dscratch_get_signal_quality(handle, &quality) == DSCRATCH_SUCCESS, "get quality of DC");
+    QVERIFY2(quality.direction_confidence == 0.0, "unknown direction of DC");
+
+    // Cleanup.
+    QVERIFY2(dscratch_delete_turntable(handle) == DSCRATCH_SUCCESS, "cleanup turntable");
+}
+
+/**
+ * Play a clean timecode carrier (2 seconds, by buffers of 512 samples).
+ */
+static bool l_play_carrier(dscratch_handle_t handle, const float &freq)
+{
+    QVector<float> left(512);
+    QVector<float> right(512);
+    for (int n = 0; n < 2 * 44100 / left.size(); n++)
+    {
+        for (int i = 0; i < left.size(); i++)
+        {
+            double phase = 2.0 * M_PI * freq * (n * left.size() + i) / 44100.0;
+            left[i]  = 0.5 * qSin(phase);
+            right[i] = 0.5 * qCos(phase);
+        }
+        if (dscratch_process_captured_timecoded_signal(handle, &left[0], &right[0], left.size()) != DSCRATCH_SUCCESS)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Test:
+ *   dscratch_start_vinyl_detection()
+ *   dscratch_is_detecting_vinyl()
+ */
+void DigitalScratch_Test::testCase_dscratch_vinyl_detection()
+{
+    dscratch_handle_t    handle    = nullptr;
+    bool                 detecting = false;
+    dscratch_vinyls_t    vinyl;
+    dscratch_vinyl_rpm_t rpm;
+
+    QVERIFY2(dscratch_create_turntable(FINAL_SCRATCH, 44100, &handle) == DSCRATCH_SUCCESS, "create turntable");
+    QVERIFY2(dscratch_is_detecting_vinyl(handle, &detecting) == DSCRATCH_SUCCESS, "detection state");
+    QVERIFY2(detecting == false, "no detection by default");
+    QVERIFY2(dscratch_is_detecting_vinyl(handle, nullptr) == DSCRATCH_ERROR, "null output");
+
+    // Serato at 45 rpm.
+    QVERIFY2(dscratch_start_vinyl_detection(handle) == DSCRATCH_SUCCESS, "start detection");
+    QVERIFY2(dscratch_is_detecting_vinyl(handle, &detecting) == DSCRATCH_SUCCESS, "detection state");
+    QVERIFY2(detecting == true, "detection started");
+    QVERIFY2(l_play_carrier(handle, SERATO_VINYL_SINUSOIDAL_FREQ_45RPM) == true, "play serato 45 rpm");
+    QVERIFY2(dscratch_is_detecting_vinyl(handle, &detecting) == DSCRATCH_SUCCESS, "detection state");
+    QVERIFY2(detecting == false, "serato detected");
+    QVERIFY2(dscratch_get_turntable_vinyl_type(handle, &vinyl) == DSCRATCH_SUCCESS, "get vinyl");
+    QVERIFY2(vinyl == SERATO, "serato vinyl");
+    QVERIFY2(dscratch_get_rpm(handle, &rpm) == DSCRATCH_SUCCESS, "get rpm");
+    QVERIFY2(rpm == RPM_45, "45 rpm");
+
+    // Unknown frequency (pitch too far from 0%): still detecting.
+    QVERIFY2(dscratch_start_vinyl_detection(handle) == DSCRATCH_SUCCESS, "start detection");
+    QVERIFY2(l_play_carrier(handle, 1100.0) == true, "play unknown carrier");
+    QVERIFY2(dscratch_is_detecting_vinyl(handle, &detecting) == DSCRATCH_SUCCESS, "detection state");
+    QVERIFY2(detecting == true, "unknown carrier");
+    QVERIFY2(dscratch_get_turntable_vinyl_type(handle, &vinyl) == DSCRATCH_SUCCESS, "get vinyl");
+    QVERIFY2(vinyl == SERATO, "vinyl not changed");
+
+    // Mixvibes at 33 rpm.
+    QVERIFY2(l_play_carrier(handle, MIXVIBES_SINUSOIDAL_FREQ) == true, "play mixvibes 33 rpm");
+    QVERIFY2(dscratch_is_detecting_vinyl(handle, &detecting) == DSCRATCH_SUCCESS, "detection state");
+    QVERIFY2(detecting == false, "mixvibes detected");
+    QVERIFY2(dscratch_get_turntable_vinyl_type(handle, &vinyl) == DSCRATCH_SUCCESS, "get vinyl");
+    QVERIFY2(vinyl == MIXVIBES, "mixvibes vinyl");
+    QVERIFY2(dscratch_get_rpm(handle, &rpm) == DSCRATCH_SUCCESS, "get rpm");
+    QVERIFY2(rpm == RPM_33, "33 rpm");
+
+    // Cleanup.
+    QVERIFY2(dscratch_delete_turntable(handle) == DSCRATCH_SUCCESS, "cleanup turntable");
+}
+
 /**
  * Test:
  *   dscratch_display_turntable()
@@ -50,6 +50,8 @@ private Q_SLOTS:
     void testCase_dscratch_create_turntable();
     void testCase_dscratch_analyze_timecode_serato_stop_fast();
     void testCase_dscratch_analyze_timecode_serato_noises();
+    void testCase_dscratch_get_signal_quality();
+    void testCase_dscratch_vinyl_detection();
     void testCase_dscratch_display_turntable();
     void testCase_dscratch_get_vinyl_type();
 };
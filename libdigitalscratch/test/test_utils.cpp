@@ -165,3 +165,33 @@ int l_get_next_buffer_of_timecode(QStringList    &csv_data,
     return false;
 }
 
+int l_read_timecode_file(const QString  &file_name,
+                         QVector<float> &channel_1,
+                         QVector<float> &channel_2)
+{
+    channel_1.clear();
+    channel_2.clear();
+
+    QStringList csv_data;
+    if (l_read_text_file_to_string_list(file_name, csv_data) != 0)
+    {
+        return -1;
+    }
+
+    // Concatenate all buffers of the recording.
+    QVector<float> buffer_1;
+    QVector<float> buffer_2;
+    float          expected_speed = 0.0;
+    while (l_get_next_buffer_of_timecode(csv_data, buffer_1, buffer_2, expected_speed) == false)
+    {
+        channel_1 += buffer_1;
+        channel_2 += buffer_2;
+    }
+
+    if (channel_1.isEmpty() == true)
+    {
+        return -1;
+    }
+
+    return 0;
+}
@@ -64,4 +64,15 @@ int l_get_next_buffer_of_timecode(QStringList    &csv_data,
                                   QVector<float> &channel_2,
                                   float          &expected_speed);
 
+/**
+ * @brief l_read_timecode_file read all buffers of a timecode CSV file and concatenate them.
+ * @param file_name is the CSV timecode file to read.
+ * @param channel_1 will contain all samples of the left channel.
+ * @param channel_2 will contain all samples of the right channel.
+ * @return 0 if everything is OK.
+ */
+int l_read_timecode_file(const QString  &file_name,
+                         QVector<float> &channel_1,
+                         QVector<float> &channel_2);
+
 #endif /*TEST_UTILS_H_*/
@@ -0,0 +1,143 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     libdigitalscratch tests                                */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#include <QtTest>
+#include <QElapsedTimer>
+
+#include "test_utils.h"
+#include <timecode_benchmark.h>
+
+TimecodeProcess_Benchmark::TimecodeProcess_Benchmark()
+{
+}
+
+void TimecodeProcess_Benchmark::initTestCase()
+{
+    // Load recordings once, parsing them is much slower than processing them.
+    QVERIFY2(l_read_timecode_file(TIMECODE_FS_33RPM_SPEED100, this->fs_channel_1, this->fs_channel_2) == 0, "read final scratch timecode");
+    QVERIFY2(l_read_timecode_file(TIMECODE_SERATO_33RPM_STOP_FAST, this->serato_channel_1, this->serato_channel_2) == 0, "read serato timecode");
+}
+
+void TimecodeProcess_Benchmark::cleanupTestCase()
+{
+}
+
+void TimecodeProcess_Benchmark::benchmark_process_timecode_data()
+{
+    QTest::addColumn<int>("vinyl_type");
+    QTest::addColumn<int>("rpm");
+    QTest::addColumn<int>("buffer_size");
+    QTest::addColumn<int>("nb_decks");
+
+    const char *vinyl_names[NB_DSCRATCH_VINYLS] = { "final_scratch", "serato", "mixvibes" };
+    const int   rpms[]         = { RPM_33, RPM_45 };
+    const int   buffer_sizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+
+    for (int vinyl_type = 0; vinyl_type < NB_DSCRATCH_VINYLS; vinyl_type++)
+    {
+        for (int rpm : rpms)
+        {
+            for (int buffer_size : buffer_sizes)
+            {
+                for (int nb_decks = 1; nb_decks <= BENCHMARK_MAX_DECKS; nb_decks++)
+                {
+                    QString name = QString("%1/%2rpm/%3 frames/%4 decks").arg(vinyl_names[vinyl_type])
+                                                                        .arg(rpm)
+                                                                        .arg(buffer_size)
+                                                                        .arg(nb_decks);
+                    QTest::newRow(qPrintable(name)) << vinyl_type << rpm << buffer_size << nb_decks;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Benchmark:
+ *   dscratch_process_captured_timecoded_signal()
+ *
+ * Result is in ns per sample and per deck.
+ * There is no Mixvibes nor 45 rpm recording, the Serato one is used instead:
+ * the processing path is the same even if the speed is not detected.
+ */
+void TimecodeProcess_Benchmark::benchmark_process_timecode()
+{
+    QFETCH(int, vinyl_type);
+    QFETCH(int, rpm);
+    QFETCH(int, buffer_size);
+    QFETCH(int, nb_decks);
+
+    // Select recording.
+    QVector<float> &channel_1 = (vinyl_type == FINAL_SCRATCH) ? this->fs_channel_1 : this->serato_channel_1;
+    QVector<float> &channel_2 = (vinyl_type == FINAL_SCRATCH) ? this->fs_channel_2 : this->serato_channel_2;
+    QVERIFY2(channel_1.size() >= buffer_size, "recording long enough");
+
+    // Create one turntable per deck.
+    dscratch_handle_t handles[BENCHMARK_MAX_DECKS];
+    for (int i = 0; i < nb_decks; i++)
+    {
+        QVERIFY2(dscratch_create_turntable((dscratch_vinyls_t)vinyl_type, BENCHMARK_SAMPLE_RATE, &handles[i]) == DSCRATCH_SUCCESS, "create turntable");
+        QVERIFY2(dscratch_set_rpm(handles[i], (dscratch_vinyl_rpm_t)rpm) == DSCRATCH_SUCCESS, "set rpm");
+    }
+
+    // Process the recording buffer by buffer, loop on it if necessary.
+    // A first pass is not measured (filters initialization, cache warm up).
+    int           nb_buffers    = channel_1.size() / buffer_size;
+    int           nb_warmup     = nb_buffers;
+    int           nb_measured   = qMax(1, BENCHMARK_MIN_SAMPLES / buffer_size);
+    bool          all_succeeded = true;
+    QElapsedTimer timer;
+    qint64        elapsed_ns    = 0;
+    for (int n = 0; n < nb_warmup + nb_measured; n++)
+    {
+        if (n == nb_warmup)
+        {
+            timer.start();
+        }
+        int offset = (n % nb_buffers) * buffer_size;
+        for (int i = 0; i < nb_decks; i++)
+        {
+            all_succeeded &= (dscratch_process_captured_timecoded_signal(handles[i],
+                                                                         &channel_1[offset],
+                                                                         &channel_2[offset],
+                                                                         buffer_size) == DSCRATCH_SUCCESS);
+        }
+    }
+    elapsed_ns = timer.nsecsElapsed();
+
+    // Cleanup.
+    for (int i = 0; i < nb_decks; i++)
+    {
+        QVERIFY2(dscratch_delete_turntable(handles[i]) == DSCRATCH_SUCCESS, "cleanup turntable");
+    }
+    QVERIFY2(all_succeeded == true, "analyze data");
+
+    // Report time per sample and per deck.
+    qreal nb_samples = (qreal)nb_measured * buffer_size * nb_decks;
+    QTest::setBenchmarkResult(elapsed_ns / nb_samples, QTest::WalltimeNanoseconds);
+}
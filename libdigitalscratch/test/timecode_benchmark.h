@@ -0,0 +1,70 @@
+/*============================================================================*/
+/*                                                                            */
+/*                                                                            */
+/*                     libdigitalscratch tests                                */
+/*                                                                            */
+/*                                                                            */
+/*----------------------------------------------------------------------------*/
+/*                                                                            */
+/*  Copyright (C) 2003-2017                                                   */
+/*                Julien Rosener <julien.rosener@digital-scratch.org>         */
+/*                                                                            */
+/*----------------------------------------------------------------( License )-*/
+/*                                                                            */
+/*  This program is free software: you can redistribute it and/or modify      */
+/*  it under the terms of the GNU General Public License as published by      */
+/*  the Free Software Foundation, either version 3 of the License, or         */
+/*  (at your option) any later version.                                       */
+/*                                                                            */
+/*  This package is distributed in the hope that it will be useful,           */
+/*  but WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             */
+/*  GNU General Public License for more details.                              */
+/*                                                                            */
+/*  You should have received a copy of the GNU General Public License         */
+/*  along with this program. If not, see <http://www.gnu.org/licenses/>.      */
+/*                                                                            */
+/*============================================================================*/
+
+#ifndef TIMECODE_BENCHMARK_H_
+#define TIMECODE_BENCHMARK_H_
+
+#include <QObject>
+#include <QtTest>
+#include <iostream>
+#include <digital_scratch.h>
+
+using namespace std;
+
+// Minimum number of samples processed by each deck for one measure.
+#define BENCHMARK_MIN_SAMPLES  1000000
+#define BENCHMARK_SAMPLE_RATE  44100
+#define BENCHMARK_MAX_DECKS    3
+
+/**
+ * Measure the time spent in dscratch_process_captured_timecoded_signal().
+ * Each row reports a result in nanoseconds per sample and per deck, so the
+ * output of "-csv" can be compared between two builds.
+ */
+class TimecodeProcess_Benchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    QVector<float> fs_channel_1;     // Final Scratch recording, left channel.
+    QVector<float> fs_channel_2;     // Final Scratch recording, right channel.
+    QVector<float> serato_channel_1; // Serato recording, left channel.
+    QVector<float> serato_channel_2; // Serato recording, right channel.
+
+public:
+    TimecodeProcess_Benchmark();
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmark_process_timecode_data();
+    void benchmark_process_timecode();
+};
+
+#endif /*TIMECODE_BENCHMARK_H_*/
@@ -37,6 +37,8 @@ using namespace std;
 
 #include "test_utils.h"
 #include <timecoded_signal_process.h>
+#include <adaptive_speed_filter.h>
+#include <iir_filter.h>
 #include <timecoded_signal_process_test.h>
 
 TimecodedSignalProcess_Test::TimecodedSignalProcess_Test()
@@ -79,3 +81,39 @@ void TimecodedSignalProcess_Test::testCase_run()
    // Cleanup.
    delete sig_process;
 }
+
+/**
+ * Test:
+ *    Adaptive_speed_filter::compute()
+ */
+void TimecodedSignalProcess_Test::testCase_adaptive_speed_filter()
+{
+   // Compare with the previous fixed filter.
+   Adaptive_speed_filter adaptive(1000.0);
+   IIR_filter            fixed({1.0, -0.998}, {0.001, 0.001});
+
+   // Steady platter: same result.
+   double out_adaptive = 0.0;
+   double out_fixed    = 0.0;
+   for (int i = 0; i < 20000; i++)
+   {
+      double freq  = (i % 2 == 0) ? 1010.0 : 990.0; // Jitter.
+      out_adaptive = adaptive.compute(freq);
+      out_fixed    = fixed.compute(freq);
+   }
+   QVERIFY2(qAbs(out_adaptive - 1000.0) < 1.0, "steady adaptive filter");
+   QVERIFY2(qAbs(out_fixed    - 1000.0) < 1.0, "steady fixed filter");
+
+   // Scratch (direction changes): adaptive filter follows much faster.
+   for (int i = 0; i < 100; i++)
+   {
+      out_adaptive = adaptive.compute(-1000.0);
+      out_fixed    = fixed.compute(-1000.0);
+   }
+   QVERIFY2(out_adaptive < -500.0, qPrintable("adaptive filter is backward, freq = " + QString::number(out_adaptive)));
+   QVERIFY2(out_fixed > 0.0, "fixed filter is still forward");
+
+   // Reset.
+   adaptive.reset();
+   QVERIFY2(adaptive.compute(0.0) == 0.0, "reset");
+}
@@ -43,4 +43,5 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void testCase_run();
+    void testCase_adaptive_speed_filter();
 };